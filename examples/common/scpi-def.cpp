@@ -38,6 +38,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "scpi/scpi.h"
+#include "scpi/index.hpp"
 #include "scpi-def.h"
 
 scpi_result_t DMM_MeasureVoltageDcQ(scpi_t * context) {
@@ -200,7 +201,7 @@ scpi_result_t My_CoreTstQ(scpi_t * context) {
     return SCPI_RES_OK;
 }
 
-static const scpi_command_t scpi_commands[] = {
+static constexpr scpi_command_t scpi_commands[] = {
     /* {"pattern", callback} *
     
     /* IEEE Mandated Commands (SCPI std V1999.0 4.1.1) */
@@ -259,6 +260,8 @@ static const scpi_command_t scpi_commands[] = {
     SCPI_CMD_LIST_END
 };
 
+SCPI_COMMAND_INDEX(scpi_index, scpi_commands);
+
 static scpi_interface_t scpi_interface = {
     /* error */ SCPI_Error,
     /* write */ SCPI_Write,
@@ -283,6 +286,7 @@ scpi_t scpi_context = {
         {0, 0, NULL}},
     /* interface */ &scpi_interface,
     /* output_count */ 0,
+    /* output_binary_count */ 0,
     /* input_count */ 0,
     /* cmd_error */ FALSE,
     /* error_queue */ NULL,
@@ -296,5 +300,7 @@ scpi_t scpi_context = {
     },
     /* idn */
     {"MANUFACTURE", "INSTR2013", NULL, "01-02"},
+    /* binary_output */ false,
+    /* cmdindex */ &scpi_index,
 };
 
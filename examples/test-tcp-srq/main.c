@@ -233,8 +233,12 @@ static void closeSrqIo(user_data_t * user_data) {
 
 static int processIo(user_data_t * user_data) {
     int rc;
-    char smbuffer[10];
-    rc = recv(user_data->io, smbuffer, sizeof (smbuffer), 0);
+    char * buffer;
+    size_t buffer_len;
+
+    // receive directly into the input buffer of the parser
+    SCPI_InputReserve(&scpi_context, &buffer, &buffer_len);
+    rc = recv(user_data->io, buffer, buffer_len, 0);
     if (rc < 0) {
         if (errno != EWOULDBLOCK) {
             closeIo(user_data);
@@ -244,7 +248,7 @@ static int processIo(user_data_t * user_data) {
         closeIo(user_data);
         printf("Connection closed\r\n");
     } else {
-        SCPI_Input(&scpi_context, smbuffer, rc);
+        SCPI_InputCommit(&scpi_context, rc);
     }
 }
 
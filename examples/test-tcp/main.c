@@ -167,7 +167,8 @@ int main(int argc, char** argv) {
     int rc;
 
     int listenfd;
-    char smbuffer[10];
+    char * buffer;
+    size_t buffer_len;
 
     // user_context will be pointer to socket
     scpi_context.user_context = NULL;
@@ -200,7 +201,9 @@ int main(int argc, char** argv) {
                 SCPI_Input(&scpi_context, NULL, 0);
             }
             if (rc > 0) { // something to read
-                rc = recv(clifd, smbuffer, sizeof (smbuffer), 0);
+                // receive directly into the input buffer of the parser
+                SCPI_InputReserve(&scpi_context, &buffer, &buffer_len);
+                rc = recv(clifd, buffer, buffer_len, 0);
                 if (rc < 0) {
                     if (errno != EWOULDBLOCK) {
                         perror("  recv() failed");
@@ -210,7 +213,7 @@ int main(int argc, char** argv) {
                     printf("Connection closed\r\n");
                     break;
                 } else {
-                    SCPI_Input(&scpi_context, smbuffer, rc);
+                    SCPI_InputCommit(&scpi_context, rc);
                 }
             }
         }
@@ -97,6 +97,148 @@ extern "C" {
 #define USE_DEPRECATED_FUNCTIONS 1
 #endif
 
+/**
+ * Maximum number of keywords in pattern compiled by SCPI_PatternCompile
+ */
+#ifndef SCPI_PATTERN_KEYWORDS
+#define SCPI_PATTERN_KEYWORDS 12
+#endif
+
+/**
+ * Maximum number of keywords in program header, including keywords
+ * inherited from previous command in compound message. Headers with more
+ * keywords are reported as undefined (-113), even if some pattern of the
+ * command list has more keywords.
+ */
+#ifndef SCPI_HEADER_KEYWORDS
+#define SCPI_HEADER_KEYWORDS 12
+#endif
+
+/**
+ * Size of buffer for upper-cased program header, at most 255. Longer
+ * headers, including keywords inherited from previous command in compound
+ * message, are reported as undefined (-113).
+ */
+#ifndef SCPI_HEADER_LENGTH
+#define SCPI_HEADER_LENGTH 128
+#endif
+
+/**
+ * Number of numeric suffixes captured while the command is resolved,
+ * SCPI_CommandNumbers() matches the header again if more are requested.
+ * At most 32.
+ */
+#ifndef SCPI_COMMAND_NUMBERS
+#define SCPI_COMMAND_NUMBERS 4
+#endif
+
+/**
+ * Remember resolved program headers in the context
+ * 0 = Search command list for every header
+ * 1 = Look up recently used headers first
+ *
+ * Each entry stores a copy of the header, so it costs about
+ * SCPI_DISPATCH_CACHE_HEADER_LENGTH bytes per entry
+ */
+#ifndef USE_DISPATCH_CACHE
+#define USE_DISPATCH_CACHE SYSTEM_TYPE
+#endif
+
+#ifndef SCPI_DISPATCH_CACHE_SIZE
+#define SCPI_DISPATCH_CACHE_SIZE 8
+#endif
+
+#ifndef SCPI_DISPATCH_CACHE_HEADER_LENGTH
+#define SCPI_DISPATCH_CACHE_HEADER_LENGTH 32
+#endif
+
+/**
+ * Remember layout of the last program message
+ * 0 = Parse every message
+ * 1 = Skip parsing when the message is repeated byte by byte
+ *
+ * Messages up to SCPI_MESSAGE_CACHE_LENGTH bytes with at most
+ * SCPI_MESSAGE_CACHE_UNITS commands are remembered
+ */
+#ifndef USE_MESSAGE_CACHE
+#define USE_MESSAGE_CACHE 0
+#endif
+
+#ifndef SCPI_MESSAGE_CACHE_LENGTH
+#define SCPI_MESSAGE_CACHE_LENGTH 64
+#endif
+
+#ifndef SCPI_MESSAGE_CACHE_UNITS
+#define SCPI_MESSAGE_CACHE_UNITS 4
+#endif
+
+/**
+ * Remember program data tokens found while detecting program message unit
+ * 0 = SCPI_Parameter lexes every parameter again
+ * 1 = SCPI_Parameter takes first SCPI_PARAMETER_CACHE_SIZE parameters of
+ *     each command from the parser state
+ *
+ * Each entry costs 12 bytes in the context
+ */
+#ifndef USE_PARAMETER_CACHE
+#define USE_PARAMETER_CACHE SYSTEM_TYPE
+#endif
+
+#ifndef SCPI_PARAMETER_CACHE_SIZE
+#define SCPI_PARAMETER_CACHE_SIZE 16
+#endif
+
+/**
+ * Pass arbitrary block program data to stream callback of the command
+ * 0 = Whole block has to fit into the input buffer
+ * 1 = Block of command with stream callback is passed to the callback as
+ *     it is received by SCPI_Input, it can be larger than input buffer
+ */
+#ifndef USE_ARBITRARY_BLOCK_STREAM
+#define USE_ARBITRARY_BLOCK_STREAM 1
+#endif
+
+/**
+ * Pass numeric list program data to list callback of the command
+ * 0 = Whole list has to fit into the input buffer
+ * 1 = Numbers of command with list callback are decoded and passed to the
+ *     callback in batches as they are received by SCPI_Input
+ */
+#ifndef USE_NUMERIC_LIST_STREAM
+#define USE_NUMERIC_LIST_STREAM 1
+#endif
+
+/**
+ * Conversion of decimal numeric program data to floating point
+ * 0 = Numbers which are not exact in double are converted by slower
+ *     decimal shifting
+ * 1 = Most numbers are converted by Eisel-Lemire algorithm
+ *
+ * Both are correctly rounded, the table used by Eisel-Lemire algorithm
+ * costs 10 kB of read only memory
+ */
+#ifndef USE_DECIMAL_POWER_TABLE
+#define USE_DECIMAL_POWER_TABLE SYSTEM_TYPE
+#endif
+
+/**
+ * Borrow input buffer from shared pool of chunks for long messages
+ * 0 = Input longer than the input buffer is dropped as overrun
+ * 1 = Input buffer can grow into chunks registered by SCPI_InputPoolSet,
+ *     chunks are returned to the pool when the message is executed
+ */
+#ifndef USE_INPUT_POOL
+#define USE_INPUT_POOL SYSTEM_TYPE
+#endif
+
+/**
+ * Maximum number of dimensions of channel list entries expanded by
+ * SCPI_ExprChannelListFlat and SCPI_ExprChannelListBitset
+ */
+#ifndef SCPI_CHANNEL_DIMENSIONS
+#define SCPI_CHANNEL_DIMENSIONS 4
+#endif
+
 /* Compiler specific */
 /* RealView/Keil ARM Compiler, e.g. Cortex-M CPUs */
 #if defined(__CC_ARM)
@@ -157,6 +299,31 @@ extern "C" {
 #define HAVE_STDBOOL            1
 #endif
 
+/* ======== test SIMD extensions ======== */
+#ifndef HAVE_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define HAVE_SSE2               1
+#else
+#define HAVE_SSE2               0
+#endif
+#endif
+
+#ifndef HAVE_AVX2
+#if defined(__AVX2__)
+#define HAVE_AVX2               1
+#else
+#define HAVE_AVX2               0
+#endif
+#endif
+
+#ifndef HAVE_NEON
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HAVE_NEON               1
+#else
+#define HAVE_NEON               0
+#endif
+#endif
+
 /* define local macros depending on existance of strnlen */
 #if HAVE_STRNLEN
 #define SCPIDEFINE_strnlen(s, l)	strnlen((s), (l))
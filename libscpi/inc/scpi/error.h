@@ -90,7 +90,7 @@ extern "C" {
     X(SCPI_ERROR_INVALID_STRING_DATA,           -151, "Invalid string data")                          \
     XE(SCPI_ERROR_STRING_DATA_NOT_ALLOWED,      -158, "String data not allowed")                      \
     XE(SCPI_ERROR_BLOCK_DATA_ERROR,             -160, "Block data error")                             \
-    XE(SCPI_ERROR_INVALID_BLOCK_DATA,           -161, "Invalid block data")                           \
+    X(SCPI_ERROR_INVALID_BLOCK_DATA,            -161, "Invalid block data")                           \
     XE(SCPI_ERROR_BLOCK_DATA_NOT_ALLOWED,       -168, "Block data not allowed")                       \
     X(SCPI_ERROR_EXPRESSION_PARSING_ERROR,      -170, "Expression error")                             \
     XE(SCPI_ERROR_INVAL_EXPRESSION,             -171, "Invalid expression")                           \
@@ -111,8 +111,8 @@ extern "C" {
     XE(SCPI_ERROR_ARM_DEADLOCK,                 -215, "Arm deadlock")                                 \
     XE(SCPI_ERROR_PARAMETER_ERROR,              -220, "Parameter error")                              \
     XE(SCPI_ERROR_SETTINGS_CONFLICT,            -221, "Settings conflict")                            \
-    XE(SCPI_ERROR_DATA_OUT_OF_RANGE,            -222, "Data out of range")                            \
-    XE(SCPI_ERROR_TOO_MUCH_DATA,                -223, "Too much data")                                \
+    X(SCPI_ERROR_DATA_OUT_OF_RANGE,             -222, "Data out of range")                            \
+    X(SCPI_ERROR_TOO_MUCH_DATA,                 -223, "Too much data")                                \
     X(SCPI_ERROR_ILLEGAL_PARAMETER_VALUE,       -224, "Illegal parameter value")                      \
     XE(SCPI_ERROR_OUT_OF_MEMORY_FOR_REQ_OP,     -225, "Out of memory")                                \
     XE(SCPI_ERROR_LISTS_NOT_SAME_LENGTH,        -226, "Lists not same length")                        \
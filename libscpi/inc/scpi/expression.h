@@ -49,10 +49,18 @@ extern "C" {
     };
     typedef enum _scpi_expr_result_t scpi_expr_result_t;
 
+    scpi_expr_result_t SCPI_ExprNumericListBegin(scpi_t * context, scpi_parameter_t * param, scpi_expr_list_t * list);
+    scpi_expr_result_t SCPI_ExprNumericListNext(scpi_t * context, scpi_expr_list_t * list, scpi_bool_t * isRange, scpi_parameter_t * valueFrom, scpi_parameter_t * valueTo);
+    scpi_expr_result_t SCPI_ExprNumericListReadInt(scpi_t * context, scpi_expr_list_t * list, scpi_bool_t * isRange, int32_t * valuesFrom, int32_t * valuesTo, size_t length, size_t * count);
+    scpi_expr_result_t SCPI_ExprNumericListReadDouble(scpi_t * context, scpi_expr_list_t * list, scpi_bool_t * isRange, double * valuesFrom, double * valuesTo, size_t length, size_t * count);
     scpi_expr_result_t SCPI_ExprNumericListEntry(scpi_t * context, scpi_parameter_t * param, int index, scpi_bool_t * isRange, scpi_parameter_t * valueFrom, scpi_parameter_t * valueTo);
     scpi_expr_result_t SCPI_ExprNumericListEntryInt(scpi_t * context, scpi_parameter_t * param, int index, scpi_bool_t * isRange, int32_t * valueFrom, int32_t * valueTo);
     scpi_expr_result_t SCPI_ExprNumericListEntryDouble(scpi_t * context, scpi_parameter_t * param, int index, scpi_bool_t * isRange, double * valueFrom, double * valueTo);
+    scpi_expr_result_t SCPI_ExprChannelListBegin(scpi_t * context, scpi_parameter_t * param, scpi_expr_list_t * list);
+    scpi_expr_result_t SCPI_ExprChannelListNext(scpi_t * context, scpi_expr_list_t * list, scpi_bool_t * isRange, int32_t * valuesFrom, int32_t * valuesTo, size_t length, size_t * dimensions);
     scpi_expr_result_t SCPI_ExprChannelListEntry(scpi_t * context, scpi_parameter_t * param, int index, scpi_bool_t * isRange, int32_t * valuesFrom, int32_t * valuesTo, size_t length, size_t * dimensions);
+    scpi_expr_result_t SCPI_ExprChannelListFlat(scpi_t * context, scpi_parameter_t * param, int32_t * values, size_t dimensions, size_t length, size_t * count);
+    scpi_expr_result_t SCPI_ExprChannelListBitset(scpi_t * context, scpi_parameter_t * param, const scpi_channel_geometry_t * geometry, uint32_t * bits, size_t words);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,370 @@
+/*-
+ * Copyright (c) 2012-2015 Jan Breuer,
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file   index.hpp
+ *
+ * @brief  Command index built at compile time
+ *
+ * C++14 counterpart of SCPI_CommandIndexBuild(). The index of a constexpr
+ * command list is computed by the compiler and placed to read-only data,
+ * so there is no pattern parsing or index building at runtime. Malformed
+ * patterns are reported as compile errors.
+ *
+ *     static constexpr scpi_command_t scpi_commands[] = { ... };
+ *     SCPI_COMMAND_INDEX(scpi_index, scpi_commands);
+ *
+ *     scpi_context.cmdindex = &scpi_index;
+ *
+ * scpi::command_id() gives the ID returned by SCPI_CmdId() for a pattern
+ * as a constant expression.
+ */
+
+#ifndef SCPI_INDEX_HPP
+#define	SCPI_INDEX_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include "scpi/types.h"
+
+#if !defined(__cplusplus) || (__cplusplus < 201402L)
+#error "scpi/index.hpp requires C++14"
+#endif
+
+namespace scpi {
+
+    template <size_t N>
+    struct command_index_nodes {
+        scpi_command_node_t nodes[N];
+        size_t count;
+    };
+
+    namespace detail {
+
+        /* Not constexpr. Reaching any of these during constant evaluation
+         * stops the compilation with the function name in the message. */
+        inline void malformed_pattern_unbalanced_brackets() {}
+        inline void malformed_pattern_empty_keyword() {}
+        inline void malformed_pattern_keyword_too_long() {}
+        inline void malformed_pattern_misplaced_query() {}
+        inline void malformed_pattern_misplaced_suffix() {}
+        inline void malformed_pattern_too_many_suffixes() {}
+        inline int32_t unknown_command_pattern() { return -1; }
+
+        constexpr bool is_separator(char c) {
+            return (c == ':') || (c == '[') || (c == ']');
+        }
+
+        constexpr int suffix_count(const char * pattern, const char * end) {
+            int result = 0;
+            for (; pattern < end; pattern++) {
+                if (*pattern == '#') {
+                    result++;
+                }
+            }
+            return result;
+        }
+
+        constexpr size_t pattern_length(const char * pattern) {
+            size_t len = 0;
+            while (pattern[len] != '\0') {
+                len++;
+            }
+            return len;
+        }
+
+        /**
+         * Validate pattern and return maximum number of nodes it can add
+         * @param pattern
+         * @return number of keywords multiplied by number of spellings
+         */
+        constexpr size_t pattern_bound(const char * pattern) {
+            size_t len = pattern_length(pattern);
+            size_t keywords = 0;
+            size_t groups = 0;
+            size_t i = 0;
+            size_t start = 0;
+            int depth = 0;
+
+            if ((len > 0) && (pattern[len - 1] == '?')) {
+                len--;
+            }
+
+            while (i < len) {
+                if (pattern[i] == '[') {
+                    depth++;
+                    groups++;
+                    i++;
+                } else if (pattern[i] == ']') {
+                    if (--depth < 0) {
+                        malformed_pattern_unbalanced_brackets();
+                    }
+                    i++;
+                } else if (pattern[i] == ':') {
+                    i++;
+                    if ((i < len) && ((pattern[i] == ':') || (pattern[i] == ']'))) {
+                        malformed_pattern_empty_keyword();
+                    }
+                } else {
+                    start = i;
+                    while ((i < len) && !is_separator(pattern[i])) {
+                        if (pattern[i] == '?') {
+                            malformed_pattern_misplaced_query();
+                        }
+                        if ((pattern[i] == '#') && ((i + 1 < len) && !is_separator(pattern[i + 1]))) {
+                            malformed_pattern_misplaced_suffix();
+                        }
+                        i++;
+                    }
+                    if (i - start - (pattern[i - 1] == '#' ? 1 : 0) > UINT8_MAX) {
+                        malformed_pattern_keyword_too_long();
+                    }
+                    keywords++;
+                }
+            }
+
+            if (depth != 0) {
+                malformed_pattern_unbalanced_brackets();
+            }
+
+            return keywords << groups;
+        }
+
+        template <size_t N>
+        class index_builder {
+        public:
+
+            constexpr index_builder() : result() {
+                result.nodes[0] = make_node(nullptr, 0, -1);
+                result.count = 1;
+            }
+
+            constexpr void insert(const char * pattern, int32_t cmd) {
+                size_t len = pattern_length(pattern);
+                bool query = (len > 0) && (pattern[len - 1] == '?');
+                insert(0, pattern, pattern + len - (query ? 1 : 0), 0, cmd, query);
+            }
+
+            command_index_nodes<N> result;
+
+        private:
+
+            static constexpr scpi_command_node_t make_node(const char * keyword, size_t len, int slot) {
+                scpi_command_node_t node{};
+                bool numeric = (len > 0) && (keyword[len - 1] == '#');
+                size_t i = 0;
+
+                node.keyword = keyword;
+                node.slot = (int8_t) (numeric ? slot : -1);
+                node.length = (uint8_t) (numeric ? len - 1 : len);
+                for (i = 0; (i < node.length) && !((keyword[i] >= 'a') && (keyword[i] <= 'z')); i++) {
+                }
+                node.short_length = (uint8_t) i;
+                node.parent = -1;
+                node.child = -1;
+                node.next = -1;
+                node.cmd = -1;
+                node.query = -1;
+
+                return node;
+            }
+
+            static constexpr bool same_keyword(const scpi_command_node_t & a, const scpi_command_node_t & b) {
+                size_t i = 0;
+
+                if ((a.slot != b.slot) || (a.length != b.length)) {
+                    return false;
+                }
+
+                for (i = 0; i < a.length; i++) {
+                    if (a.keyword[i] != b.keyword[i]) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            constexpr int32_t child(int32_t parent, const char * keyword, size_t len, int slot) {
+                scpi_command_node_t node = make_node(keyword, len, slot);
+                int32_t last = -1;
+                int32_t i = 0;
+
+                for (i = result.nodes[parent].child; i != -1; i = result.nodes[i].next) {
+                    if (same_keyword(result.nodes[i], node)) {
+                        return i;
+                    }
+                    last = i;
+                }
+
+                if (slot > INT8_MAX) {
+                    malformed_pattern_too_many_suffixes();
+                }
+
+                i = (int32_t) result.count++;
+                node.parent = parent;
+                result.nodes[i] = node;
+                if (last == -1) {
+                    result.nodes[parent].child = i;
+                } else {
+                    result.nodes[last].next = i;
+                }
+
+                return i;
+            }
+
+            constexpr void insert(int32_t node, const char * pattern, const char * end, int slot, int32_t cmd, bool query) {
+                const char * keyword = nullptr;
+                const char * close = nullptr;
+                int depth = 0;
+
+                while ((pattern < end) && ((*pattern == ':') || (*pattern == ']'))) {
+                    pattern++;
+                }
+
+                if (pattern == end) {
+                    int32_t & terminal = query ? result.nodes[node].query : result.nodes[node].cmd;
+                    if (terminal == -1) {
+                        terminal = cmd;
+                    }
+                    return;
+                }
+
+                if (*pattern == '[') {
+                    for (close = pattern; close < end; close++) {
+                        if (*close == '[') {
+                            depth++;
+                        } else if ((*close == ']') && (--depth == 0)) {
+                            break;
+                        }
+                    }
+
+                    /* spelling without the optional part, then with it */
+                    insert(node, close + 1, end, slot + suffix_count(pattern, close), cmd, query);
+                    insert(node, pattern + 1, end, slot, cmd, query);
+                    return;
+                }
+
+                keyword = pattern;
+                while ((pattern < end) && !is_separator(*pattern)) {
+                    pattern++;
+                }
+
+                node = child(node, keyword, (size_t) (pattern - keyword), slot);
+                insert(node, pattern, end, slot + (result.nodes[node].slot >= 0 ? 1 : 0), cmd, query);
+            }
+        };
+    }
+
+    /**
+     * Upper bound of number of nodes needed for command list, same as
+     * SCPI_CommandIndexNodes()
+     * @param cmdlist - command list terminated by SCPI_CMD_LIST_END
+     * @return number of nodes
+     */
+    constexpr size_t command_index_bound(const scpi_command_t * cmdlist) {
+        size_t bound = 1;
+        size_t i = 0;
+
+        for (i = 0; cmdlist[i].pattern != nullptr; i++) {
+            bound += detail::pattern_bound(cmdlist[i].pattern);
+        }
+
+        return bound;
+    }
+
+    /**
+     * Build index of command list, same as SCPI_CommandIndexBuild()
+     * @param cmdlist - command list terminated by SCPI_CMD_LIST_END
+     * @return nodes, N must be at least command_index_bound(cmdlist)
+     */
+    template <size_t N>
+    constexpr command_index_nodes<N> command_index_build(const scpi_command_t * cmdlist) {
+        detail::index_builder<N> builder;
+        int32_t i = 0;
+
+        for (i = 0; cmdlist[i].pattern != nullptr; i++) {
+            builder.insert(cmdlist[i].pattern, i);
+        }
+
+        return builder.result;
+    }
+
+    /**
+     * Copy used nodes of the index to exactly sized storage
+     * @param index
+     * @return nodes, M must be equal to index.count
+     */
+    template <size_t M, size_t N>
+    constexpr command_index_nodes<M> command_index_trim(const command_index_nodes<N> & index) {
+        command_index_nodes<M> result{};
+        size_t i = 0;
+
+        for (i = 0; i < M; i++) {
+            result.nodes[i] = index.nodes[i];
+        }
+        result.count = M;
+
+        return result;
+    }
+
+    /**
+     * ID of the pattern in constexpr command list, same as SCPI_CommandId()
+     *
+     *     switch (SCPI_CmdId(context)) {
+     *         case scpi::command_id(scpi_commands, "MEASure:VOLTage:DC?"):
+     *
+     * @param cmdlist - command list terminated by SCPI_CMD_LIST_END
+     * @param pattern - pattern exactly as written in command list
+     * @return ID of the command, compile error if the pattern is not found
+     */
+    constexpr int32_t command_id(const scpi_command_t * cmdlist, const char * pattern) {
+        int32_t i = 0;
+        size_t j = 0;
+
+        for (i = 0; cmdlist[i].pattern != nullptr; i++) {
+            for (j = 0; (cmdlist[i].pattern[j] == pattern[j]) && (pattern[j] != '\0'); j++) {
+            }
+            if (cmdlist[i].pattern[j] == pattern[j]) {
+                return i;
+            }
+        }
+
+        return detail::unknown_command_pattern();
+    }
+}
+
+/**
+ * Define scpi_command_index_t with given name for constexpr command list
+ */
+#define SCPI_COMMAND_INDEX(name, cmdlist) \
+    static constexpr auto name##_nodes_full = ::scpi::command_index_build<::scpi::command_index_bound(cmdlist)>(cmdlist); \
+    static constexpr auto name##_nodes = ::scpi::command_index_trim<name##_nodes_full.count>(name##_nodes_full); \
+    static const scpi_command_index_t name = {(cmdlist), name##_nodes.nodes, name##_nodes.count}
+
+#endif	/* SCPI_INDEX_HPP */
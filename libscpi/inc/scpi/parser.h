@@ -44,9 +44,21 @@
 extern "C" {
 #endif
     void SCPI_Init(scpi_t * context);
+    scpi_bool_t SCPI_CommandIndexBuild(scpi_command_index_t * index, const scpi_command_t * cmdlist, scpi_command_node_t * nodes, size_t length);
+    size_t SCPI_CommandIndexNodes(const scpi_command_t * cmdlist);
+#if USE_DISPATCH_CACHE || USE_MESSAGE_CACHE
+    void SCPI_DispatchCacheClear(scpi_t * context);
+#endif
 
     scpi_bool_t SCPI_Input(scpi_t * context, const char * data, int len);
-    scpi_bool_t SCPI_Parse(scpi_t * context, char * data, int len);
+    scpi_bool_t SCPI_InputView(scpi_t * context, const char * data, size_t len, size_t * consumed);
+    scpi_bool_t SCPI_InputReserve(scpi_t * context, char ** data, size_t * len);
+    scpi_bool_t SCPI_InputCommit(scpi_t * context, size_t len);
+    scpi_bool_t SCPI_Parse(scpi_t * context, const char * data, int len);
+#if USE_INPUT_POOL
+    void SCPI_InputPoolInit(scpi_input_pool_t * pool, char * data, size_t chunk_size, size_t chunks);
+    void SCPI_InputPoolSet(scpi_t * context, scpi_input_pool_t * pool, size_t limit);
+#endif /* USE_INPUT_POOL */
 
     size_t SCPI_ResultCharacters(scpi_t * context, const char * data, size_t len);
 #define SCPI_ResultMnemonic(context, data) SCPI_ResultCharacters((context), (data), strlen(data))
@@ -58,9 +70,12 @@ extern "C" {
     size_t SCPI_ResultDouble(scpi_t * context, double val);
     size_t SCPI_ResultText(scpi_t * context, const char * data);
     size_t SCPI_ResultArbitraryBlock(scpi_t * context, const char * data, size_t len);
+    size_t SCPI_ResultArbitraryBlockBegin(scpi_t * context, size_t len);
+    size_t SCPI_ResultArbitraryBlockChunk(scpi_t * context, const char * data, size_t len);
+    size_t SCPI_ResultArbitraryBlockEnd(scpi_t * context);
     size_t SCPI_ResultBool(scpi_t * context, scpi_bool_t val);
     // TODO, this functions are not upstreamed
-    size_t SCPI_ResultBufferInt16(scpi_t * context, const int16_t *data, uint32_t size);
+    size_t SCPI_ResultBufferInt16(scpi_t * context, const int16_t *data, size_t size);
     size_t SCPI_ResultBufferFloat(scpi_t * context, const float *data, uint32_t size);
 
     scpi_bool_t SCPI_Parameter(scpi_t * context, scpi_parameter_t * parameter, scpi_bool_t mandatory);
@@ -90,13 +105,31 @@ extern "C" {
     scpi_bool_t SCPI_ParamChoice(scpi_t * context, const scpi_choice_def_t * options, int32_t * value, scpi_bool_t mandatory);
     scpi_bool_t SCPI_ParamBufferFloat(scpi_t * context, float *data, uint32_t *size, scpi_bool_t mandatory);
     scpi_bool_t SCPI_ParamBufferInt32(scpi_t * context, int32_t *data, uint32_t *size, scpi_bool_t mandatory);
+    scpi_bool_t SCPI_ParamArrayFloat(scpi_t * context, float * data, size_t size, size_t * count, scpi_bool_t mandatory);
+    scpi_bool_t SCPI_ParamArrayDouble(scpi_t * context, double * data, size_t size, size_t * count, scpi_bool_t mandatory);
+    scpi_bool_t SCPI_ParamArrayInt16(scpi_t * context, int16_t * data, size_t size, size_t * count, scpi_bool_t mandatory);
+    scpi_bool_t SCPI_ParamArrayInt32(scpi_t * context, int32_t * data, size_t size, size_t * count, scpi_bool_t mandatory);
+    scpi_bool_t SCPI_ParamArrayUInt64(scpi_t * context, uint64_t * data, size_t size, size_t * count, scpi_bool_t mandatory);
+
+#if USE_ARBITRARY_BLOCK_STREAM
+    void SCPI_StreamDestination(scpi_t * context, char * destination, size_t size);
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+#if USE_NUMERIC_LIST_STREAM
+    void SCPI_ListDestination(scpi_t * context, double * values, size_t size);
+#endif /* USE_NUMERIC_LIST_STREAM */
 
     scpi_bool_t SCPI_IsCmd(scpi_t * context, const char * cmd);
 #if USE_COMMAND_TAGS
     int32_t SCPI_CmdTag(scpi_t * context);
 #endif /* USE_COMMAND_TAGS */
+    int32_t SCPI_CmdId(scpi_t * context);
+    const scpi_command_table_t * SCPI_CmdTable(scpi_t * context);
+    scpi_bool_t SCPI_CommandTableAdd(scpi_t * context, scpi_command_table_t * table, const scpi_command_t * cmdlist, const char * prefix);
+    scpi_bool_t SCPI_CommandTableRemove(scpi_t * context, scpi_command_table_t * table);
+    int32_t SCPI_CommandId(const scpi_command_t * cmdlist, const char * pattern);
     scpi_bool_t SCPI_Match(const char * pattern, const char * value, size_t len);
     scpi_bool_t SCPI_CommandNumbers(scpi_t * context, int32_t * numbers, size_t len, int32_t default_value);
+    int32_t SCPI_CommandNumber(scpi_t * context, size_t index, int32_t default_value);
 
 #if USE_DEPRECATED_FUNCTIONS
     // deprecated finction, should be removed later
@@ -112,8 +112,15 @@ extern "C" {
     typedef enum _scpi_result_t scpi_result_t;
 
     typedef struct _scpi_command_t scpi_command_t;
+    typedef struct _scpi_command_table_t scpi_command_table_t;
 
+#if USE_COMMAND_TAGS && USE_ARBITRARY_BLOCK_STREAM && USE_NUMERIC_LIST_STREAM
+#define SCPI_CMD_LIST_END       {NULL, NULL, 0, NULL, NULL}
+#elif USE_COMMAND_TAGS && USE_ARBITRARY_BLOCK_STREAM
+#define SCPI_CMD_LIST_END       {NULL, NULL, 0, NULL}
+#else
 #define SCPI_CMD_LIST_END       {NULL, NULL, 0}
+#endif
 
     /* scpi interface */
     typedef struct _scpi_t scpi_t;
@@ -171,18 +178,36 @@ extern "C" {
 
     struct _scpi_token_t {
         scpi_token_type_t type;
-        char * ptr;
+        const char * ptr;
         int len;
     };
     typedef struct _scpi_token_t scpi_token_t;
 
     struct _lex_state_t {
-        char * buffer;
-        char * pos;
+        const char * buffer;
+        const char * pos;
         int len;
     };
     typedef struct _lex_state_t lex_state_t;
 
+    /* Position in numeric or channel list expression, see SCPI_ExprNumericListBegin */
+    struct _scpi_expr_list_t {
+        const char * ptr;       /* expression parameter, NULL if not valid */
+        int len;
+        lex_state_t lex;
+        int index;              /* index of the next entry */
+        scpi_bool_t channel;    /* channel list, '@' is already skipped */
+    };
+    typedef struct _scpi_expr_list_t scpi_expr_list_t;
+
+    /* Channel matrix, channel c has bit sum((c[i] - first[i]) * stride[i]) */
+    struct _scpi_channel_geometry_t {
+        size_t dimensions;
+        int32_t first[SCPI_CHANNEL_DIMENSIONS]; /* lowest channel number in each dimension */
+        int32_t size[SCPI_CHANNEL_DIMENSIONS];  /* number of channels in each dimension */
+    };
+    typedef struct _scpi_channel_geometry_t scpi_channel_geometry_t;
+
     /* scpi parser */
     enum _message_termination_t {
         SCPI_MESSAGE_TERMINATION_NONE,
@@ -191,16 +216,57 @@ extern "C" {
     };
     typedef enum _message_termination_t message_termination_t;
 
+#if USE_PARAMETER_CACHE
+    /* Program data token, positions are relative to the program data */
+    struct _scpi_parameter_token_t {
+        uint16_t start;         /* beginning of the parameter with white space */
+        uint16_t end;           /* end of the parameter with white space */
+        uint16_t offset;        /* beginning of the token */
+        uint16_t len;           /* length of the token */
+        uint16_t suffix;        /* beginning of the suffix or 0 */
+        uint8_t type;           /* scpi_token_type_t */
+    };
+    typedef struct _scpi_parameter_token_t scpi_parameter_token_t;
+#endif /* USE_PARAMETER_CACHE */
+
     struct _scpi_parser_state_t {
         scpi_token_t programHeader;
         scpi_token_t programData;
         int numberOfParameters;
         message_termination_t termination;
+#if USE_PARAMETER_CACHE
+        scpi_parameter_token_t parameters[SCPI_PARAMETER_CACHE_SIZE];
+        size_t parameterCount;
+        uint32_t parameterHits;     /* parameters taken from the cache */
+        uint32_t parameterMisses;   /* parameters lexed again */
+#endif /* USE_PARAMETER_CACHE */
     };
     typedef struct _scpi_parser_state_t scpi_parser_state_t;
 
     typedef scpi_result_t(*scpi_command_callback_t)(scpi_t *);
 
+    /* length of arbitrary block "#0", terminated by end of message */
+#define SCPI_BLOCK_LENGTH_INDEFINITE ((size_t) -1)
+
+#if USE_ARBITRARY_BLOCK_STREAM || USE_NUMERIC_LIST_STREAM
+    enum _scpi_stream_event_t {
+        SCPI_STREAM_BEGIN,      /* block header received, len is length of the block or SCPI_BLOCK_LENGTH_INDEFINITE */
+        SCPI_STREAM_DATA,       /* next part of the block */
+        SCPI_STREAM_END,        /* whole block received */
+        SCPI_STREAM_ABORT,      /* block will not be completed */
+    };
+    typedef enum _scpi_stream_event_t scpi_stream_event_t;
+#endif /* USE_ARBITRARY_BLOCK_STREAM || USE_NUMERIC_LIST_STREAM */
+
+#if USE_ARBITRARY_BLOCK_STREAM
+    typedef scpi_result_t(*scpi_stream_callback_t)(scpi_t *, scpi_stream_event_t, const char *, size_t);
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+
+#if USE_NUMERIC_LIST_STREAM
+    /* SCPI_STREAM_DATA passes next decoded numbers of the list */
+    typedef scpi_result_t(*scpi_list_callback_t)(scpi_t *, scpi_stream_event_t, const double *, size_t);
+#endif /* USE_NUMERIC_LIST_STREAM */
+
     /* scpi error queue */
     typedef void * scpi_error_queue_t;
 
@@ -248,10 +314,39 @@ extern "C" {
 #define SCPI_CHOICE_LIST_END   {NULL, -1}
     typedef struct _scpi_choice_def_t scpi_choice_def_t;
 
+    /* program header split to keywords, positions in the header buffer */
+    struct _scpi_keyword_t {
+        uint8_t offset;
+        uint8_t length;
+    };
+    typedef struct _scpi_keyword_t scpi_keyword_t;
+
+    struct _scpi_header_t {
+        const char * buffer;
+        scpi_keyword_t keywords[SCPI_HEADER_KEYWORDS];
+        uint8_t count;
+        scpi_bool_t query;
+        uint8_t resume_depth;
+        int32_t resume;
+        int32_t prefix;
+    };
+    typedef struct _scpi_header_t scpi_header_t;
+
+    /* numeric suffixes of program header, captured during dispatch */
+    struct _scpi_command_numbers_t {
+        int32_t values[SCPI_COMMAND_NUMBERS];
+        uint32_t given;
+    };
+    typedef struct _scpi_command_numbers_t scpi_command_numbers_t;
+
     struct _scpi_param_list_t {
         const scpi_command_t * cmd;
         lex_state_t lex_state;
         scpi_const_buffer_t cmd_raw;
+        scpi_header_t header;
+        scpi_command_numbers_t numbers;
+        const scpi_command_table_t * table;
+        scpi_expr_list_t expr_list;
     };
     typedef struct _scpi_param_list_t scpi_param_list_t;
 
@@ -281,7 +376,121 @@ extern "C" {
 #if USE_COMMAND_TAGS
         int32_t tag;
 #endif /* USE_COMMAND_TAGS */
+#if USE_ARBITRARY_BLOCK_STREAM
+        scpi_stream_callback_t stream;
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+#if USE_NUMERIC_LIST_STREAM
+        scpi_list_callback_t list;
+#endif /* USE_NUMERIC_LIST_STREAM */
+    };
+
+    /* compiled pattern */
+    struct _scpi_pattern_keyword_t {
+        uint16_t offset;
+        uint8_t length;
+        uint8_t short_length;
+        uint8_t group;          /* first optional group starting at the keyword + 1, 0 if none */
+        int8_t slot;
+    };
+    typedef struct _scpi_pattern_keyword_t scpi_pattern_keyword_t;
+
+    /* optional part of compiled pattern, keywords from start to end - 1 */
+    struct _scpi_pattern_group_t {
+        uint8_t start;
+        uint8_t end;
+    };
+    typedef struct _scpi_pattern_group_t scpi_pattern_group_t;
+
+    struct _scpi_pattern_t {
+        const char * pattern;
+        scpi_pattern_keyword_t keywords[SCPI_PATTERN_KEYWORDS];
+        scpi_pattern_group_t groups[SCPI_PATTERN_KEYWORDS];
+        uint8_t count;
+        uint8_t group_count;
+        scpi_bool_t query;
+    };
+    typedef struct _scpi_pattern_t scpi_pattern_t;
+
+    /* command index */
+    struct _scpi_command_node_t {
+        const char * keyword;
+        uint8_t length;
+        uint8_t short_length;
+        int8_t slot;
+        int32_t parent;
+        int32_t child;
+        int32_t next;
+        int32_t cmd;
+        int32_t query;
     };
+    typedef struct _scpi_command_node_t scpi_command_node_t;
+
+    struct _scpi_command_index_t {
+        const scpi_command_t * cmdlist;
+        const scpi_command_node_t * nodes;
+        size_t count;
+    };
+    typedef struct _scpi_command_index_t scpi_command_index_t;
+
+    /* command list attached at runtime, see SCPI_CommandTableAdd() */
+    struct _scpi_command_table_t {
+        const scpi_command_t * cmdlist;
+        const scpi_command_index_t * cmdindex; /* reset by SCPI_CommandTableAdd(), set after it */
+        scpi_pattern_t prefix;
+        scpi_command_table_t * next;
+    };
+
+#if USE_DISPATCH_CACHE
+    struct _scpi_dispatch_entry_t {
+        uint32_t hash;
+        size_t length;
+        char header[SCPI_DISPATCH_CACHE_HEADER_LENGTH];
+        const scpi_command_t * cmd;
+        const scpi_command_table_t * table;
+        int32_t prefix;
+        scpi_command_numbers_t numbers;
+    };
+    typedef struct _scpi_dispatch_entry_t scpi_dispatch_entry_t;
+#endif /* USE_DISPATCH_CACHE */
+
+#if USE_MESSAGE_CACHE
+    struct _scpi_message_unit_t {
+        scpi_token_type_t header_type;
+        uint16_t header;
+        uint16_t header_length;
+        scpi_token_type_t data_type;
+        uint16_t data;
+        uint16_t data_length;
+        int numberOfParameters;
+        message_termination_t termination;
+        const scpi_command_t * cmd;
+        const scpi_command_table_t * table;
+        scpi_command_numbers_t numbers;
+    };
+    typedef struct _scpi_message_unit_t scpi_message_unit_t;
+#endif /* USE_MESSAGE_CACHE */
+
+#if USE_DISPATCH_CACHE || USE_MESSAGE_CACHE
+    struct _scpi_dispatch_cache_t {
+        const scpi_command_t * cmdlist;
+        const scpi_command_index_t * cmdindex;
+#if USE_DISPATCH_CACHE
+        scpi_dispatch_entry_t entries[SCPI_DISPATCH_CACHE_SIZE];
+        uint32_t hits;
+        uint32_t misses;
+#endif /* USE_DISPATCH_CACHE */
+#if USE_MESSAGE_CACHE
+        char message[SCPI_MESSAGE_CACHE_LENGTH];
+        size_t message_length;
+        scpi_message_unit_t units[SCPI_MESSAGE_CACHE_UNITS];
+        size_t unit_count;
+        scpi_bool_t recording;
+        uint32_t message_hits;
+        uint32_t message_misses;
+#endif /* USE_MESSAGE_CACHE */
+    };
+    typedef struct _scpi_dispatch_cache_t scpi_dispatch_cache_t;
+#endif
 
     struct _scpi_interface_t {
         scpi_error_callback_t error;
@@ -291,6 +500,53 @@ extern "C" {
         scpi_command_callback_t reset;
     };
 
+#if USE_INPUT_POOL
+#define SCPI_INPUT_POOL_CHUNKS 32
+
+    /* Chunks of memory lent to input buffers of contexts */
+    struct _scpi_input_pool_t {
+        char * data;            /* chunks follow each other */
+        size_t chunk_size;
+        size_t chunks;          /* at most SCPI_INPUT_POOL_CHUNKS */
+        uint32_t used;          /* bit for each chunk lent to some context */
+    };
+    typedef struct _scpi_input_pool_t scpi_input_pool_t;
+#endif /* USE_INPUT_POOL */
+
+    /* Progress of SCPI_Input in the input buffer */
+    struct _scpi_input_state_t {
+        size_t unit;            /* beginning of first program message unit not yet executed */
+        size_t start;           /* beginning of current program message */
+        size_t scanned;         /* end of data already searched for unit termination */
+        scpi_bool_t message;    /* some unit of current message was executed */
+        scpi_header_t prev;     /* header of last executed unit */
+#if USE_ARBITRARY_BLOCK_STREAM
+        size_t stream;          /* rest of arbitrary block passed to stream callback */
+        scpi_bool_t streaming;  /* arbitrary block is passed to stream callback */
+        scpi_bool_t stream_error; /* stream callback failed, rest of block is dropped */
+        scpi_bool_t block;      /* unterminated unit ends with incomplete block header */
+        size_t block_search;    /* offset in program data of unterminated unit where search for block continues */
+        char * destination;     /* destination of the block set by SCPI_StreamDestination */
+        size_t destination_size;
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+#if USE_NUMERIC_LIST_STREAM
+        scpi_bool_t listing;    /* numbers of unterminated unit are passed to list callback */
+        scpi_bool_t list_error; /* list callback failed, rest of list is dropped */
+        double * list_values;   /* batch set by SCPI_ListDestination */
+        size_t list_size;
+        size_t list_count;      /* numbers waiting in the batch */
+#endif /* USE_NUMERIC_LIST_STREAM */
+#if USE_INPUT_POOL
+        scpi_input_pool_t * pool; /* chunks to grow the input buffer from */
+        size_t pool_limit;      /* maximal length of grown input buffer */
+        size_t pool_first;      /* first borrowed chunk */
+        size_t pool_count;      /* number of borrowed chunks, 0 = own buffer */
+        char * own_data;        /* own buffer while the chunks are used */
+        size_t own_length;
+#endif /* USE_INPUT_POOL */
+    };
+    typedef struct _scpi_input_state_t scpi_input_state_t;
+
     struct _scpi_t {
         const scpi_command_t * cmdlist;
         scpi_buffer_t buffer;
@@ -307,6 +563,14 @@ extern "C" {
         scpi_parser_state_t parser_state;
         const char * idn[4];
         bool binary_output;
+        const scpi_command_index_t * cmdindex;
+#if USE_DISPATCH_CACHE || USE_MESSAGE_CACHE
+        scpi_dispatch_cache_t dispatch_cache;
+#endif
+        scpi_pattern_t cmd_pattern;
+        scpi_command_table_t * tables;
+        char header_buffer[SCPI_HEADER_LENGTH];
+        scpi_input_state_t input_state;
     };
 
 #ifdef  __cplusplus
@@ -50,6 +50,9 @@ extern "C" {
     size_t SCPI_FloatToStr(float val, char * str, size_t len);
     size_t SCPI_DoubleToStr(double val, char * str, size_t len);
 
+    scpi_bool_t SCPI_PatternCompile(scpi_pattern_t * compiled, const char * pattern);
+    scpi_bool_t SCPI_PatternMatch(const scpi_pattern_t * compiled, const char * value, size_t len, int32_t * numbers, size_t numbers_len, int32_t default_value);
+
     // deprecated finction, should be removed later
 #define SCPI_LongToStr(val, str, len, base) SCPI_Int32ToStr((val), (str), (len), (base), TRUE)
 
@@ -0,0 +1,351 @@
+/*-
+ * Copyright (c) 2012-2015 Jan Breuer,
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file   cache.c
+ *
+ * @brief  Dispatch cache
+ *
+ * Instruments are often polled with the same message over and over. The
+ * context remembers the command resolved for recently used program
+ * headers and, optionally, the complete layout of the last message, so
+ * the repeated work can be skipped.
+ */
+
+#include <string.h>
+
+#include "scpi/parser.h"
+#include "cache_private.h"
+
+#if USE_DISPATCH_CACHE || USE_MESSAGE_CACHE
+
+/**
+ * Forget all cached results, used when the command list changes
+ * @param cache
+ */
+static void cacheInvalidate(scpi_dispatch_cache_t * cache) {
+#if USE_DISPATCH_CACHE
+    size_t i;
+
+    for (i = 0; i < SCPI_DISPATCH_CACHE_SIZE; i++) {
+        cache->entries[i].length = 0;
+        cache->entries[i].cmd = NULL;
+    }
+#endif /* USE_DISPATCH_CACHE */
+
+#if USE_MESSAGE_CACHE
+    cache->message_length = 0;
+    cache->unit_count = 0;
+    cache->recording = FALSE;
+#endif /* USE_MESSAGE_CACHE */
+}
+
+/**
+ * Invalidate the cache if it was filled for another command list
+ * @param context
+ */
+static void cacheValidate(scpi_t * context) {
+    scpi_dispatch_cache_t * cache = &context->dispatch_cache;
+
+    if ((cache->cmdlist != context->cmdlist) || (cache->cmdindex != context->cmdindex)) {
+        cacheInvalidate(cache);
+        cache->cmdlist = context->cmdlist;
+        cache->cmdindex = context->cmdindex;
+    }
+}
+
+/**
+ * Clear dispatch cache and its statistics
+ *
+ * Has to be called if content of the command list is modified in place.
+ * Change of context->cmdlist or context->cmdindex is detected automatically.
+ *
+ * @param context
+ */
+void SCPI_DispatchCacheClear(scpi_t * context) {
+    scpi_dispatch_cache_t * cache = &context->dispatch_cache;
+
+    cacheInvalidate(cache);
+    cache->cmdlist = context->cmdlist;
+    cache->cmdindex = context->cmdindex;
+
+#if USE_DISPATCH_CACHE
+    cache->hits = 0;
+    cache->misses = 0;
+#endif /* USE_DISPATCH_CACHE */
+
+#if USE_MESSAGE_CACHE
+    cache->message_hits = 0;
+    cache->message_misses = 0;
+#endif /* USE_MESSAGE_CACHE */
+}
+
+/**
+ * Forget all cached results, used when command tables are added or removed
+ * @param context
+ */
+void scpiCache_Invalidate(scpi_t * context) {
+    cacheInvalidate(&context->dispatch_cache);
+}
+
+#endif /* USE_DISPATCH_CACHE || USE_MESSAGE_CACHE */
+
+#if USE_DISPATCH_CACHE
+
+/**
+ * Get i-th character of the header as if its keywords were joined by ':'
+ * @param header
+ * @param keyword - current keyword, updated while walking
+ * @param pos - position in current keyword, updated while walking
+ * @return character or 0 at the end of the header
+ */
+static char headerNext(const scpi_header_t * header, uint8_t * keyword, size_t * pos) {
+    if (*keyword < header->count) {
+        if (*pos < header->keywords[*keyword].length) {
+            return header->buffer[header->keywords[*keyword].offset + (*pos)++];
+        }
+        *pos = 0;
+        (*keyword)++;
+        if (*keyword < header->count) {
+            return ':';
+        }
+    }
+
+    if (header->query && (*keyword == header->count)) {
+        (*keyword)++;
+        return '?';
+    }
+
+    return 0;
+}
+
+/**
+ * FNV-1a hash of the header
+ * @param header
+ * @param len - length of the joined header
+ * @return hash
+ */
+static uint32_t headerHash(const scpi_header_t * header, size_t * len) {
+    uint32_t hash = 2166136261u;
+    uint8_t keyword = 0;
+    size_t pos = 0;
+    char c;
+
+    *len = 0;
+    while ((c = headerNext(header, &keyword, &pos)) != 0) {
+        hash ^= (uint8_t) c;
+        hash *= 16777619u;
+        (*len)++;
+    }
+
+    return hash;
+}
+
+/**
+ * Find command for previously resolved header
+ *
+ * On success, header->prefix and numeric suffixes are restored from the
+ * cache too.
+ *
+ * @param context
+ * @param header - program header
+ * @param numbers - numeric suffixes of the header
+ * @param table - command table of the command
+ * @param hash - hash of the header, to be passed to scpiCache_Store
+ * @return command or NULL if the header is not in cache
+ */
+const scpi_command_t * scpiCache_Find(scpi_t * context, scpi_header_t * header, scpi_command_numbers_t * numbers, const scpi_command_table_t ** table, uint32_t * hash) {
+    scpi_dispatch_cache_t * cache = &context->dispatch_cache;
+    const scpi_dispatch_entry_t * entry;
+    uint8_t keyword = 0;
+    size_t pos = 0;
+    size_t len;
+    size_t i;
+
+    cacheValidate(context);
+
+    *hash = headerHash(header, &len);
+    entry = &cache->entries[*hash % SCPI_DISPATCH_CACHE_SIZE];
+
+    if ((entry->length == len) && (entry->hash == *hash)) {
+        for (i = 0; (i < len) && (entry->header[i] == headerNext(header, &keyword, &pos)); i++) {
+        }
+
+        if (i == len) {
+            cache->hits++;
+            header->prefix = entry->prefix;
+            *numbers = entry->numbers;
+            *table = entry->table;
+            return entry->cmd;
+        }
+    }
+
+    cache->misses++;
+    return NULL;
+}
+
+/**
+ * Remember command resolved for the header
+ * @param context
+ * @param header - program header
+ * @param numbers - numeric suffixes of the header
+ * @param hash - hash returned by scpiCache_Find
+ * @param cmd - resolved command
+ * @param table - command table of the command
+ */
+void scpiCache_Store(scpi_t * context, const scpi_header_t * header, const scpi_command_numbers_t * numbers, uint32_t hash, const scpi_command_t * cmd, const scpi_command_table_t * table) {
+    scpi_dispatch_entry_t * entry;
+    uint8_t keyword = 0;
+    size_t pos = 0;
+    size_t len;
+    char c;
+
+    entry = &context->dispatch_cache.entries[hash % SCPI_DISPATCH_CACHE_SIZE];
+    entry->length = 0;
+
+    for (len = 0; (c = headerNext(header, &keyword, &pos)) != 0; len++) {
+        if (len >= SCPI_DISPATCH_CACHE_HEADER_LENGTH) {
+            return;
+        }
+        entry->header[len] = c;
+    }
+
+    if (len == 0) {
+        return;
+    }
+
+    entry->hash = hash;
+    entry->length = len;
+    entry->cmd = cmd;
+    entry->table = table;
+    entry->prefix = header->prefix;
+    entry->numbers = *numbers;
+}
+
+#endif /* USE_DISPATCH_CACHE */
+
+#if USE_MESSAGE_CACHE
+
+/**
+ * Test if the message is the same as the remembered one
+ * @param context
+ * @param data - raw message
+ * @param len - length of message
+ * @param partial - data may continue after the remembered message if the
+ * remembered message was terminated by new line
+ * @return length of the remembered message or 0 if it can't be used
+ */
+size_t scpiCache_MessageMatch(scpi_t * context, const char * data, size_t len, scpi_bool_t partial) {
+    scpi_dispatch_cache_t * cache = &context->dispatch_cache;
+    size_t length;
+
+    cacheValidate(context);
+    length = cache->message_length;
+
+    if (partial && (length < len) && (length > 0)
+            && (cache->units[cache->unit_count - 1].termination == SCPI_MESSAGE_TERMINATION_NL)) {
+        len = length;
+    }
+
+    if (!cache->recording && (len > 0) && (length == len) && (memcmp(cache->message, data, len) == 0)) {
+        cache->message_hits++;
+        return length;
+    }
+
+    cache->message_misses++;
+    return 0;
+}
+
+/**
+ * Start remembering layout of new message
+ * @param context
+ */
+void scpiCache_MessageBegin(scpi_t * context) {
+    scpi_dispatch_cache_t * cache = &context->dispatch_cache;
+
+    cache->message_length = 0;
+    cache->unit_count = 0;
+    cache->recording = TRUE;
+}
+
+/**
+ * Remember one program message unit
+ * @param context
+ * @param data - beginning of the message
+ * @param header - program header as detected
+ * @param state - parser state after detection
+ * @param cmd - resolved command or NULL if the unit is not valid, its
+ * table and numeric suffixes are taken from context->param_list
+ */
+void scpiCache_MessageUnit(scpi_t * context, const char * data, const scpi_token_t * header, const scpi_parser_state_t * state, const scpi_command_t * cmd) {
+    scpi_dispatch_cache_t * cache = &context->dispatch_cache;
+    scpi_message_unit_t * unit;
+
+    if (!cache->recording) {
+        return;
+    }
+
+    if ((cmd == NULL) || (cache->unit_count >= SCPI_MESSAGE_CACHE_UNITS)) {
+        cache->recording = FALSE;
+        cache->message_length = 0;
+        return;
+    }
+
+    unit = &cache->units[cache->unit_count++];
+    unit->header_type = header->type;
+    unit->header = (uint16_t) (header->ptr - data);
+    unit->header_length = (uint16_t) header->len;
+    unit->data_type = state->programData.type;
+    unit->data = (uint16_t) (state->programData.ptr - data);
+    unit->data_length = (uint16_t) state->programData.len;
+    unit->numberOfParameters = state->numberOfParameters;
+    unit->termination = state->termination;
+    unit->cmd = cmd;
+    unit->table = context->param_list.table;
+    unit->numbers = context->param_list.numbers;
+}
+
+/**
+ * Finish remembering of the message
+ * @param context
+ * @param data - raw message or NULL to forget the message
+ * @param len - length of message
+ */
+void scpiCache_MessageEnd(scpi_t * context, const char * data, size_t len) {
+    scpi_dispatch_cache_t * cache = &context->dispatch_cache;
+
+    if (cache->recording && (cache->unit_count > 0) && data && (len > 0) && (len <= SCPI_MESSAGE_CACHE_LENGTH)) {
+        memcpy(cache->message, data, len);
+        cache->message_length = len;
+    } else {
+        cache->message_length = 0;
+    }
+    cache->recording = FALSE;
+}
+
+#endif /* USE_MESSAGE_CACHE */
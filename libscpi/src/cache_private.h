@@ -0,0 +1,68 @@
+/*-
+ * Copyright (c) 2012-2015 Jan Breuer,
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file   cache_private.h
+ *
+ * @brief  Dispatch cache
+ *
+ *
+ */
+
+#ifndef SCPI_CACHE_PRIVATE_H
+#define	SCPI_CACHE_PRIVATE_H
+
+#include "scpi/types.h"
+#include "utils_private.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#if USE_DISPATCH_CACHE || USE_MESSAGE_CACHE
+    void scpiCache_Invalidate(scpi_t * context) LOCAL;
+#endif /* USE_DISPATCH_CACHE || USE_MESSAGE_CACHE */
+
+#if USE_DISPATCH_CACHE
+    const scpi_command_t * scpiCache_Find(scpi_t * context, scpi_header_t * header, scpi_command_numbers_t * numbers, const scpi_command_table_t ** table, uint32_t * hash) LOCAL;
+    void scpiCache_Store(scpi_t * context, const scpi_header_t * header, const scpi_command_numbers_t * numbers, uint32_t hash, const scpi_command_t * cmd, const scpi_command_table_t * table) LOCAL;
+#endif /* USE_DISPATCH_CACHE */
+
+#if USE_MESSAGE_CACHE
+    size_t scpiCache_MessageMatch(scpi_t * context, const char * data, size_t len, scpi_bool_t partial) LOCAL;
+    void scpiCache_MessageBegin(scpi_t * context) LOCAL;
+    void scpiCache_MessageUnit(scpi_t * context, const char * data, const scpi_token_t * header, const scpi_parser_state_t * state, const scpi_command_t * cmd) LOCAL;
+    void scpiCache_MessageEnd(scpi_t * context, const char * data, size_t len) LOCAL;
+#endif /* USE_MESSAGE_CACHE */
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* SCPI_CACHE_PRIVATE_H */
+
@@ -0,0 +1,723 @@
+/*-
+ * Copyright (c) 2012-2015 Jan Breuer,
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file   decimal.c
+ *
+ * @brief  Conversion of decimal numbers to floating point
+ *
+ * IEEE 488.2 <NRf> numbers are converted without the C library, so the
+ * result does not depend on locale and only the given length of the token
+ * is read. The result is correctly rounded to nearest, ties to even.
+ *
+ * Numbers exactly representable in the target type are converted by
+ * Clinger's fast path, most others by Eisel-Lemire algorithm with table of
+ * 128-bit powers of five. Numbers with too many digits and ambiguous cases
+ * fall back to exact shifting of the decimal digits (simple decimal
+ * conversion).
+ */
+
+#include <float.h>
+#include <string.h>
+
+#include "utils_private.h"
+
+#if USE_DECIMAL_POWER_TABLE
+#include "decimal_table.h"
+#endif
+
+/* significant digits which fit into uint64_t */
+#define DECIMAL_MANTISSA_DIGITS 19
+/* digits needed for exact conversion of any double */
+#define DECIMAL_MAX_DIGITS 768
+/* left shift adds at most this number of digits */
+#define DECIMAL_MAX_SHIFT 60
+#define DECIMAL_SHIFT_DIGITS 19
+/* larger exponents are not read, the result is zero or infinity anyway */
+#define DECIMAL_MAX_EXPONENT 100000000
+
+/* Clinger's fast path needs arithmetic without excess precision */
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+#define DECIMAL_FAST_PATH 1
+#else
+#define DECIMAL_FAST_PATH 0
+#endif
+
+/* IEEE 754 binary format */
+typedef struct {
+    int mantissa_bits; /* explicit bits of mantissa */
+    int sign_bit;
+    int32_t minimum_exponent; /* negative bias */
+    int32_t infinite_power; /* biased exponent of infinity */
+    int32_t smallest_power; /* w * 10^q is zero for smaller q */
+    int32_t largest_power; /* w * 10^q is infinity for larger q */
+    int32_t min_round_to_even; /* range of q where ties can occur */
+    int32_t max_round_to_even;
+} decimal_format_t;
+
+static const decimal_format_t formatDouble = {52, 63, -1023, 0x7FF, -342, 308, -4, 23};
+static const decimal_format_t formatFloat = {23, 31, -127, 0xFF, -64, 38, -17, 10};
+
+/* Number as written */
+typedef struct {
+    uint64_t mantissa; /* first DECIMAL_MANTISSA_DIGITS significant digits */
+    int64_t exponent; /* value is mantissa * 10^exponent */
+    int64_t explicit_exponent;
+    scpi_bool_t negative;
+    scpi_bool_t truncated; /* nonzero digits after the mantissa */
+    const char * integer;
+    size_t integer_len;
+    const char * fraction;
+    size_t fraction_len;
+} decimal_number_t;
+
+/* Result before composing the binary representation */
+typedef struct {
+    uint64_t mantissa;
+    int32_t power2; /* biased, -1 if not known */
+} decimal_adjusted_t;
+
+/* Decimal digits 0.d[0]d[1]... * 10^decimal_point */
+typedef struct {
+    uint32_t num_digits;
+    int32_t decimal_point;
+    scpi_bool_t truncated;
+    uint8_t digits[DECIMAL_MAX_DIGITS + DECIMAL_SHIFT_DIGITS];
+} decimal_t;
+
+static scpi_bool_t isDigit(char c) {
+    return (c >= '0') && (c <= '9');
+}
+
+static const char * skipDecimalWs(const char * p, const char * end) {
+    while ((p < end) && ((*p == ' ') || (*p == '\t'))) {
+        p++;
+    }
+    return p;
+}
+
+static const char * skipDecimalDigits(const char * p, const char * end) {
+    while ((p < end) && isDigit(*p)) {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * Read <NRf> number, white space is allowed around the exponent mark
+ * @param str - number
+ * @param len - maximal length of the number
+ * @param num - parsed number
+ * @return number of bytes used or 0 if there is no number
+ */
+static size_t decimalParse(const char * str, size_t len, decimal_number_t * num) {
+    const char * end = str + len;
+    const char * p;
+    const char * q;
+    scpi_bool_t negative_exponent = FALSE;
+    int64_t significant = 0;
+    int64_t digit;
+    size_t i;
+    char c;
+
+    p = skipDecimalWs(str, end);
+
+    num->negative = FALSE;
+    if ((p < end) && ((*p == '+') || (*p == '-'))) {
+        num->negative = *p == '-';
+        p++;
+    }
+
+    num->integer = p;
+    p = skipDecimalDigits(p, end);
+    num->integer_len = p - num->integer;
+
+    num->fraction = p;
+    num->fraction_len = 0;
+    if ((p < end) && (*p == '.')) {
+        num->fraction = ++p;
+        p = skipDecimalDigits(p, end);
+        num->fraction_len = p - num->fraction;
+    }
+
+    if (num->integer_len + num->fraction_len == 0) {
+        return 0;
+    }
+
+    num->explicit_exponent = 0;
+    q = skipDecimalWs(p, end);
+    if ((q < end) && ((*q == 'e') || (*q == 'E'))) {
+        q = skipDecimalWs(q + 1, end);
+        if ((q < end) && ((*q == '+') || (*q == '-'))) {
+            negative_exponent = *q == '-';
+            q++;
+        }
+        if ((q < end) && isDigit(*q)) {
+            for (; (q < end) && isDigit(*q); q++) {
+                if (num->explicit_exponent < DECIMAL_MAX_EXPONENT) {
+                    num->explicit_exponent = num->explicit_exponent * 10 + (*q - '0');
+                }
+            }
+            if (negative_exponent) {
+                num->explicit_exponent = -num->explicit_exponent;
+            }
+            p = q;
+        }
+    }
+
+    /* first significant digits make the mantissa, the rest is counted */
+    num->mantissa = 0;
+    num->truncated = FALSE;
+    for (i = 0; i < num->integer_len + num->fraction_len; i++) {
+        c = (i < num->integer_len) ? num->integer[i] : num->fraction[i - num->integer_len];
+        digit = c - '0';
+        if ((significant == 0) && (digit == 0)) {
+            continue;
+        }
+        if (significant < DECIMAL_MANTISSA_DIGITS) {
+            num->mantissa = num->mantissa * 10 + (uint64_t) digit;
+        } else if (digit != 0) {
+            num->truncated = TRUE;
+        }
+        significant++;
+    }
+
+    num->exponent = num->explicit_exponent - (int64_t) num->fraction_len;
+    if (significant > DECIMAL_MANTISSA_DIGITS) {
+        num->exponent += significant - DECIMAL_MANTISSA_DIGITS;
+    }
+
+    return p - str;
+}
+
+/**
+ * Compose IEEE 754 representation
+ * @param am - mantissa and biased exponent
+ * @param negative
+ * @param format
+ * @return bits of the value
+ */
+static uint64_t decimalBits(decimal_adjusted_t am, scpi_bool_t negative, const decimal_format_t * format) {
+    uint64_t bits = am.mantissa | ((uint64_t) am.power2 << format->mantissa_bits);
+
+    if (negative) {
+        bits |= (uint64_t) 1 << format->sign_bit;
+    }
+    return bits;
+}
+
+static decimal_adjusted_t decimalZero(void) {
+    decimal_adjusted_t am = {0, 0};
+    return am;
+}
+
+static decimal_adjusted_t decimalInfinity(const decimal_format_t * format) {
+    decimal_adjusted_t am;
+    am.mantissa = 0;
+    am.power2 = format->infinite_power;
+    return am;
+}
+
+#if USE_DECIMAL_POWER_TABLE
+
+/**
+ * Full 64 x 64 bit multiplication
+ * @param a
+ * @param b
+ * @param high - upper half of the product
+ * @return lower half of the product
+ */
+static uint64_t decimalMultiply(uint64_t a, uint64_t b, uint64_t * high) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = (unsigned __int128) a * b;
+    *high = (uint64_t) (r >> 64);
+    return (uint64_t) r;
+#else
+    uint64_t a_lo = (uint32_t) a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t) b, b_hi = b >> 32;
+    uint64_t lo_lo = a_lo * b_lo;
+    uint64_t hi_lo = a_hi * b_lo;
+    uint64_t lo_hi = a_lo * b_hi;
+    uint64_t hi_hi = a_hi * b_hi;
+    uint64_t cross = (lo_lo >> 32) + (uint32_t) hi_lo + lo_hi;
+
+    *high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+    return (cross << 32) | (uint32_t) lo_lo;
+#endif
+}
+
+static int leadingZeros(uint64_t w) {
+#if defined(__GNUC__)
+    return __builtin_clzll(w);
+#else
+    int n = 0;
+    while (!(w & ((uint64_t) 1 << 63))) {
+        w <<= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/**
+ * Eisel-Lemire algorithm, convert w * 10^q
+ * @param q - decimal exponent
+ * @param w - decimal mantissa
+ * @param format
+ * @return result, power2 is -1 if the result can't be determined
+ */
+static decimal_adjusted_t eiselLemire(int64_t q, uint64_t w, const decimal_format_t * format) {
+    decimal_adjusted_t am;
+    const uint64_t * power;
+    uint64_t precision_mask = UINT64_C(0xFFFFFFFFFFFFFFFF) >> (format->mantissa_bits + 3);
+    uint64_t high, low, high2;
+    int upperbit, shift, lz;
+
+    if ((w == 0) || (q < format->smallest_power)) {
+        return decimalZero();
+    }
+    if (q > format->largest_power) {
+        return decimalInfinity(format);
+    }
+
+    lz = leadingZeros(w);
+    w <<= lz;
+
+    /* w * 5^q with enough precision for the mantissa */
+    power = decimalPowersOfFive[q - DECIMAL_SMALLEST_POWER];
+    low = decimalMultiply(w, power[0], &high);
+    if ((high & precision_mask) == precision_mask) {
+        decimalMultiply(w, power[1], &high2);
+        low += high2;
+        if (high2 > low) {
+            high++;
+        }
+    }
+
+    if ((low == UINT64_C(0xFFFFFFFFFFFFFFFF)) && ((q < -27) || (q > 55))) {
+        am.mantissa = 0;
+        am.power2 = -1;
+        return am;
+    }
+
+    upperbit = (int) (high >> 63);
+    shift = upperbit + 64 - format->mantissa_bits - 3;
+    am.mantissa = high >> shift;
+    am.power2 = (int32_t) ((((152170 + 65536) * (int32_t) q) >> 16) + 63 + upperbit - lz - format->minimum_exponent);
+
+    if (am.power2 <= 0) {
+        /* subnormal */
+        if (-am.power2 + 1 >= 64) {
+            return decimalZero();
+        }
+        am.mantissa >>= -am.power2 + 1;
+        am.mantissa += (am.mantissa & 1);
+        am.mantissa >>= 1;
+        am.power2 = (am.mantissa < ((uint64_t) 1 << format->mantissa_bits)) ? 0 : 1;
+        return am;
+    }
+
+    /* exactly halfway, round to even */
+    if ((low <= 1) && (q >= format->min_round_to_even) && (q <= format->max_round_to_even)
+            && ((am.mantissa & 3) == 1) && ((am.mantissa << shift) == high)) {
+        am.mantissa &= ~(uint64_t) 1;
+    }
+
+    am.mantissa += (am.mantissa & 1);
+    am.mantissa >>= 1;
+    if (am.mantissa >= ((uint64_t) 2 << format->mantissa_bits)) {
+        am.mantissa = (uint64_t) 1 << format->mantissa_bits;
+        am.power2++;
+    }
+    am.mantissa &= ~((uint64_t) 1 << format->mantissa_bits);
+
+    if (am.power2 >= format->infinite_power) {
+        return decimalInfinity(format);
+    }
+
+    return am;
+}
+
+#endif /* USE_DECIMAL_POWER_TABLE */
+
+static void decimalTrim(decimal_t * d) {
+    while ((d->num_digits > 0) && (d->digits[d->num_digits - 1] == 0)) {
+        d->num_digits--;
+    }
+}
+
+/**
+ * Divide decimal by 2^shift
+ * @param d
+ * @param shift - at most DECIMAL_MAX_SHIFT
+ */
+static void decimalRightShift(decimal_t * d, unsigned shift) {
+    uint64_t mask = ((uint64_t) 1 << shift) - 1;
+    uint64_t n = 0;
+    uint64_t digit;
+    uint32_t r = 0;
+    uint32_t w = 0;
+
+    for (; (n >> shift) == 0; r++) {
+        if (r >= d->num_digits) {
+            if (n == 0) {
+                d->num_digits = 0;
+                return;
+            }
+            while ((n >> shift) == 0) {
+                n *= 10;
+                r++;
+            }
+            break;
+        }
+        n = n * 10 + d->digits[r];
+    }
+    d->decimal_point -= (int32_t) r - 1;
+
+    for (; r < d->num_digits; r++) {
+        digit = n >> shift;
+        n &= mask;
+        d->digits[w++] = (uint8_t) digit;
+        n = n * 10 + d->digits[r];
+    }
+
+    while (n > 0) {
+        digit = n >> shift;
+        n &= mask;
+        if (w < DECIMAL_MAX_DIGITS) {
+            d->digits[w++] = (uint8_t) digit;
+        } else if (digit > 0) {
+            d->truncated = TRUE;
+        }
+        n *= 10;
+    }
+
+    d->num_digits = w;
+    decimalTrim(d);
+}
+
+/**
+ * Multiply decimal by 2^shift
+ *
+ * Digits are written from the end DECIMAL_SHIFT_DIGITS behind the old end
+ * and moved back afterwards.
+ *
+ * @param d
+ * @param shift - at most DECIMAL_MAX_SHIFT
+ */
+static void decimalLeftShift(decimal_t * d, unsigned shift) {
+    uint32_t r = d->num_digits;
+    uint32_t w = d->num_digits + DECIMAL_SHIFT_DIGITS;
+    uint32_t delta;
+    uint64_t n = 0;
+    uint64_t quo;
+
+    if (d->num_digits == 0) {
+        return;
+    }
+
+    while (r > 0) {
+        n += (uint64_t) d->digits[--r] << shift;
+        quo = n / 10;
+        d->digits[--w] = (uint8_t) (n - 10 * quo);
+        n = quo;
+    }
+
+    while (n > 0) {
+        quo = n / 10;
+        d->digits[--w] = (uint8_t) (n - 10 * quo);
+        n = quo;
+    }
+
+    delta = DECIMAL_SHIFT_DIGITS - w;
+    memmove(d->digits, d->digits + w, d->num_digits + delta);
+    d->num_digits += delta;
+    d->decimal_point += (int32_t) delta;
+
+    if (d->num_digits > DECIMAL_MAX_DIGITS) {
+        for (r = DECIMAL_MAX_DIGITS; r < d->num_digits; r++) {
+            if (d->digits[r] != 0) {
+                d->truncated = TRUE;
+            }
+        }
+        d->num_digits = DECIMAL_MAX_DIGITS;
+    }
+
+    decimalTrim(d);
+}
+
+/**
+ * Integer part of the decimal rounded to nearest, ties to even
+ * @param d
+ * @return rounded value
+ */
+static uint64_t decimalRound(const decimal_t * d) {
+    uint32_t dp;
+    uint32_t i;
+    uint64_t n = 0;
+    scpi_bool_t up = FALSE;
+
+    if ((d->num_digits == 0) || (d->decimal_point < 0)) {
+        return 0;
+    }
+    if (d->decimal_point > 18) {
+        return UINT64_C(0xFFFFFFFFFFFFFFFF);
+    }
+
+    dp = (uint32_t) d->decimal_point;
+    for (i = 0; i < dp; i++) {
+        n = n * 10 + ((i < d->num_digits) ? d->digits[i] : 0);
+    }
+
+    if (dp < d->num_digits) {
+        up = d->digits[dp] >= 5;
+        if ((d->digits[dp] == 5) && (dp + 1 == d->num_digits)) {
+            up = d->truncated || ((dp > 0) && (d->digits[dp - 1] & 1));
+        }
+    }
+
+    return up ? n + 1 : n;
+}
+
+/**
+ * Exact conversion by shifting of all decimal digits
+ * @param num - parsed number
+ * @param format
+ * @return result
+ */
+static decimal_adjusted_t decimalSlow(const decimal_number_t * num, const decimal_format_t * format) {
+    static const uint8_t powers[19] = {
+        0, 3, 6, 9, 13, 16, 19, 23, 26, 29, 33, 36, 39, 43, 46, 49, 53, 56, 59,
+    };
+    decimal_t d;
+    decimal_adjusted_t am;
+    int64_t decimal_point = 0;
+    uint32_t count = 0;
+    uint32_t shift;
+    uint32_t n;
+    int32_t exp2 = 0;
+    uint64_t mantissa;
+    uint8_t digit;
+    size_t i;
+
+    d.truncated = FALSE;
+    for (i = 0; i < num->integer_len + num->fraction_len; i++) {
+        digit = (uint8_t) (((i < num->integer_len) ? num->integer[i] : num->fraction[i - num->integer_len]) - '0');
+        if ((count == 0) && (digit == 0)) {
+            if (i >= num->integer_len) {
+                decimal_point--;
+            }
+            continue;
+        }
+        if (count < DECIMAL_MAX_DIGITS) {
+            d.digits[count++] = digit;
+        } else if (digit != 0) {
+            d.truncated = TRUE;
+        }
+        if (i < num->integer_len) {
+            decimal_point++;
+        }
+    }
+    d.num_digits = count;
+    decimalTrim(&d);
+    decimal_point += num->explicit_exponent;
+
+    if ((d.num_digits == 0) || (decimal_point < -324)) {
+        return decimalZero();
+    }
+    if (decimal_point >= 310) {
+        return decimalInfinity(format);
+    }
+    d.decimal_point = (int32_t) decimal_point;
+
+    /* shift to [1/2 ... 1] */
+    while (d.decimal_point > 0) {
+        n = (uint32_t) d.decimal_point;
+        shift = (n < sizeof (powers)) ? powers[n] : DECIMAL_MAX_SHIFT;
+        decimalRightShift(&d, shift);
+        exp2 += (int32_t) shift;
+    }
+
+    while (d.decimal_point <= 0) {
+        if (d.decimal_point == 0) {
+            if (d.digits[0] >= 5) {
+                break;
+            }
+            shift = (d.digits[0] < 2) ? 2 : 1;
+        } else {
+            n = (uint32_t) -d.decimal_point;
+            shift = (n < sizeof (powers)) ? powers[n] : DECIMAL_MAX_SHIFT;
+        }
+        decimalLeftShift(&d, shift);
+        exp2 -= (int32_t) shift;
+    }
+
+    /* binary format uses [1 ... 2] */
+    exp2--;
+
+    while (format->minimum_exponent + 1 > exp2) {
+        n = (uint32_t) (format->minimum_exponent + 1 - exp2);
+        if (n > DECIMAL_MAX_SHIFT) {
+            n = DECIMAL_MAX_SHIFT;
+        }
+        decimalRightShift(&d, n);
+        exp2 += (int32_t) n;
+    }
+
+    if (exp2 - format->minimum_exponent >= format->infinite_power) {
+        return decimalInfinity(format);
+    }
+
+    decimalLeftShift(&d, (unsigned) format->mantissa_bits + 1);
+    mantissa = decimalRound(&d);
+
+    /* rounding can overflow to next power of two */
+    if (mantissa >= ((uint64_t) 1 << (format->mantissa_bits + 1))) {
+        decimalRightShift(&d, 1);
+        exp2++;
+        mantissa = decimalRound(&d);
+        if (exp2 - format->minimum_exponent >= format->infinite_power) {
+            return decimalInfinity(format);
+        }
+    }
+
+    am.power2 = exp2 - format->minimum_exponent;
+    if (mantissa < ((uint64_t) 1 << format->mantissa_bits)) {
+        am.power2--;
+    }
+    am.mantissa = mantissa & (((uint64_t) 1 << format->mantissa_bits) - 1);
+
+    return am;
+}
+
+/**
+ * Convert parsed number to binary format
+ * @param num
+ * @param format
+ * @return bits of the value
+ */
+static uint64_t decimalToBinary(const decimal_number_t * num, const decimal_format_t * format) {
+    decimal_adjusted_t am;
+
+#if USE_DECIMAL_POWER_TABLE
+    am = eiselLemire(num->exponent, num->mantissa, format);
+    if (num->truncated && (am.power2 >= 0)) {
+        /* the value is between mantissa and mantissa + 1 */
+        decimal_adjusted_t am_up = eiselLemire(num->exponent, num->mantissa + 1, format);
+        if ((am.mantissa != am_up.mantissa) || (am.power2 != am_up.power2)) {
+            am.power2 = -1;
+        }
+    }
+    if (am.power2 < 0) {
+        am = decimalSlow(num, format);
+    }
+#else
+    am = decimalSlow(num, format);
+#endif
+
+    return decimalBits(am, num->negative, format);
+}
+
+/**
+ * Converts string to float (32 bit) representation
+ * @param str   string value
+ * @param len   length of string
+ * @param val   float result
+ * @return      number of bytes used in string
+ */
+size_t strToFloat(const char * str, size_t len, float * val) {
+    static const float powers[] = {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+    };
+    decimal_number_t num;
+    uint32_t bits;
+    size_t used;
+
+    used = decimalParse(str, len, &num);
+    if (used == 0) {
+        *val = 0;
+        return 0;
+    }
+
+#if DECIMAL_FAST_PATH
+    if (!num.truncated && (num.mantissa <= ((uint64_t) 1 << 24)) && (num.exponent >= -10) && (num.exponent <= 10)) {
+        *val = (float) num.mantissa;
+        *val = (num.exponent < 0) ? *val / powers[-num.exponent] : *val * powers[num.exponent];
+        if (num.negative) {
+            *val = -*val;
+        }
+        return used;
+    }
+#else
+    (void) powers;
+#endif
+
+    bits = (uint32_t) decimalToBinary(&num, &formatFloat);
+    memcpy(val, &bits, sizeof (*val));
+    return used;
+}
+
+/**
+ * Converts string to double (64 bit) representation
+ * @param str   string value
+ * @param len   length of string
+ * @param val   double result
+ * @return      number of bytes used in string
+ */
+size_t strToDouble(const char * str, size_t len, double * val) {
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+    decimal_number_t num;
+    uint64_t bits;
+    size_t used;
+
+    used = decimalParse(str, len, &num);
+    if (used == 0) {
+        *val = 0;
+        return 0;
+    }
+
+#if DECIMAL_FAST_PATH
+    if (!num.truncated && (num.mantissa <= ((uint64_t) 1 << 53)) && (num.exponent >= -22) && (num.exponent <= 22)) {
+        *val = (double) num.mantissa;
+        *val = (num.exponent < 0) ? *val / powers[-num.exponent] : *val * powers[num.exponent];
+        if (num.negative) {
+            *val = -*val;
+        }
+        return used;
+    }
+#else
+    (void) powers;
+#endif
+
+    bits = decimalToBinary(&num, &formatDouble);
+    memcpy(val, &bits, sizeof (*val));
+    return used;
+}
@@ -33,6 +33,8 @@
  *
  */
 
+#include <string.h>
+
 #include "scpi/expression.h"
 #include "scpi/error.h"
 #include "scpi/parser.h"
@@ -67,8 +69,231 @@ static scpi_expr_result_t numericRange(lex_state_t * state, scpi_bool_t * isRang
     return SCPI_EXPR_NO_MORE;
 }
 
+/**
+ * Parse next entry of numeric list
+ *
+ * When the list is finished, the lexer is moved to its end, so following
+ * calls return SCPI_EXPR_NO_MORE.
+ * @param list iterator
+ * @param isRange return true if parsed expression is range
+ * @param valueFrom return parsed value from
+ * @param valueTo return parsed value to
+ * @return SCPI_EXPR_OK - parsing was succesful
+ *         SCPI_EXPR_ERROR - parser error
+ *         SCPI_EXPR_NO_MORE - no more data
+ */
+static scpi_expr_result_t numericListNext(scpi_expr_list_t * list, scpi_bool_t * isRange, scpi_token_t * valueFrom, scpi_token_t * valueTo) {
+    scpi_expr_result_t res;
+    scpi_token_t token;
+
+    if ((list->index > 0) && !scpiLex_Comma(&list->lex, &token)) {
+        res = scpiLex_IsEos(&list->lex) ? SCPI_EXPR_NO_MORE : SCPI_EXPR_ERROR;
+    } else {
+        res = numericRange(&list->lex, isRange, valueFrom, valueTo);
+    }
+
+    if (res == SCPI_EXPR_OK) {
+        list->index++;
+    } else {
+        list->lex.pos = list->lex.buffer + list->lex.len;
+    }
+
+    return res;
+}
+
+/**
+ * Start reading numeric list entry by entry
+ *
+ * The list is read by SCPI_ExprNumericListNext or SCPI_ExprNumericListReadInt
+ * and SCPI_ExprNumericListReadDouble, each entry is parsed only once.
+ * If the parameter is not an expression, the list is empty.
+ * @param context scpi context
+ * @param param input parameter
+ * @param list iterator to initialize
+ * @return SCPI_EXPR_OK - list is ready
+ *         SCPI_EXPR_ERROR - parameter is not an expression
+ */
+scpi_expr_result_t SCPI_ExprNumericListBegin(scpi_t * context, scpi_parameter_t * param, scpi_expr_list_t * list) {
+    if (!list) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return SCPI_EXPR_ERROR;
+    }
+
+    list->ptr = NULL;
+    list->len = 0;
+    list->lex.buffer = NULL;
+    list->lex.pos = NULL;
+    list->lex.len = 0;
+    list->index = 0;
+    list->channel = FALSE;
+
+    if (!param) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return SCPI_EXPR_ERROR;
+    }
+
+    if (param->type != SCPI_TOKEN_PROGRAM_EXPRESSION) {
+        SCPI_ErrorPush(context, SCPI_ERROR_DATA_TYPE_ERROR);
+        return SCPI_EXPR_ERROR;
+    }
+
+    list->ptr = param->ptr;
+    list->len = param->len;
+    list->lex.buffer = param->ptr + 1;
+    list->lex.pos = list->lex.buffer;
+    list->lex.len = param->len - 2;
+
+    return SCPI_EXPR_OK;
+}
+
+/**
+ * Parse next entry of numeric list
+ * @param context scpi context
+ * @param list iterator from SCPI_ExprNumericListBegin
+ * @param isRange return true if expression was range
+ * @param valueFrom return value from
+ * @param valueTo return value to
+ * @return SCPI_EXPR_OK - parsing was succesful
+ *         SCPI_EXPR_ERROR - parser error
+ *         SCPI_EXPR_NO_MORE - no more data
+ */
+scpi_expr_result_t SCPI_ExprNumericListNext(scpi_t * context, scpi_expr_list_t * list, scpi_bool_t * isRange, scpi_parameter_t * valueFrom, scpi_parameter_t * valueTo) {
+    scpi_expr_result_t res;
+
+    if (!list || !isRange || !valueFrom || !valueTo) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return SCPI_EXPR_ERROR;
+    }
+
+    res = numericListNext(list, isRange, valueFrom, valueTo);
+    if (res == SCPI_EXPR_ERROR) {
+        SCPI_ErrorPush(context, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+    }
+    return res;
+}
+
+/**
+ * Read following entries of numeric list and convert them to int32_t
+ *
+ * Entries are stored until the arrays are full or the list ends, so long
+ * lists can be read in several calls.
+ * @param context scpi context
+ * @param list iterator from SCPI_ExprNumericListBegin
+ * @param isRange return array of flags, true if the entry was range
+ * @param valuesFrom return array of values from
+ * @param valuesTo return array of values to, value from for single values
+ * @param length length of the arrays
+ * @param count return number of stored entries
+ * @return SCPI_EXPR_OK - arrays are full, list may continue
+ *         SCPI_EXPR_ERROR - parser or conversion error
+ *         SCPI_EXPR_NO_MORE - end of list was reached
+ */
+scpi_expr_result_t SCPI_ExprNumericListReadInt(scpi_t * context, scpi_expr_list_t * list, scpi_bool_t * isRange, int32_t * valuesFrom, int32_t * valuesTo, size_t length, size_t * count) {
+    scpi_expr_result_t res = SCPI_EXPR_OK;
+    scpi_parameter_t paramFrom;
+    scpi_parameter_t paramTo;
+    size_t i;
+
+    if (!list || !count || (length && (!isRange || !valuesFrom || !valuesTo))) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return SCPI_EXPR_ERROR;
+    }
+
+    for (i = 0; i < length; i++) {
+        res = numericListNext(list, &isRange[i], &paramFrom, &paramTo);
+        if (res == SCPI_EXPR_ERROR) {
+            SCPI_ErrorPush(context, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+        }
+        if (res != SCPI_EXPR_OK) {
+            break;
+        }
+        if (!SCPI_ParamToInt32(context, &paramFrom, &valuesFrom[i])) {
+            res = SCPI_EXPR_ERROR;
+            break;
+        }
+        if (!isRange[i]) {
+            valuesTo[i] = valuesFrom[i];
+        } else if (!SCPI_ParamToInt32(context, &paramTo, &valuesTo[i])) {
+            res = SCPI_EXPR_ERROR;
+            break;
+        }
+    }
+
+    if ((i == length) && (res == SCPI_EXPR_OK) && scpiLex_IsEos(&list->lex)) {
+        res = SCPI_EXPR_NO_MORE;
+    }
+    if (res == SCPI_EXPR_ERROR) {
+        list->lex.pos = list->lex.buffer + list->lex.len;
+    }
+
+    *count = i;
+    return res;
+}
+
+/**
+ * Read following entries of numeric list and convert them to double
+ *
+ * Entries are stored until the arrays are full or the list ends, so long
+ * lists can be read in several calls.
+ * @param context scpi context
+ * @param list iterator from SCPI_ExprNumericListBegin
+ * @param isRange return array of flags, true if the entry was range
+ * @param valuesFrom return array of values from
+ * @param valuesTo return array of values to, value from for single values
+ * @param length length of the arrays
+ * @param count return number of stored entries
+ * @return SCPI_EXPR_OK - arrays are full, list may continue
+ *         SCPI_EXPR_ERROR - parser or conversion error
+ *         SCPI_EXPR_NO_MORE - end of list was reached
+ */
+scpi_expr_result_t SCPI_ExprNumericListReadDouble(scpi_t * context, scpi_expr_list_t * list, scpi_bool_t * isRange, double * valuesFrom, double * valuesTo, size_t length, size_t * count) {
+    scpi_expr_result_t res = SCPI_EXPR_OK;
+    scpi_parameter_t paramFrom;
+    scpi_parameter_t paramTo;
+    size_t i;
+
+    if (!list || !count || (length && (!isRange || !valuesFrom || !valuesTo))) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return SCPI_EXPR_ERROR;
+    }
+
+    for (i = 0; i < length; i++) {
+        res = numericListNext(list, &isRange[i], &paramFrom, &paramTo);
+        if (res == SCPI_EXPR_ERROR) {
+            SCPI_ErrorPush(context, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+        }
+        if (res != SCPI_EXPR_OK) {
+            break;
+        }
+        if (!SCPI_ParamToDouble(context, &paramFrom, &valuesFrom[i])) {
+            res = SCPI_EXPR_ERROR;
+            break;
+        }
+        if (!isRange[i]) {
+            valuesTo[i] = valuesFrom[i];
+        } else if (!SCPI_ParamToDouble(context, &paramTo, &valuesTo[i])) {
+            res = SCPI_EXPR_ERROR;
+            break;
+        }
+    }
+
+    if ((i == length) && (res == SCPI_EXPR_OK) && scpiLex_IsEos(&list->lex)) {
+        res = SCPI_EXPR_NO_MORE;
+    }
+    if (res == SCPI_EXPR_ERROR) {
+        list->lex.pos = list->lex.buffer + list->lex.len;
+    }
+
+    *count = i;
+    return res;
+}
+
 /**
  * Parse entry on specified position
+ *
+ * Position of the last parsed entry is remembered until the command
+ * callback returns, so reading entries in increasing order parses the
+ * list only once.
  * @param context scpi context
  * @param param input parameter
  * @param index index of position (start from 0)
@@ -81,8 +306,7 @@ static scpi_expr_result_t numericRange(lex_state_t * state, scpi_bool_t * isRang
  * @see SCPI_ExprNumericListEntryInt, SCPI_ExprNumericListEntryDouble
  */
 scpi_expr_result_t SCPI_ExprNumericListEntry(scpi_t * context, scpi_parameter_t * param, int index, scpi_bool_t * isRange, scpi_parameter_t * valueFrom, scpi_parameter_t * valueTo) {
-    lex_state_t lex;
-    int i;
+    scpi_expr_list_t * list = &context->param_list.expr_list;
     scpi_expr_result_t res = SCPI_EXPR_OK;
 
     if (!isRange || !valueFrom || !valueTo || !param) {
@@ -90,30 +314,19 @@ scpi_expr_result_t SCPI_ExprNumericListEntry(scpi_t * context, scpi_parameter_t
         return SCPI_EXPR_ERROR;
     }
 
-    if (param->type != SCPI_TOKEN_PROGRAM_EXPRESSION) {
-        SCPI_ErrorPush(context, SCPI_ERROR_DATA_TYPE_ERROR);
-        return SCPI_EXPR_ERROR;
+    if ((list->ptr == NULL) || (list->ptr != param->ptr) || (list->len != param->len) || list->channel || (index < list->index)) {
+        res = SCPI_ExprNumericListBegin(context, param, list);
     }
 
-    lex.buffer = param->ptr + 1;
-    lex.pos = lex.buffer;
-    lex.len = param->len - 2;
-
-    for (i = 0; i <= index; i++) {
-        res = numericRange(&lex, isRange, valueFrom, valueTo);
-        if (res != SCPI_EXPR_OK) {
-            break;
-        }
-        if (i != index) {
-            if (!scpiLex_Comma(&lex, valueFrom)) {
-                res = scpiLex_IsEos(&lex) ? SCPI_EXPR_NO_MORE : SCPI_EXPR_ERROR;
-                break;
-            }
-        }
+    while ((res == SCPI_EXPR_OK) && (list->index <= index)) {
+        res = numericListNext(list, isRange, valueFrom, valueTo);
     }
 
     if (res == SCPI_EXPR_ERROR) {
-        SCPI_ErrorPush(context, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+        list->ptr = NULL;
+        if (param->type == SCPI_TOKEN_PROGRAM_EXPRESSION) {
+            SCPI_ErrorPush(context, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+        }
     }
     return res;
 }
@@ -250,6 +463,102 @@ static scpi_expr_result_t channelRange(scpi_t * context, lex_state_t * state, sc
     return err;
 }
 
+/**
+ * Parse next entry of channel list
+ *
+ * When the list is finished, the lexer is moved to its end, so following
+ * calls return SCPI_EXPR_NO_MORE.
+ * @param context
+ * @param list iterator
+ * @param isRange return true if it is range
+ * @param valuesFrom return array of values from
+ * @param valuesTo return array of values to
+ * @param length length of values arrays
+ * @param dimensions real number of dimensions
+ * @return SCPI_EXPR_OK - parsing was succesful
+ *         SCPI_EXPR_ERROR - parser error
+ *         SCPI_EXPR_NO_MORE - no more data
+ */
+static scpi_expr_result_t channelListNext(scpi_t * context, scpi_expr_list_t * list, scpi_bool_t * isRange, int32_t * valuesFrom, int32_t * valuesTo, size_t length, size_t * dimensions) {
+    scpi_expr_result_t res;
+    scpi_token_t token;
+
+    if ((list->index > 0) && !scpiLex_Comma(&list->lex, &token)) {
+        res = scpiLex_IsEos(&list->lex) ? SCPI_EXPR_NO_MORE : SCPI_EXPR_ERROR;
+    } else {
+        res = channelRange(context, &list->lex, isRange, valuesFrom, valuesTo, length, dimensions);
+        if ((res == SCPI_EXPR_NO_MORE) && !scpiLex_IsEos(&list->lex)) {
+            res = SCPI_EXPR_ERROR;
+        }
+    }
+
+    if (res == SCPI_EXPR_OK) {
+        list->index++;
+    } else {
+        list->lex.pos = list->lex.buffer + list->lex.len;
+    }
+
+    return res;
+}
+
+/**
+ * Start reading channel list entry by entry
+ *
+ * If the parameter is not a channel list, the list is empty.
+ * @param context scpi context
+ * @param param input parameter
+ * @param list iterator to initialize
+ * @return SCPI_EXPR_OK - list is ready
+ *         SCPI_EXPR_ERROR - parameter is not a channel list
+ */
+scpi_expr_result_t SCPI_ExprChannelListBegin(scpi_t * context, scpi_parameter_t * param, scpi_expr_list_t * list) {
+    scpi_token_t token;
+
+    if (SCPI_ExprNumericListBegin(context, param, list) != SCPI_EXPR_OK) {
+        return SCPI_EXPR_ERROR;
+    }
+
+    list->channel = TRUE;
+
+    // detect channel list expression
+    if (!scpiLex_SpecificCharacter(&list->lex, &token, '@')) {
+        list->ptr = NULL;
+        list->lex.pos = list->lex.buffer + list->lex.len;
+        SCPI_ErrorPush(context, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+        return SCPI_EXPR_ERROR;
+    }
+
+    return SCPI_EXPR_OK;
+}
+
+/**
+ * Parse next entry of channel list
+ * @param context scpi context
+ * @param list iterator from SCPI_ExprChannelListBegin
+ * @param isRange return true if it is range
+ * @param valuesFrom return array of values from
+ * @param valuesTo return array of values to
+ * @param length length of values arrays
+ * @param dimensions real number of dimensions
+ * @return SCPI_EXPR_OK - parsing was succesful
+ *         SCPI_EXPR_ERROR - parser error
+ *         SCPI_EXPR_NO_MORE - no more data
+ */
+scpi_expr_result_t SCPI_ExprChannelListNext(scpi_t * context, scpi_expr_list_t * list, scpi_bool_t * isRange, int32_t * valuesFrom, int32_t * valuesTo, size_t length, size_t * dimensions) {
+    scpi_expr_result_t res;
+
+    if (!list || !isRange || !dimensions || (length && (!valuesFrom || !valuesTo))) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return SCPI_EXPR_ERROR;
+    }
+
+    res = channelListNext(context, list, isRange, valuesFrom, valuesTo, length, dimensions);
+    if (res == SCPI_EXPR_ERROR) {
+        SCPI_ErrorPush(context, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+    }
+    return res;
+}
+
 /**
  * Parse one list entry at specific position e.g. "1!2:5!6"
  * @param context
@@ -262,52 +571,241 @@ static scpi_expr_result_t channelRange(scpi_t * context, lex_state_t * state, sc
  * @param dimensions real number of dimensions
  */
 scpi_expr_result_t SCPI_ExprChannelListEntry(scpi_t * context, scpi_parameter_t * param, int index, scpi_bool_t * isRange, int32_t * valuesFrom, int32_t * valuesTo, size_t length, size_t * dimensions) {
-    lex_state_t lex;
-    int i;
+    scpi_expr_list_t * list = &context->param_list.expr_list;
     scpi_expr_result_t res = SCPI_EXPR_OK;
-    scpi_token_t token;
 
     if (!isRange || !param || !dimensions || (length && (!valuesFrom || !valuesTo))) {
         SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
         return SCPI_EXPR_ERROR;
     }
 
-    if (param->type != SCPI_TOKEN_PROGRAM_EXPRESSION) {
-        SCPI_ErrorPush(context, SCPI_ERROR_DATA_TYPE_ERROR);
-        return SCPI_EXPR_ERROR;
+    if ((list->ptr == NULL) || (list->ptr != param->ptr) || (list->len != param->len) || !list->channel || (index < list->index)) {
+        if (SCPI_ExprChannelListBegin(context, param, list) != SCPI_EXPR_OK) {
+            return SCPI_EXPR_ERROR;
+        }
     }
 
-    lex.buffer = param->ptr + 1;
-    lex.pos = lex.buffer;
-    lex.len = param->len - 2;
+    while ((res == SCPI_EXPR_OK) && (list->index <= index)) {
+        if (list->index == index) {
+            res = channelListNext(context, list, isRange, valuesFrom, valuesTo, length, dimensions);
+        } else {
+            res = channelListNext(context, list, isRange, NULL, NULL, 0, dimensions);
+        }
+    }
 
-    // detect channel list expression
-    if (!scpiLex_SpecificCharacter(&lex, &token, '@')) {
+    if (res == SCPI_EXPR_ERROR) {
+        list->ptr = NULL;
+        SCPI_ErrorPush(context, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+    }
+    return res;
+}
+
+/**
+ * Parse channel list entry for expansion to single channels
+ * @param context
+ * @param list iterator
+ * @param valuesFrom return values from, size SCPI_CHANNEL_DIMENSIONS
+ * @param valuesTo return values to, same as values from for single channel
+ * @param dimensions expected number of dimensions
+ * @return SCPI_EXPR_OK - parsing was succesful
+ *         SCPI_EXPR_ERROR - parser error or wrong number of dimensions,
+ *         error is pushed
+ *         SCPI_EXPR_NO_MORE - no more data
+ */
+static scpi_expr_result_t channelListExpandNext(scpi_t * context, scpi_expr_list_t * list, int32_t * valuesFrom, int32_t * valuesTo, size_t dimensions) {
+    scpi_expr_result_t res;
+    scpi_bool_t isRange = FALSE;
+    size_t real;
+
+    res = channelListNext(context, list, &isRange, valuesFrom, valuesTo, SCPI_CHANNEL_DIMENSIONS, &real);
+    if (res == SCPI_EXPR_ERROR) {
         SCPI_ErrorPush(context, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+    } else if ((res == SCPI_EXPR_OK) && (real != dimensions)) {
+        SCPI_ErrorPush(context, SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+        res = SCPI_EXPR_ERROR;
+    } else if ((res == SCPI_EXPR_OK) && !isRange) {
+        memcpy(valuesTo, valuesFrom, dimensions * sizeof (int32_t));
+    }
+
+    return res;
+}
+
+/**
+ * Expand channel list to single channels in one pass
+ *
+ * Channel i is stored in values[i * dimensions] to
+ * values[i * dimensions + dimensions - 1]. Ranges are expanded row by
+ * row, e.g. "(@1!1:2!2)" is 1!1, 1!2, 2!1, 2!2, and they can go down.
+ * @param context scpi context
+ * @param param input parameter
+ * @param values return array of channels
+ * @param dimensions number of dimensions of each entry, at most
+ * SCPI_CHANNEL_DIMENSIONS
+ * @param length number of channels fitting into values
+ * @param count return number of stored channels
+ * @return SCPI_EXPR_OK - whole list was expanded
+ *         SCPI_EXPR_ERROR - parser error, entry with other number of
+ *         dimensions, more than length channels or length * dimensions
+ *         not representable in size_t
+ */
+scpi_expr_result_t SCPI_ExprChannelListFlat(scpi_t * context, scpi_parameter_t * param, int32_t * values, size_t dimensions, size_t length, size_t * count) {
+    scpi_expr_list_t list;
+    scpi_expr_result_t res;
+    int32_t valuesFrom[SCPI_CHANNEL_DIMENSIONS];
+    int32_t valuesTo[SCPI_CHANNEL_DIMENSIONS];
+    int32_t channel[SCPI_CHANNEL_DIMENSIONS];
+    size_t i;
+
+    if (!count || (length && !values) || (dimensions == 0) || (dimensions > SCPI_CHANNEL_DIMENSIONS)
+            || (length > SIZE_MAX / dimensions)) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
         return SCPI_EXPR_ERROR;
     }
 
-    for (i = 0; i <= index; i++) {
-        res = channelRange(context, &lex, isRange, valuesFrom, valuesTo, (i == index) ? length : 0, dimensions);
-        if (res != SCPI_EXPR_OK) {
-            break;
-        }
-        if (i != index) {
-            if (!scpiLex_Comma(&lex, &token)) {
-                res = scpiLex_IsEos(&lex) ? SCPI_EXPR_NO_MORE : SCPI_EXPR_ERROR;
-                break;
+    *count = 0;
+
+    if (SCPI_ExprChannelListBegin(context, param, &list) != SCPI_EXPR_OK) {
+        return SCPI_EXPR_ERROR;
+    }
+
+    while ((res = channelListExpandNext(context, &list, valuesFrom, valuesTo, dimensions)) == SCPI_EXPR_OK) {
+        memcpy(channel, valuesFrom, dimensions * sizeof (int32_t));
+        do {
+            if (*count >= length) {
+                SCPI_ErrorPush(context, SCPI_ERROR_TOO_MUCH_DATA);
+                return SCPI_EXPR_ERROR;
+            }
+            memcpy(&values[*count * dimensions], channel, dimensions * sizeof (int32_t));
+            (*count)++;
+
+            /* next channel of the range, last dimension first */
+            for (i = dimensions; i > 0; i--) {
+                if (channel[i - 1] != valuesTo[i - 1]) {
+                    channel[i - 1] += (valuesFrom[i - 1] < valuesTo[i - 1]) ? 1 : -1;
+                    break;
+                }
+                channel[i - 1] = valuesFrom[i - 1];
             }
+        } while (i > 0);
+    }
+
+    return (res == SCPI_EXPR_NO_MORE) ? SCPI_EXPR_OK : SCPI_EXPR_ERROR;
+}
+
+/**
+ * Set n consecutive bits
+ * @param bits
+ * @param start index of the first bit
+ * @param n number of bits
+ */
+static void bitsSet(uint32_t * bits, size_t start, size_t n) {
+    size_t shift;
+    size_t take;
+
+    while (n > 0) {
+        shift = start % 32;
+        take = 32 - shift;
+        if (take > n) {
+            take = n;
+        }
+        if (take == 32) {
+            bits[start / 32] = UINT32_C(0xFFFFFFFF);
+        } else {
+            bits[start / 32] |= ((UINT32_C(1) << take) - 1) << shift;
         }
+        start += take;
+        n -= take;
     }
+}
 
-    if (res == SCPI_EXPR_ERROR) {
-        SCPI_ErrorPush(context, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+/**
+ * Convert channel list to bitset of channel matrix
+ *
+ * Bits of all channels in the list are set, others are cleared. Runs of
+ * the last dimension are set a word at a time, so ranges over large
+ * matrices cost one operation per 32 channels. Bit of channel c is
+ * bits[k / 32] & (1 << (k % 32)), where k is row-major index of c in the
+ * geometry.
+ * @param context scpi context
+ * @param param input parameter
+ * @param geometry declared channel matrix
+ * @param bits return bitset
+ * @param words length of bits array, enough for all channels of geometry
+ * @return SCPI_EXPR_OK - whole list was converted
+ *         SCPI_EXPR_ERROR - parser error, entry with other number of
+ *         dimensions, channel outside of geometry or geometry with more
+ *         channels than size_t or words can hold
+ */
+scpi_expr_result_t SCPI_ExprChannelListBitset(scpi_t * context, scpi_parameter_t * param, const scpi_channel_geometry_t * geometry, uint32_t * bits, size_t words) {
+    scpi_expr_list_t list;
+    scpi_expr_result_t res;
+    int32_t valuesFrom[SCPI_CHANNEL_DIMENSIONS];
+    int32_t valuesTo[SCPI_CHANNEL_DIMENSIONS];
+    int32_t low[SCPI_CHANNEL_DIMENSIONS];
+    int32_t high[SCPI_CHANNEL_DIMENSIONS];
+    int32_t channel[SCPI_CHANNEL_DIMENSIONS];
+    size_t dimensions;
+    size_t total = 1;
+    size_t index;
+    size_t i;
+
+    if (!geometry || !bits || (geometry->dimensions == 0) || (geometry->dimensions > SCPI_CHANNEL_DIMENSIONS)) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return SCPI_EXPR_ERROR;
     }
-    if (res == SCPI_EXPR_NO_MORE) {
-        if (!scpiLex_IsEos(&lex)) {
-            res = SCPI_EXPR_ERROR;
-            SCPI_ErrorPush(context, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+
+    dimensions = geometry->dimensions;
+    for (i = 0; i < dimensions; i++) {
+        if (geometry->size[i] <= 0) {
+            SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+            return SCPI_EXPR_ERROR;
+        }
+        /* matrix with more channels than size_t can index */
+        if ((size_t) geometry->size[i] > SIZE_MAX / total) {
+            SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+            return SCPI_EXPR_ERROR;
         }
+        total *= (size_t) geometry->size[i];
     }
-    return res;
+    if ((total - 1) / 32 >= words) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return SCPI_EXPR_ERROR;
+    }
+
+    memset(bits, 0, words * sizeof (uint32_t));
+
+    if (SCPI_ExprChannelListBegin(context, param, &list) != SCPI_EXPR_OK) {
+        return SCPI_EXPR_ERROR;
+    }
+
+    while ((res = channelListExpandNext(context, &list, valuesFrom, valuesTo, dimensions)) == SCPI_EXPR_OK) {
+        for (i = 0; i < dimensions; i++) {
+            low[i] = (valuesFrom[i] < valuesTo[i]) ? valuesFrom[i] : valuesTo[i];
+            high[i] = (valuesFrom[i] < valuesTo[i]) ? valuesTo[i] : valuesFrom[i];
+            if ((low[i] < geometry->first[i]) || ((int64_t) high[i] - geometry->first[i] >= geometry->size[i])) {
+                SCPI_ErrorPush(context, SCPI_ERROR_DATA_OUT_OF_RANGE);
+                return SCPI_EXPR_ERROR;
+            }
+        }
+
+        memcpy(channel, low, dimensions * sizeof (int32_t));
+        do {
+            index = 0;
+            for (i = 0; i < dimensions; i++) {
+                index = index * (size_t) geometry->size[i] + (size_t) (channel[i] - geometry->first[i]);
+            }
+            bitsSet(bits, index, (size_t) (high[dimensions - 1] - low[dimensions - 1]) + 1);
+
+            /* next run of the last dimension */
+            for (i = dimensions - 1; i > 0; i--) {
+                if (channel[i - 1] != high[i - 1]) {
+                    channel[i - 1]++;
+                    break;
+                }
+                channel[i - 1] = low[i - 1];
+            }
+        } while (i > 0);
+    }
+
+    return (res == SCPI_EXPR_NO_MORE) ? SCPI_EXPR_OK : SCPI_EXPR_ERROR;
 }
@@ -0,0 +1,477 @@
+/*-
+ * Copyright (c) 2012-2015 Jan Breuer,
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * @file   index.c
+ *
+ * @brief  Command index (keyword trie)
+ *
+ * The command list is compiled into a tree of keywords. Optional parts
+ * of the patterns are expanded while building, so every path from the
+ * root to a terminal node is one accepted spelling of the command.
+ *
+ * Children of a node are a linked list scanned linearly, a header keyword
+ * can match more of them (short and long form, numeric suffix), so they
+ * are not sorted. The lookup visits one list per header keyword and costs
+ * O(header keywords * children per node), e.g. about 20 comparisons for
+ * "SOURce:VOLTage" in a list where 10 subsystems have 10 commands each,
+ * instead of one comparison per command in the list.
+ */
+
+#include <string.h>
+
+#include "scpi/parser.h"
+#include "index_private.h"
+
+#define INDEX_ROOT      0
+#define INDEX_NONE      (-1)
+#define INDEX_UNSEEN    (-2)
+
+/**
+ * Find first lowercase character in keyword
+ * @param keyword
+ * @param len
+ * @return length of the short form
+ */
+static size_t keywordShortLength(const char * keyword, size_t len) {
+    size_t i;
+    for (i = 0; i < len; i++) {
+        if ((keyword[i] >= 'a') && (keyword[i] <= 'z')) {
+            return i;
+        }
+    }
+    return i;
+}
+
+/**
+ * Count numeric suffixes in part of the pattern
+ * @param pattern
+ * @param end
+ * @return number of '#' characters
+ */
+static int indexSuffixCount(const char * pattern, const char * end) {
+    int result = 0;
+    for (; pattern < end; pattern++) {
+        if (*pattern == '#') {
+            result++;
+        }
+    }
+    return result;
+}
+
+/**
+ * Find child of node with the same keyword or append new one
+ * @param nodes - node storage
+ * @param length - size of node storage
+ * @param count - number of used nodes
+ * @param parent - parent node
+ * @param keyword - keyword from the pattern, including optional '#'
+ * @param len - length of keyword
+ * @param slot - ordinal of numeric suffix of the keyword in the pattern
+ * @return index of child node or INDEX_NONE if storage is exhausted
+ */
+static int32_t indexChild(scpi_command_node_t * nodes, size_t length, size_t * count, int32_t parent, const char * keyword, size_t len, int slot) {
+    int32_t * link;
+    scpi_command_node_t * node;
+
+    if ((len > 0) && (keyword[len - 1] == '#')) {
+        len--;
+    } else {
+        slot = INDEX_NONE;
+    }
+
+    if ((len > UINT8_MAX) || (slot > INT8_MAX)) {
+        return INDEX_NONE;
+    }
+
+    /* the same keyword with suffix in other position of other pattern gets its own node */
+    for (link = &nodes[parent].child; *link != INDEX_NONE; link = &nodes[*link].next) {
+        node = &nodes[*link];
+        if ((node->slot == slot) && (node->length == len) && (strncmp(node->keyword, keyword, len) == 0)) {
+            return *link;
+        }
+    }
+
+    if (*count >= length) {
+        return INDEX_NONE;
+    }
+
+    node = &nodes[*count];
+    node->keyword = keyword;
+    node->length = len;
+    node->short_length = keywordShortLength(keyword, len);
+    node->slot = (int8_t) slot;
+    node->parent = parent;
+    node->child = INDEX_NONE;
+    node->next = INDEX_NONE;
+    node->cmd = INDEX_NONE;
+    node->query = INDEX_NONE;
+
+    *link = (int32_t) * count;
+    (*count)++;
+
+    return *link;
+}
+
+/**
+ * Insert all spellings of the pattern under the node
+ * @param nodes - node storage
+ * @param length - size of node storage
+ * @param count - number of used nodes
+ * @param node - current node
+ * @param pattern - rest of the pattern
+ * @param end - end of the pattern without query mark
+ * @param slot - ordinal of next numeric suffix in the pattern
+ * @param cmd - position of the command in command list
+ * @param query - pattern is a query
+ * @return TRUE if successful
+ */
+static scpi_bool_t indexInsert(scpi_command_node_t * nodes, size_t length, size_t * count, int32_t node, const char * pattern, const char * end, int slot, int32_t cmd, scpi_bool_t query) {
+    const char * keyword;
+    const char * close;
+    int depth;
+    int32_t * terminal;
+
+    while ((pattern < end) && ((*pattern == ':') || (*pattern == ']'))) {
+        pattern++;
+    }
+
+    if (pattern == end) {
+        terminal = query ? &nodes[node].query : &nodes[node].cmd;
+        if (*terminal == INDEX_NONE) {
+            *terminal = cmd;
+        }
+        return TRUE;
+    }
+
+    if (*pattern == '[') {
+        depth = 0;
+        for (close = pattern; close < end; close++) {
+            if (*close == '[') {
+                depth++;
+            } else if ((*close == ']') && (--depth == 0)) {
+                break;
+            }
+        }
+
+        if (close == end) {
+            return FALSE;
+        }
+
+        /* spelling without the optional part, then with it */
+        return indexInsert(nodes, length, count, node, close + 1, end, slot + indexSuffixCount(pattern, close), cmd, query) &&
+                indexInsert(nodes, length, count, node, pattern + 1, end, slot, cmd, query);
+    }
+
+    keyword = pattern;
+    while ((pattern < end) && (*pattern != ':') && (*pattern != '[') && (*pattern != ']')) {
+        pattern++;
+    }
+
+    node = indexChild(nodes, length, count, node, keyword, pattern - keyword, slot);
+    if (node == INDEX_NONE) {
+        return FALSE;
+    }
+
+    if (nodes[node].slot >= 0) {
+        slot++;
+    }
+
+    return indexInsert(nodes, length, count, node, pattern, end, slot, cmd, query);
+}
+
+/**
+ * Count nodes one pattern can add to the index
+ * @param pattern
+ * @return number of keywords multiplied by number of spellings
+ */
+static size_t indexPatternNodes(const char * pattern) {
+    size_t keywords = 0;
+    size_t groups = 0;
+    scpi_bool_t in_keyword = FALSE;
+
+    for (; *pattern != '\0'; pattern++) {
+        if ((*pattern == ':') || (*pattern == '[') || (*pattern == ']') || (*pattern == '?')) {
+            if (*pattern == '[') {
+                groups++;
+            }
+            in_keyword = FALSE;
+        } else if (!in_keyword) {
+            keywords++;
+            in_keyword = TRUE;
+        }
+    }
+
+    return keywords << groups;
+}
+
+/**
+ * Number of nodes sufficient to build index of command list
+ *
+ * Every keyword is counted once for every spelling of its pattern, the
+ * same as command_index_bound() in scpi/index.hpp. Keywords shared by more
+ * patterns are merged by SCPI_CommandIndexBuild(), so the number of nodes
+ * really used, stored in index->count, is usually much smaller.
+ *
+ * @param cmdlist - command list terminated by SCPI_CMD_LIST_END
+ * @return number of nodes including the root
+ */
+size_t SCPI_CommandIndexNodes(const scpi_command_t * cmdlist) {
+    size_t result = 1;
+    int32_t i;
+
+    if (cmdlist == NULL) {
+        return 0;
+    }
+
+    for (i = 0; cmdlist[i].pattern != NULL; i++) {
+        result += indexPatternNodes(cmdlist[i].pattern);
+    }
+
+    return result;
+}
+
+/**
+ * Build command index from command list
+ *
+ * Storage for the nodes is provided by the caller. One node is needed for
+ * the root and one for every distinct keyword of every spelling of the
+ * patterns, SCPI_CommandIndexNodes() gives a sufficient size. Finished index is not modified by the parser and can be shared
+ * by more contexts using the same command list.
+ *
+ * @param index - index to initialize
+ * @param cmdlist - command list terminated by SCPI_CMD_LIST_END
+ * @param nodes - storage for nodes
+ * @param length - number of nodes in storage
+ * @return TRUE if successful, FALSE if storage is too small or pattern is malformed
+ */
+scpi_bool_t SCPI_CommandIndexBuild(scpi_command_index_t * index, const scpi_command_t * cmdlist, scpi_command_node_t * nodes, size_t length) {
+    size_t count = 0;
+    size_t pattern_len;
+    scpi_bool_t query;
+    int32_t i;
+    const char * pattern;
+
+    index->cmdlist = NULL;
+    index->nodes = nodes;
+    index->count = 0;
+
+    if ((cmdlist == NULL) || (nodes == NULL) || (length < 1)) {
+        return FALSE;
+    }
+
+    nodes[INDEX_ROOT].keyword = NULL;
+    nodes[INDEX_ROOT].length = 0;
+    nodes[INDEX_ROOT].short_length = 0;
+    nodes[INDEX_ROOT].slot = INDEX_NONE;
+    nodes[INDEX_ROOT].parent = INDEX_NONE;
+    nodes[INDEX_ROOT].child = INDEX_NONE;
+    nodes[INDEX_ROOT].next = INDEX_NONE;
+    nodes[INDEX_ROOT].cmd = INDEX_NONE;
+    nodes[INDEX_ROOT].query = INDEX_NONE;
+    count = 1;
+
+    for (i = 0; cmdlist[i].pattern != NULL; i++) {
+        pattern = cmdlist[i].pattern;
+        pattern_len = strlen(pattern);
+        query = (pattern_len > 0) && (pattern[pattern_len - 1] == '?');
+        if (query) {
+            pattern_len--;
+        }
+
+        if (!indexInsert(nodes, length, &count, INDEX_ROOT, pattern, pattern + pattern_len, 0, i, query)) {
+            return FALSE;
+        }
+    }
+
+    index->count = count;
+    index->cmdlist = cmdlist;
+
+    return TRUE;
+}
+
+/**
+ * Compare header keyword with node keyword
+ * @param node
+ * @param str - upper-cased keyword from header
+ * @param len - length of keyword
+ * @return TRUE if keyword matches long or short form
+ */
+static scpi_bool_t indexMatch(const scpi_command_node_t * node, const char * str, size_t len) {
+    if (node->slot >= 0) {
+        return compareKeywordAndNum(node->keyword, node->length, str, len, NULL) ||
+                compareKeywordAndNum(node->keyword, node->short_length, str, len, NULL);
+    } else {
+        return compareKeyword(node->keyword, node->length, str, len) ||
+                compareKeyword(node->keyword, node->short_length, str, len);
+    }
+}
+
+/**
+ * Read numeric suffix of header keyword matched by the node
+ * @param node
+ * @param str - keyword from header
+ * @param len - length of keyword
+ * @param value - parsed suffix
+ * @return TRUE if the keyword has a suffix
+ */
+static scpi_bool_t indexSuffix(const scpi_command_node_t * node, const char * str, size_t len, int32_t * value) {
+    if (compareKeywordAndNum(node->keyword, node->length, str, len, value)) {
+        return len > node->length;
+    }
+
+    if (compareKeywordAndNum(node->keyword, node->short_length, str, len, value)) {
+        return len > node->short_length;
+    }
+
+    return FALSE;
+}
+
+/* state of one index search */
+typedef struct {
+    const scpi_command_node_t * nodes;
+    const scpi_header_t * header;
+    int32_t path[SCPI_HEADER_KEYWORDS];
+    int32_t best;
+    int32_t prefix;
+    scpi_command_numbers_t * numbers;
+} index_search_t;
+
+/**
+ * Capture numeric suffixes along the path of new best candidate
+ * @param search
+ */
+static void indexCapture(index_search_t * search) {
+    const scpi_command_node_t * node;
+    const scpi_keyword_t * keyword;
+    int32_t value;
+    uint8_t depth;
+
+    search->numbers->given = 0;
+
+    for (depth = 0; depth < search->header->count; depth++) {
+        node = &search->nodes[search->path[depth]];
+        keyword = &search->header->keywords[depth];
+        if ((node->slot >= 0) && (node->slot < SCPI_COMMAND_NUMBERS) && indexSuffix(node, search->header->buffer + keyword->offset, keyword->length, &value)) {
+            search->numbers->values[node->slot] = value;
+            search->numbers->given |= 1UL << node->slot;
+        }
+    }
+}
+
+/**
+ * Walk the index and find the first command in command list accepting the header
+ *
+ * All children of the node are compared with the keyword of the header,
+ * more of them can match it.
+ *
+ * Node reached by the keywords of the header without the last one is
+ * remembered, so the next header of compound message can continue from
+ * it. If more nodes are reached that way, none of them is remembered.
+ *
+ * @param search
+ * @param node - current node
+ * @param depth - number of keywords of header already matched
+ */
+static void indexFind(index_search_t * search, int32_t node, uint8_t depth) {
+    const scpi_command_node_t * nodes = search->nodes;
+    const scpi_header_t * header = search->header;
+    const scpi_keyword_t * keyword;
+    int32_t terminal;
+    int32_t child;
+
+    if (depth + 1 == header->count) {
+        if (search->prefix == INDEX_UNSEEN) {
+            search->prefix = node;
+        } else if (search->prefix != node) {
+            search->prefix = INDEX_NONE;
+        }
+    }
+
+    if (depth == header->count) {
+        terminal = header->query ? nodes[node].query : nodes[node].cmd;
+        if ((terminal != INDEX_NONE) && ((search->best == INDEX_NONE) || (terminal < search->best))) {
+            search->best = terminal;
+            if (search->numbers) {
+                indexCapture(search);
+            }
+        }
+        return;
+    }
+
+    keyword = &header->keywords[depth];
+    for (child = nodes[node].child; child != INDEX_NONE; child = nodes[child].next) {
+        if (indexMatch(&nodes[child], header->buffer + keyword->offset, keyword->length)) {
+            search->path[depth] = child;
+            indexFind(search, child, depth + 1);
+        }
+    }
+}
+
+/**
+ * Find command for program header
+ *
+ * Result is the same as testing the header against every command in the
+ * list and taking the first match. Relative header of compound message
+ * is searched from the node remembered for the previous header, if any.
+ * Node to be used by the next header is stored in header->prefix.
+ *
+ * @param index
+ * @param header - program header split by foldHeader
+ * @param numbers - numeric suffixes of the found command or NULL
+ * @return position of command in command list or -1 if not found
+ */
+int32_t scpiIndex_Find(const scpi_command_index_t * index, scpi_header_t * header, scpi_command_numbers_t * numbers) {
+    index_search_t search;
+    int32_t node = INDEX_ROOT;
+    uint8_t depth = 0;
+    int32_t up;
+    uint8_t i;
+
+    search.nodes = index->nodes;
+    search.header = header;
+    search.best = INDEX_NONE;
+    search.prefix = INDEX_UNSEEN;
+    search.numbers = numbers;
+
+    if ((header->resume >= 0) && ((size_t) header->resume < index->count) && (header->resume_depth <= header->count)) {
+        node = header->resume;
+        depth = header->resume_depth;
+
+        /* path to the remembered node is unique, it is a tree */
+        for (up = node, i = depth; i > 0; i--) {
+            search.path[i - 1] = up;
+            up = index->nodes[up].parent;
+        }
+    }
+
+    indexFind(&search, node, depth);
+    header->prefix = (search.prefix == INDEX_UNSEEN) ? INDEX_NONE : search.prefix;
+
+    return search.best;
+}
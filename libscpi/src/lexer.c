@@ -34,47 +34,21 @@
  * 
  */
 
-#include <ctype.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "lexer_private.h"
+#include "lexer_table.h"
 #include "scpi/error.h"
 
 /**
- * Is white space
+ * Test if character belongs to any of given classes
  * @param c
+ * @param flags - LEX_* flags from lexer_table.h
  * @return 
  */
-static int isws(int c) {
-    if ((c == ' ') || (c == '\t')) {
-        return 1;
-    }
-    return 0;
-}
-
-/**
- * Is binary digit
- * @param c
- * @return 
- */
-static int isbdigit(int c) {
-    if ((c == '0') || (c == '1')) {
-        return 1;
-    }
-    return 0;
-}
-
-/**
- * Is hexadecimal digit
- * @param c
- * @return 
- */
-static int isqdigit(int c) {
-    if ((c == '0') || (c == '1') || (c == '2') || (c == '3') || (c == '4') || (c == '5') || (c == '6') || (c == '7')) {
-        return 1;
-    }
-    return 0;
+static int isclass(char c, uint8_t flags) {
+    return (lexCharFlags[(uint8_t) c] & flags) != 0;
 }
 
 /**
@@ -109,51 +83,6 @@ static int ischr(lex_state_t * state, char chr) {
     return (state->pos[0] == chr);
 }
 
-/**
- * Is plus or minus
- * @param c
- * @return 
- */
-static int isplusmn(int c) {
-    return c == '+' || c == '-';
-}
-
-/**
- * Is letter H
- * @param c
- * @return 
- */
-static int isH(int c) {
-    return c == 'h' || c == 'H';
-}
-
-/**
- * Is letter B
- * @param c
- * @return 
- */
-static int isB(int c) {
-    return c == 'b' || c == 'B';
-}
-
-/**
- * Is letter Q
- * @param c
- * @return 
- */
-static int isQ(int c) {
-    return c == 'q' || c == 'Q';
-}
-
-/**
- * Is letter E
- * @param c
- * @return 
- */
-static int isE(int c) {
-    return c == 'e' || c == 'E';
-}
-
 #define SKIP_NONE       0
 #define SKIP_OK         1
 #define SKIP_INCOMPLETE -1
@@ -169,7 +98,7 @@ static int isE(int c) {
  */
 static int skipWs(lex_state_t * state) {
     int someSpace = 0;
-    while (!iseos(state) && isws(state->pos[0])) {
+    while (!iseos(state) && isclass(state->pos[0], LEX_WS)) {
         state->pos++;
         someSpace++;
     }
@@ -189,35 +118,7 @@ static int skipWs(lex_state_t * state) {
  * @return 
  */
 static int skipDigit(lex_state_t * state) {
-    if (!iseos(state) && isdigit(state->pos[0])) {
-        state->pos++;
-        return SKIP_OK;
-    } else {
-        return SKIP_NONE;
-    }
-}
-
-/**
- * Skip multiple decimal digits
- * @param state
- * @return 
- */
-static int skipNumbers(lex_state_t * state) {
-    int someNumbers = 0;
-    while (!iseos(state) && isdigit(state->pos[0])) {
-        state->pos++;
-        someNumbers++;
-    }
-    return someNumbers;
-}
-
-/**
- * Skip plus or minus
- * @param state
- * @return 
- */
-static int skipPlusmn(lex_state_t * state) {
-    if (!iseos(state) && isplusmn(state->pos[0])) {
+    if (!iseos(state) && isclass(state->pos[0], LEX_DIGIT)) {
         state->pos++;
         return SKIP_OK;
     } else {
@@ -232,7 +133,7 @@ static int skipPlusmn(lex_state_t * state) {
  */
 static int skipAlpha(lex_state_t * state) {
     int someLetters = 0;
-    while (!iseos(state) && isalpha(state->pos[0])) {
+    while (!iseos(state) && isclass(state->pos[0], LEX_ALPHA)) {
         state->pos++;
         someLetters++;
     }
@@ -305,9 +206,9 @@ static int skipColon(lex_state_t * state) {
  */
 static int skipProgramMnemonic(lex_state_t * state) {
     const char * startPos = state->pos;
-    if (!iseos(state) && isalpha(state->pos[0])) {
+    if (!iseos(state) && isclass(state->pos[0], LEX_ALPHA)) {
         state->pos++;
-        while (!iseos(state) && (isalnum(state->pos[0]) || ischr(state, '_'))) {
+        while (!iseos(state) && isclass(state->pos[0], LEX_ALPHA | LEX_DIGIT | LEX_UNDERSCORE)) {
             state->pos++;
         }
     }
@@ -440,65 +341,113 @@ int scpiLex_ProgramHeader(lex_state_t * state, scpi_token_t * token) {
     return token->len;
 }
 
-/* 7.7.1 <CHARACTER PROGRAM DATA> */
+/* 7.7 <PROGRAM DATA> */
 
 /**
- * Detect token "Character program data"
+ * Run the program data DFA from lexer_table.h
+ *
+ * Every type of program data is recognized in one pass, the token is the
+ * longest accepted prefix of the input. Content of strings is skipped up
+ * to the next structural character.
  * @param state
  * @param token
- * @return 
+ * @return length of the token
  */
-int scpiLex_CharacterProgramData(lex_state_t * state, scpi_token_t * token) {
+static int lexProgramData(lex_state_t * state, scpi_token_t * token) {
+    const char * accept = NULL;
+    uint8_t dfa = LEX_DFA_START;
+
     token->ptr = state->pos;
+    token->type = SCPI_TOKEN_UNKNOWN;
 
-    if (!iseos(state) && isalpha(state->pos[0])) {
+    while (!iseos(state)) {
+        if (lexDfaSkip[dfa]) {
+            state->pos += scanStructuralNext(state->pos, state->buffer + state->len - state->pos);
+            if (iseos(state)) {
+                break;
+            }
+        }
+        dfa = lexDfaNext[dfa][lexDfaClass[(uint8_t) state->pos[0]]];
+        if (dfa == LEX_DFA_DEAD) {
+            break;
+        }
         state->pos++;
-        while (!iseos(state) && (isalnum(state->pos[0]) || ischr(state, '_'))) {
-            state->pos++;
+        if (lexDfaAccept[dfa] != SCPI_TOKEN_UNKNOWN) {
+            token->type = lexDfaAccept[dfa];
+            accept = state->pos;
         }
     }
 
-    token->len = state->pos - token->ptr;
-    if (token->len > 0) {
-        token->type = SCPI_TOKEN_PROGRAM_MNEMONIC;
+    if (accept) {
+        state->pos = accept;
+        token->len = accept - token->ptr;
     } else {
-        token->type = SCPI_TOKEN_UNKNOWN;
+        state->pos = token->ptr;
+        token->len = 0;
     }
 
     return token->len;
 }
 
-/* 7.7.2 <DECIMAL NUMERIC PROGRAM DATA> */
-static int skipMantisa(lex_state_t * state) {
-    int someNumbers = 0;
-
-    skipPlusmn(state);
-
-    someNumbers += skipNumbers(state);
+/**
+ * Detect token of one type using the program data DFA
+ * @param state
+ * @param token
+ * @param type - expected type
+ * @param other - alternative expected type
+ * @return length of the token
+ */
+static int lexProgramDataType(lex_state_t * state, scpi_token_t * token, scpi_token_type_t type, scpi_token_type_t other) {
+    lexProgramData(state, token);
 
-    if (skipChr(state, '.')) {
-        someNumbers += skipNumbers(state);
+    if ((token->type != type) && (token->type != other)) {
+        token->type = SCPI_TOKEN_UNKNOWN;
+        state->pos = token->ptr;
+        token->len = 0;
     }
 
-    return someNumbers;
+    return token->len;
 }
 
-static int skipExponent(lex_state_t * state) {
-    int someNumbers = 0;
-
-    if (!iseos(state) && isE(state->pos[0])) {
-        state->pos++;
-
-        skipWs(state);
-
-        skipPlusmn(state);
+/**
+ * Detect any program data except suffix
+ *
+ * Decimal numeric program data is detected without the suffix.
+ * @param state
+ * @param token
+ * @return length of the token including nondecimal and block prefix
+ */
+int scpiLex_ProgramData(lex_state_t * state, scpi_token_t * token) {
+    lexProgramData(state, token);
 
-        someNumbers = skipNumbers(state);
+    switch (token->type) {
+        case SCPI_TOKEN_HEXNUM:
+        case SCPI_TOKEN_OCTNUM:
+        case SCPI_TOKEN_BINNUM:
+            token->ptr += 2; // ignore number prefix
+            token->len -= 2;
+            return token->len + 2;
+        case SCPI_TOKEN_UNKNOWN:
+            return scpiLex_ArbitraryBlockProgramData(state, token);
+        default:
+            return token->len;
     }
+}
+
+/* 7.7.1 <CHARACTER PROGRAM DATA> */
 
-    return someNumbers;
+/**
+ * Detect token "Character program data"
+ * @param state
+ * @param token
+ * @return 
+ */
+int scpiLex_CharacterProgramData(lex_state_t * state, scpi_token_t * token) {
+    return lexProgramDataType(state, token, SCPI_TOKEN_PROGRAM_MNEMONIC, SCPI_TOKEN_PROGRAM_MNEMONIC);
 }
 
+/* 7.7.2 <DECIMAL NUMERIC PROGRAM DATA> */
+
 /**
  * Detect token Decimal number
  * @param state
@@ -506,27 +455,7 @@ static int skipExponent(lex_state_t * state) {
  * @return 
  */
 int scpiLex_DecimalNumericProgramData(lex_state_t * state, scpi_token_t * token) {
-    char * rollback;
-    token->ptr = state->pos;
-
-    if (skipMantisa(state)) {
-        rollback = state->pos;
-        skipWs(state);
-        if (!skipExponent(state)) {
-            state->pos = rollback;
-        }
-    } else {
-        state->pos = token->ptr;
-    }
-
-    token->len = state->pos - token->ptr;
-    if (token->len > 0) {
-        token->type = SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA;
-    } else {
-        token->type = SCPI_TOKEN_UNKNOWN;
-    }
-
-    return token->len;
+    return lexProgramDataType(state, token, SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA, SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA);
 }
 
 /* 7.7.3 <SUFFIX PROGRAM DATA> */
@@ -560,32 +489,6 @@ int scpiLex_SuffixProgramData(lex_state_t * state, scpi_token_t * token) {
 }
 
 /* 7.7.4 <NONDECIMAL NUMERIC PROGRAM DATA> */
-static int skipHexNum(lex_state_t * state) {
-    int someNumbers = 0;
-    while (!iseos(state) && isxdigit(state->pos[0])) {
-        state->pos++;
-        someNumbers++;
-    }
-    return someNumbers;
-}
-
-static int skipOctNum(lex_state_t * state) {
-    int someNumbers = 0;
-    while (!iseos(state) && isqdigit(state->pos[0])) {
-        state->pos++;
-        someNumbers++;
-    }
-    return someNumbers;
-}
-
-static int skipBinNum(lex_state_t * state) {
-    int someNumbers = 0;
-    while (!iseos(state) && isbdigit(state->pos[0])) {
-        state->pos++;
-        someNumbers++;
-    }
-    return someNumbers;
-}
 
 /**
  * Detect token nondecimal number
@@ -594,29 +497,11 @@ static int skipBinNum(lex_state_t * state) {
  * @return 
  */
 int scpiLex_NondecimalNumericData(lex_state_t * state, scpi_token_t * token) {
-    int someNumbers = 0;
-    token->ptr = state->pos;
-    if (skipChr(state, '#')) {
-        if (!iseos(state)) {
-            if (isH(state->pos[0])) {
-                state->pos++;
-                someNumbers = skipHexNum(state);
-                token->type = SCPI_TOKEN_HEXNUM;
-            } else if (isQ(state->pos[0])) {
-                state->pos++;
-                someNumbers = skipOctNum(state);
-                token->type = SCPI_TOKEN_OCTNUM;
-            } else if (isB(state->pos[0])) {
-                state->pos++;
-                someNumbers = skipBinNum(state);
-                token->type = SCPI_TOKEN_BINNUM;
-            }
-        }
-    }
+    lexProgramData(state, token);
 
-    if (someNumbers) {
+    if ((token->type == SCPI_TOKEN_HEXNUM) || (token->type == SCPI_TOKEN_OCTNUM) || (token->type == SCPI_TOKEN_BINNUM)) {
         token->ptr += 2; // ignore number prefix
-        token->len = state->pos - token->ptr;
+        token->len -= 2;
     } else {
         token->type = SCPI_TOKEN_UNKNOWN;
         state->pos = token->ptr;
@@ -626,33 +511,6 @@ int scpiLex_NondecimalNumericData(lex_state_t * state, scpi_token_t * token) {
 }
 
 /* 7.7.5 <STRING PROGRAM DATA> */
-static int isascii7bit(int c) {
-    return (c >= 0) && (c <= 0x7f);
-}
-
-static void skipQuoteProgramData(lex_state_t * state, char quote) {
-    while (!iseos(state)) {
-        if (isascii7bit(state->pos[0]) && !ischr(state, quote)) {
-            state->pos++;
-        } else if (ischr(state, quote)) {
-            state->pos++;
-            if (!iseos(state) && ischr(state, quote)) {
-                state->pos++;
-            } else {
-                state->pos--;
-                break;
-            }
-        }
-    }
-}
-
-static void skipDoubleQuoteProgramData(lex_state_t * state) {
-    skipQuoteProgramData(state, '"');
-}
-
-static void skipSingleQuoteProgramData(lex_state_t * state) {
-    skipQuoteProgramData(state, '\'');
-}
 
 /**
  * Detect token String data
@@ -661,98 +519,99 @@ static void skipSingleQuoteProgramData(lex_state_t * state) {
  * @return 
  */
 int scpiLex_StringProgramData(lex_state_t * state, scpi_token_t * token) {
-    token->ptr = state->pos;
+    return lexProgramDataType(state, token, SCPI_TOKEN_DOUBLE_QUOTE_PROGRAM_DATA, SCPI_TOKEN_SINGLE_QUOTE_PROGRAM_DATA);
+}
 
-    if (!iseos(state)) {
-        if (ischr(state, '"')) {
-            state->pos++;
-            token->type = SCPI_TOKEN_DOUBLE_QUOTE_PROGRAM_DATA;
-            skipDoubleQuoteProgramData(state);
-            if (!iseos(state) && ischr(state, '"')) {
-                state->pos++;
-                token->len = state->pos - token->ptr;
-            } else {
-                state->pos = token->ptr;
-            }
-        } else if (ischr(state, '\'')) {
-            state->pos++;
-            token->type = SCPI_TOKEN_SINGLE_QUOTE_PROGRAM_DATA;
-            skipSingleQuoteProgramData(state);
-            if (!iseos(state) && ischr(state, '\'')) {
-                state->pos++;
-                token->len = state->pos - token->ptr;
-            } else {
-                state->pos = token->ptr;
-            }
-        }
+
+/* 7.7.6 <ARBITRARY BLOCK PROGRAM DATA> */
+/**
+ * Detect header of arbitrary block program data, "#" followed by number of
+ * digits and length of the block or "#0" for block of indefinite length
+ * @param state
+ * @param length - length of the block or SCPI_BLOCK_LENGTH_INDEFINITE
+ * @return 1 if the header is complete, state->pos is moved after it,
+ * 0 if the header is incomplete and -1 if it is not valid
+ */
+int scpiLex_ArbitraryBlockHeader(lex_state_t * state, size_t * length) {
+    const char * ptr = state->pos;
+    int i;
+
+    *length = 0;
+
+    if (!skipChr(state, '#')) {
+        return -1;
     }
 
-    token->len = state->pos - token->ptr;
+    if (iseos(state)) {
+        state->pos = ptr;
+        return 0;
+    }
 
-    if ((token->len > 0)) {
-        //token->ptr++;
-        //token->len -= 2;
-    } else {
-        token->type = SCPI_TOKEN_UNKNOWN;
-        state->pos = token->ptr;
-        token->len = 0;
+    if (state->pos[0] == '0') {
+        state->pos++;
+        *length = SCPI_BLOCK_LENGTH_INDEFINITE;
+        return 1;
     }
 
-    return token->len > 0 ? token->len : 0;
-}
+    if (!isclass(state->pos[0], LEX_NONZERO_DIGIT)) {
+        state->pos = ptr;
+        return -1;
+    }
 
-/* 7.7.6 <ARBITRARY BLOCK PROGRAM DATA> */
-static int isNonzeroDigit(int c) {
-    return isdigit(c) && (c != '0');
+    /* Get number of digits */
+    i = state->pos[0] - '0';
+    state->pos++;
+
+    for (; i > 0; i--) {
+        if (iseos(state)) {
+            state->pos = ptr;
+            return 0;
+        }
+        if (!isclass(state->pos[0], LEX_DIGIT)) {
+            state->pos = ptr;
+            return -1;
+        }
+        *length *= 10;
+        *length += (size_t) (state->pos[0] - '0');
+        state->pos++;
+    }
+
+    return 1;
 }
 
 /**
  * Detect token Block Data
+ *
+ * Block of indefinite length ends by new line, which terminates the
+ * message, or by end of data.
+ *
  * @param state
  * @param token
  * @return 
  */
 int scpiLex_ArbitraryBlockProgramData(lex_state_t * state, scpi_token_t * token) {
-    int i;
-    int arbitraryBlockLength = 0;
+    size_t arbitraryBlockLength;
     const char * ptr = state->pos;
-    int validData = -1;
+    const char * nl;
+    int validData;
     token->ptr = state->pos;
 
-    if (skipChr(state, '#')) {
-        if (!iseos(state) && isNonzeroDigit(state->pos[0])) {
-            /* Get number of digits */
-            i = state->pos[0] - '0';
-            state->pos++;
-
-            for (; i > 0; i--) {
-                if (!iseos(state) && isdigit(state->pos[0])) {
-                    arbitraryBlockLength *= 10;
-                    arbitraryBlockLength += (state->pos[0] - '0');
-                    state->pos++;
-                } else {
-                    break;
-                }
-            }
-
-            if (i == 0) {
-                state->pos += arbitraryBlockLength;
-                if ((state->buffer + state->len) >= (state->pos)) {
-                    token->ptr = state->pos - arbitraryBlockLength;
-                    token->len = arbitraryBlockLength;
-                    validData = 1;
-                }
-            } else if (iseos(state)) {
-                validData = 0;
-            }
-        } else if (iseos(state)) {
-            validData = 0;
-        }
+    validData = scpiLex_ArbitraryBlockHeader(state, &arbitraryBlockLength);
+    if ((validData == 1) && (arbitraryBlockLength == SCPI_BLOCK_LENGTH_INDEFINITE)) {
+        nl = (const char *) memchr(state->pos, '\n', state->buffer + state->len - state->pos);
+        arbitraryBlockLength = (nl ? nl : state->buffer + state->len) - state->pos;
+    }
+    if ((validData == 1) && ((size_t) (state->buffer + state->len - state->pos) < arbitraryBlockLength)) {
+        /* header is complete, data are not */
+        validData = 0;
     }
 
     if (validData == 1) {
         // valid
         token->type = SCPI_TOKEN_ARBITRARY_BLOCK_PROGRAM_DATA;
+        token->ptr = state->pos;
+        token->len = arbitraryBlockLength;
+        state->pos += arbitraryBlockLength;
     } else if (validData == 0) {
         // incomplete
         token->type = SCPI_TOKEN_UNKNOWN;
@@ -769,26 +628,6 @@ int scpiLex_ArbitraryBlockProgramData(lex_state_t * state, scpi_token_t * token)
 }
 
 /* 7.7.7 <EXPRESSION PROGRAM DATA> */
-static int isProgramExpression(int c) {
-    if ((c >= 0x20) && (c <= 0x7e)) {
-        if ((c != '"')
-                && (c != '#')
-                && (c != '\'')
-                && (c != '(')
-                && (c != ')')
-                && (c != ';')) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-
-static void skipProgramExpression(lex_state_t * state) {
-    while (!iseos(state) && isProgramExpression(state->pos[0])) {
-        state->pos++;
-    }
-}
 
 // TODO: 7.7.7.2-2 recursive - any program data
 
@@ -799,29 +638,7 @@ static void skipProgramExpression(lex_state_t * state) {
  * @return 
  */
 int scpiLex_ProgramExpression(lex_state_t * state, scpi_token_t * token) {
-    token->ptr = state->pos;
-
-    if (!iseos(state) && ischr(state, '(')) {
-        state->pos++;
-        skipProgramExpression(state);
-
-        if (!iseos(state) && ischr(state, ')')) {
-            state->pos++;
-            token->len = state->pos - token->ptr;
-        } else {
-            token->len = 0;
-        }
-    }
-
-    if ((token->len > 0)) {
-        token->type = SCPI_TOKEN_PROGRAM_EXPRESSION;
-    } else {
-        token->type = SCPI_TOKEN_UNKNOWN;
-        state->pos = token->ptr;
-        token->len = 0;
-    }
-
-    return token->len;
+    return lexProgramDataType(state, token, SCPI_TOKEN_PROGRAM_EXPRESSION, SCPI_TOKEN_PROGRAM_EXPRESSION);
 }
 
 /**
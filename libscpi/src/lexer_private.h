@@ -47,11 +47,13 @@ extern "C" {
     int scpiLex_IsEos(lex_state_t * state) LOCAL;
     int scpiLex_WhiteSpace(lex_state_t * state, scpi_token_t * token) LOCAL;
     int scpiLex_ProgramHeader(lex_state_t * state, scpi_token_t * token) LOCAL;
+    int scpiLex_ProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
     int scpiLex_CharacterProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
     int scpiLex_DecimalNumericProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
     int scpiLex_SuffixProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
     int scpiLex_NondecimalNumericData(lex_state_t * state, scpi_token_t * token) LOCAL;
     int scpiLex_StringProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
+    int scpiLex_ArbitraryBlockHeader(lex_state_t * state, size_t * length) LOCAL;
     int scpiLex_ArbitraryBlockProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
     int scpiLex_ProgramExpression(lex_state_t * state, scpi_token_t * token) LOCAL;
     int scpiLex_Comma(lex_state_t * state, scpi_token_t * token) LOCAL;
@@ -34,6 +34,7 @@
  *
  */
 
+#include <limits.h>
 #include <string.h>
 #include <sys/socket.h>
 #include <elf.h>
@@ -43,6 +44,8 @@
 #include "scpi/parser.h"
 #include "parser_private.h"
 #include "lexer_private.h"
+#include "index_private.h"
+#include "cache_private.h"
 #include "scpi/error.h"
 #include "scpi/constants.h"
 #include "scpi/utils.h"
@@ -152,6 +155,392 @@ static size_t writeSemicolon(scpi_t * context) {
     }
 }
 
+#if USE_ARBITRARY_BLOCK_STREAM
+/**
+ * Find arbitrary block in program data
+ *
+ * Search starts at state->pos, which is either the beginning of program
+ * data or the end of a parameter followed by comma, as returned in next.
+ *
+ * @param state - program data
+ * @param prefix - length of program data before the block
+ * @param data - offset of the block data
+ * @param len - length of the block
+ * @param next - end of the last parameter followed by comma, parameters
+ * before it don't change with more data, or NULL
+ * @return 1 if the block header was found, 0 if program data end by
+ * incomplete block header, -1 if there is no block
+ */
+static int findBlock(const lex_state_t * state, size_t * prefix, size_t * data, size_t * len, size_t * next) {
+    lex_state_t lex = *state;
+    scpi_token_t tmp;
+    int result;
+
+    *prefix = lex.pos - lex.buffer;
+    if (next) {
+        *next = *prefix;
+    }
+
+    if ((*prefix > 0) && (scpiLex_Comma(&lex, &tmp) == 0)) {
+        return -1;
+    }
+
+    while (1) {
+        scpiLex_WhiteSpace(&lex, &tmp);
+
+        result = scpiLex_ArbitraryBlockHeader(&lex, len);
+        if (result >= 0) {
+            *data = lex.pos - lex.buffer;
+            return result;
+        }
+
+        scpiParser_parseProgramData(&lex, &tmp);
+        if (tmp.type == SCPI_TOKEN_UNKNOWN) {
+            return -1;
+        }
+        *prefix = lex.pos - lex.buffer;
+
+        if (scpiLex_Comma(&lex, &tmp) == 0) {
+            return -1;
+        }
+
+        if (next) {
+            *next = *prefix;
+        }
+    }
+}
+
+/**
+ * Call stream callback of current command
+ * @param context
+ * @param event
+ * @param data
+ * @param len
+ * @return FALSE if the callback failed now or before
+ */
+static scpi_bool_t streamEvent(scpi_t * context, scpi_stream_event_t event, const char * data, size_t len) {
+    scpi_input_state_t * input = &context->input_state;
+
+    if (input->stream_error) {
+        return FALSE;
+    }
+
+    if (context->param_list.cmd->stream(context, event, data, len) != SCPI_RES_OK) {
+        if (!context->cmd_error) {
+            SCPI_ErrorPush(context, SCPI_ERROR_EXECUTION_ERROR);
+        }
+        input->stream_error = TRUE;
+    } else if (context->cmd_error) {
+        input->stream_error = TRUE;
+    }
+
+    return !input->stream_error;
+}
+
+/**
+ * Start passing arbitrary block to stream callback of current command,
+ * program data before the block are in context->param_list.lex_state
+ * @param context
+ * @param len - length of the block
+ * @return FALSE if the callback failed
+ */
+static scpi_bool_t streamBegin(scpi_t * context, size_t len) {
+    scpi_input_state_t * input = &context->input_state;
+    lex_state_t * state = &context->param_list.lex_state;
+
+    /* conditionaly write ; */
+    writeSemicolon(context);
+
+    context->cmd_error = FALSE;
+    context->output_count = 0;
+    context->output_binary_count = 0;
+    context->input_count = 0;
+    context->param_list.expr_list.ptr = NULL;
+    input->stream_error = FALSE;
+    input->destination = NULL;
+    input->destination_size = 0;
+
+    streamEvent(context, SCPI_STREAM_BEGIN, NULL, len);
+
+    /* set error if command callback did not read all parameters */
+    if (state->pos < (state->buffer + state->len) && !context->cmd_error) {
+        SCPI_ErrorPush(context, SCPI_ERROR_PARAMETER_NOT_ALLOWED);
+        input->stream_error = TRUE;
+    }
+
+    return !input->stream_error;
+}
+
+/**
+ * Pass part of arbitrary block to stream callback of current command
+ * @param context
+ * @param data
+ * @param len
+ * @return FALSE if the callback failed
+ */
+static scpi_bool_t streamData(scpi_t * context, const char * data, size_t len) {
+    scpi_input_state_t * input = &context->input_state;
+    size_t n;
+
+    if (input->stream_error) {
+        return FALSE;
+    }
+
+    if ((input->destination_size > 0) && (len > 0)) {
+        n = (len < input->destination_size) ? len : input->destination_size;
+        memcpy(input->destination, data, n);
+        if (!streamEvent(context, SCPI_STREAM_DATA, input->destination, n)) {
+            return FALSE;
+        }
+        input->destination += n;
+        input->destination_size -= n;
+        data += n;
+        len -= n;
+    }
+
+    if (len > 0) {
+        return streamEvent(context, SCPI_STREAM_DATA, data, len);
+    }
+
+    return TRUE;
+}
+
+/**
+ * Pass arbitrary block of complete program message unit to stream callback
+ * @param context
+ * @param prefix - length of program data before the block
+ * @param data - offset of the block data
+ * @param len - length of the block
+ * @return FALSE if the callback failed
+ */
+static scpi_bool_t streamCommand(scpi_t * context, size_t prefix, size_t data, size_t len) {
+    lex_state_t * state = &context->param_list.lex_state;
+    lex_state_t rest = *state;
+    scpi_token_t tmp;
+    scpi_bool_t result;
+
+    state->len = prefix;
+
+    result = streamBegin(context, len);
+    result = result && streamData(context, state->buffer + data, len);
+    result = result && streamEvent(context, SCPI_STREAM_END, NULL, 0);
+
+    /* nothing is allowed after the block */
+    rest.pos = rest.buffer + data + len;
+    scpiLex_WhiteSpace(&rest, &tmp);
+    if (!scpiLex_IsEos(&rest) && !context->cmd_error) {
+        SCPI_ErrorPush(context, SCPI_ERROR_PARAMETER_NOT_ALLOWED);
+        result = FALSE;
+    }
+
+    return result;
+}
+
+/**
+ * Set destination of arbitrary block passed to stream callback
+ *
+ * Can be called by the stream callback on SCPI_STREAM_BEGIN. Following
+ * data of the block are copied to the destination before they are passed
+ * to the callback by SCPI_STREAM_DATA. Data which don't fit into the
+ * destination are passed to the callback directly.
+ *
+ * @param context
+ * @param destination - e.g. DMA buffer
+ * @param size - size of destination
+ */
+void SCPI_StreamDestination(scpi_t * context, char * destination, size_t size) {
+    context->input_state.destination = destination;
+    context->input_state.destination_size = destination ? size : 0;
+}
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+
+#if USE_NUMERIC_LIST_STREAM
+/**
+ * Call list callback of current command
+ * @param context
+ * @param event
+ * @param values
+ * @param count
+ * @return FALSE if the callback failed now or before
+ */
+static scpi_bool_t listEvent(scpi_t * context, scpi_stream_event_t event, const double * values, size_t count) {
+    scpi_input_state_t * input = &context->input_state;
+
+    if (input->list_error) {
+        return FALSE;
+    }
+
+    if (context->param_list.cmd->list(context, event, values, count) != SCPI_RES_OK) {
+        if (!context->cmd_error) {
+            SCPI_ErrorPush(context, SCPI_ERROR_EXECUTION_ERROR);
+        }
+        input->list_error = TRUE;
+    } else if (context->cmd_error) {
+        input->list_error = TRUE;
+    }
+
+    return !input->list_error;
+}
+
+/**
+ * Start passing numeric list to list callback of current command
+ * @param context
+ * @return FALSE if the callback failed
+ */
+static scpi_bool_t listBegin(scpi_t * context) {
+    scpi_input_state_t * input = &context->input_state;
+
+    /* conditionaly write ; */
+    writeSemicolon(context);
+
+    context->cmd_error = FALSE;
+    context->output_count = 0;
+    context->output_binary_count = 0;
+    context->input_count = 0;
+    context->param_list.expr_list.ptr = NULL;
+    input->list_error = FALSE;
+    input->list_values = NULL;
+    input->list_size = 0;
+    input->list_count = 0;
+
+    return listEvent(context, SCPI_STREAM_BEGIN, NULL, 0);
+}
+
+/**
+ * Finish numeric list, pass rest of the batch to list callback
+ * @param context
+ * @param abort - list is not complete
+ * @return FALSE if the callback failed
+ */
+static scpi_bool_t listEnd(scpi_t * context, scpi_bool_t abort) {
+    scpi_input_state_t * input = &context->input_state;
+    scpi_bool_t result = TRUE;
+
+    if (abort) {
+        if (!input->list_error) {
+            context->param_list.cmd->list(context, SCPI_STREAM_ABORT, NULL, 0);
+        }
+        input->list_error = TRUE;
+        return FALSE;
+    }
+
+    if (input->list_count > 0) {
+        result = listEvent(context, SCPI_STREAM_DATA, input->list_values, input->list_count);
+        input->list_count = 0;
+    }
+
+    return result && listEvent(context, SCPI_STREAM_END, NULL, 0);
+}
+
+/**
+ * Decode numbers of comma separated list and pass them to list callback
+ *
+ * Numbers are collected in the batch set by SCPI_ListDestination and the
+ * batch is passed when it is full. Without the batch, each number is
+ * passed alone.
+ *
+ * @param context
+ * @param data - numeric list or its part
+ * @param len - length of data
+ * @param complete - data end the list, otherwise the last number can
+ *                   continue by data not received yet
+ * @return number of bytes decoded, the rest has to be passed again
+ */
+static size_t listData(scpi_t * context, const char * data, size_t len, scpi_bool_t complete) {
+    scpi_input_state_t * input = &context->input_state;
+    lex_state_t lex;
+    scpi_token_t token;
+    const char * comma;
+    size_t pos = 0;
+    size_t end;
+    double value;
+
+    while (!input->list_error) {
+        comma = (const char *) memchr(data + pos, ',', len - pos);
+        if (comma) {
+            end = comma - data;
+        } else if (complete) {
+            end = len;
+        } else {
+            break;
+        }
+
+        lex.buffer = lex.pos = data + pos;
+        lex.len = (int) (end - pos);
+        scpiParser_parseProgramData(&lex, &token);
+
+        if ((token.type == SCPI_TOKEN_UNKNOWN) || (lex.pos < lex.buffer + lex.len)) {
+            /* empty list is allowed, empty item is not */
+            if (comma || (pos > 0) || (lex.pos < lex.buffer + lex.len)) {
+                SCPI_ErrorPush(context, SCPI_ERROR_INVALID_CHARACTER);
+                listEnd(context, TRUE);
+            }
+        } else if (SCPI_ParamIsNumber(&token, FALSE)) {
+            SCPI_ParamToDouble(context, &token, &value);
+            if (input->list_size > 0) {
+                input->list_values[input->list_count++] = value;
+                if (input->list_count == input->list_size) {
+                    listEvent(context, SCPI_STREAM_DATA, input->list_values, input->list_count);
+                    input->list_count = 0;
+                }
+            } else {
+                listEvent(context, SCPI_STREAM_DATA, &value, 1);
+            }
+        } else if (SCPI_ParamIsNumber(&token, TRUE)) {
+            SCPI_ErrorPush(context, SCPI_ERROR_SUFFIX_NOT_ALLOWED);
+            listEnd(context, TRUE);
+        } else {
+            SCPI_ErrorPush(context, SCPI_ERROR_DATA_TYPE_ERROR);
+            listEnd(context, TRUE);
+        }
+
+        if (!comma) {
+            pos = len;
+            break;
+        }
+        pos = end + 1;
+    }
+
+    /* rest of failed list is dropped */
+    return input->list_error ? len : pos;
+}
+
+/**
+ * Pass numeric list of complete program message unit to list callback
+ * @param context
+ * @return FALSE if the callback failed
+ */
+static scpi_bool_t listCommand(scpi_t * context) {
+    lex_state_t * state = &context->param_list.lex_state;
+    size_t len = state->buffer + state->len - state->pos;
+
+    if (listBegin(context)) {
+        listData(context, state->pos, len, TRUE);
+    }
+    state->pos += len;
+
+    return listEnd(context, context->input_state.list_error);
+}
+
+/**
+ * Set batch for numbers passed to list callback
+ *
+ * Can be called by the list callback on SCPI_STREAM_BEGIN. Decoded
+ * numbers are collected in the batch and passed to the callback by
+ * SCPI_STREAM_DATA when the batch is full or the list ends. Without the
+ * batch, numbers are passed one by one.
+ *
+ * @param context
+ * @param values - batch of numbers
+ * @param size - number of values in the batch
+ */
+void SCPI_ListDestination(scpi_t * context, double * values, size_t size) {
+    context->input_state.list_values = values;
+    context->input_state.list_size = values ? size : 0;
+    context->input_state.list_count = 0;
+}
+#endif /* USE_NUMERIC_LIST_STREAM */
+
 /**
  * Process command
  * @param context
@@ -160,6 +549,29 @@ static scpi_bool_t processCommand(scpi_t * context) {
     const scpi_command_t * cmd = context->param_list.cmd;
     lex_state_t * state = &context->param_list.lex_state;
     scpi_bool_t result = TRUE;
+#if USE_ARBITRARY_BLOCK_STREAM
+    size_t prefix;
+    size_t data;
+    size_t len;
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+
+#if USE_NUMERIC_LIST_STREAM
+    if (cmd->list != NULL) {
+        return listCommand(context);
+    }
+#endif /* USE_NUMERIC_LIST_STREAM */
+
+#if USE_ARBITRARY_BLOCK_STREAM
+    if ((cmd->stream != NULL) && (findBlock(state, &prefix, &data, &len, NULL) == 1)) {
+        if (len == SCPI_BLOCK_LENGTH_INDEFINITE) {
+            /* block continues to the end of program data */
+            len = (size_t) state->len - data;
+        }
+        if (data + len <= (size_t) state->len) {
+            return streamCommand(context, prefix, data, len);
+        }
+    }
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
 
     /* conditionaly write ; */
     writeSemicolon(context);
@@ -168,6 +580,7 @@ static scpi_bool_t processCommand(scpi_t * context) {
     context->output_count = 0;
     context->output_binary_count = 0;
     context->input_count = 0;
+    context->param_list.expr_list.ptr = NULL;
 
     /* if callback exists - call command callback */
     if (cmd->callback != NULL) {
@@ -193,109 +606,937 @@ static scpi_bool_t processCommand(scpi_t * context) {
 }
 
 /**
- * Cycle all patterns and search matching pattern. Execute command callback.
+ * Cycle all patterns of one command list and search matching pattern
+ * @param cmdlist
+ * @param cmdindex - index of the command list or NULL
+ * @param header - program header
+ * @param numbers - numeric suffixes of the header
+ * @return command or NULL if no pattern matches
+ */
+static const scpi_command_t * searchCommandList(const scpi_command_t * cmdlist, const scpi_command_index_t * cmdindex, scpi_header_t * header, scpi_command_numbers_t * numbers) {
+    int32_t i;
+    const scpi_command_t * cmd;
+
+    numbers->given = 0;
+
+    if (cmdindex && (cmdindex->cmdlist == cmdlist)) {
+        i = scpiIndex_Find(cmdindex, header, numbers);
+        return (i < 0) ? NULL : &cmdlist[i];
+    }
+
+    header->prefix = -1;
+    for (i = 0; cmdlist[i].pattern != NULL; i++) {
+        cmd = &cmdlist[i];
+        if (matchHeaderPattern(cmd->pattern, header, numbers->values, SCPI_COMMAND_NUMBERS, 0, &numbers->given)) {
+            return cmd;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Search context command list, then all attached command tables
+ * @param context
+ * @param header - program header
+ * @param numbers - numeric suffixes of the header
+ * @param table - table of the found command, NULL for context->cmdlist
+ * @return command or NULL if no pattern matches
+ */
+static const scpi_command_t * searchCommandHeader(scpi_t * context, scpi_header_t * header, scpi_command_numbers_t * numbers, const scpi_command_table_t ** table) {
+    const scpi_command_t * cmd;
+    const scpi_command_table_t * t;
+    scpi_header_t rest;
+
+    *table = NULL;
+    cmd = searchCommandList(context->cmdlist, context->cmdindex, header, numbers);
+
+    for (t = context->tables; (cmd == NULL) && (t != NULL); t = t->next) {
+        if (matchHeaderPrefix(&t->prefix, header, &rest)) {
+            cmd = searchCommandList(t->cmdlist, t->cmdindex, &rest, numbers);
+            if (cmd) {
+                /* compound header can't continue in other index */
+                header->prefix = -1;
+                *table = t;
+            }
+        }
+    }
+
+    return cmd;
+}
+
+/**
+ * Find command for program header, consult dispatch cache first
+ * @param context
+ * @param header - program header
+ * @result TRUE if context->paramlist is filled with correct values
+ */
+static scpi_bool_t findCommandHeader(scpi_t * context, scpi_header_t * header) {
+    const scpi_command_t * cmd;
+    const scpi_command_table_t * table;
+    scpi_command_numbers_t * numbers = &context->param_list.numbers;
+#if USE_DISPATCH_CACHE
+    uint32_t hash;
+
+    cmd = scpiCache_Find(context, header, numbers, &table, &hash);
+    if (cmd == NULL) {
+        cmd = searchCommandHeader(context, header, numbers, &table);
+        if (cmd != NULL) {
+            scpiCache_Store(context, header, numbers, hash, cmd, table);
+        }
+    }
+#else /* USE_DISPATCH_CACHE */
+    cmd = searchCommandHeader(context, header, numbers, &table);
+#endif /* USE_DISPATCH_CACHE */
+
+    if (cmd == NULL) {
+        return FALSE;
+    }
+
+    context->param_list.cmd = cmd;
+    context->param_list.table = table;
+    if (table) {
+        /* commands of the table see the header without prefix */
+        matchHeaderPrefix(&table->prefix, header, &context->param_list.header);
+    } else {
+        context->param_list.header = *header;
+    }
+    return TRUE;
+}
+
+/**
+ * Execute command found for current program message unit
+ * @param context
+ * @return result of processCommand
+ */
+static scpi_bool_t executeCommand(scpi_t * context) {
+    scpi_parser_state_t * state = &context->parser_state;
+
+    context->param_list.lex_state.buffer = state->programData.ptr;
+    context->param_list.lex_state.pos = context->param_list.lex_state.buffer;
+    context->param_list.lex_state.len = state->programData.len;
+    context->param_list.cmd_raw.data = state->programHeader.ptr;
+    context->param_list.cmd_raw.position = 0;
+    context->param_list.cmd_raw.length = state->programHeader.len;
+
+    return processCommand(context);
+}
+
+#if USE_MESSAGE_CACHE
+/**
+ * Execute message with the layout remembered in dispatch cache
+ * @param context
+ * @param data - message equal to the remembered one
+ * @return FALSE if there was some error during evaluation of commands
+ */
+static scpi_bool_t replayMessage(scpi_t * context, const char * data) {
+    const scpi_dispatch_cache_t * cache = &context->dispatch_cache;
+    scpi_parser_state_t * state = &context->parser_state;
+    const scpi_message_unit_t * unit;
+    scpi_header_t header;
+    scpi_header_t prev;
+    scpi_bool_t result = TRUE;
+    size_t i;
+
+    prev.count = 0;
+    prev.prefix = -1;
+
+    for (i = 0; i < cache->unit_count; i++) {
+        unit = &cache->units[i];
+
+        state->programHeader.type = unit->header_type;
+        state->programHeader.ptr = data + unit->header;
+        state->programHeader.len = unit->header_length;
+        state->programData.type = unit->data_type;
+        state->programData.ptr = data + unit->data;
+        state->programData.len = unit->data_length;
+        state->numberOfParameters = unit->numberOfParameters;
+        state->termination = unit->termination;
+#if USE_PARAMETER_CACHE
+        state->parameterCount = 0;
+#endif /* USE_PARAMETER_CACHE */
+
+        foldHeader(&prev, state->programHeader.ptr, state->programHeader.len, context->header_buffer, sizeof (context->header_buffer), &header);
+
+        context->param_list.cmd = unit->cmd;
+        context->param_list.table = unit->table;
+        context->param_list.numbers = unit->numbers;
+        if (unit->table) {
+            matchHeaderPrefix(&unit->table->prefix, &header, &context->param_list.header);
+        } else {
+            context->param_list.header = header;
+        }
+        result &= executeCommand(context);
+        prev = header;
+    }
+
+    return result;
+}
+#endif /* USE_MESSAGE_CACHE */
+
+/**
+ * Prepare context for new program message
+ * @param context
+ * @param prev - header of previous unit, cleared
+ */
+static void messageBegin(scpi_t * context, scpi_header_t * prev) {
+    context->output_count = 0;
+    prev->count = 0;
+    prev->prefix = -1;
+
+#if USE_MESSAGE_CACHE
+    scpiCache_MessageBegin(context);
+#endif /* USE_MESSAGE_CACHE */
+}
+
+/**
+ * Finish program message
+ * @param context
+ * @param message - complete message or NULL if it can't be remembered
+ * @param len - length of message
+ */
+static void messageEnd(scpi_t * context, const char * message, size_t len) {
+#if USE_MESSAGE_CACHE
+    scpiCache_MessageEnd(context, message, len);
+#else
+    (void) message;
+    (void) len;
+#endif /* USE_MESSAGE_CACHE */
+
+    /* conditionaly write new line */
+    writeNewLine(context);
+}
+
+/**
+ * Execute program message unit found by scpiParser_detectProgramMessageUnit
+ * @param context
+ * @param prev - header of previous unit of the message, updated
+ * @param message - beginning of the message
+ * @return FALSE if there was some error during evaluation of the unit
+ */
+static scpi_bool_t parseUnit(scpi_t * context, scpi_header_t * prev, const char * message) {
+    scpi_parser_state_t * state = &context->parser_state;
+    scpi_bool_t result = TRUE;
+    scpi_header_t header;
+
+#if !USE_MESSAGE_CACHE
+    (void) message;
+#endif /* !USE_MESSAGE_CACHE */
+
+    if (state->programHeader.type == SCPI_TOKEN_INVALID) {
+        SCPI_ErrorPush(context, SCPI_ERROR_INVALID_CHARACTER);
+        result = FALSE;
+#if USE_MESSAGE_CACHE
+        scpiCache_MessageUnit(context, message, &state->programHeader, state, NULL);
+#endif /* USE_MESSAGE_CACHE */
+    } else if (state->programHeader.len > 0) {
+        if (foldHeader(prev, state->programHeader.ptr, state->programHeader.len, context->header_buffer, sizeof (context->header_buffer), &header) &&
+                findCommandHeader(context, &header)) {
+#if USE_MESSAGE_CACHE
+            scpiCache_MessageUnit(context, message, &state->programHeader, state, context->param_list.cmd);
+#endif /* USE_MESSAGE_CACHE */
+
+            result = executeCommand(context);
+            *prev = header;
+        } else {
+            SCPI_ErrorPush(context, SCPI_ERROR_UNDEFINED_HEADER);
+            result = FALSE;
+#if USE_MESSAGE_CACHE
+            scpiCache_MessageUnit(context, message, &state->programHeader, state, NULL);
+#endif /* USE_MESSAGE_CACHE */
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Parse one command line
+ * @param context
+ * @param data - complete command line
+ * @param len - command line length
+ * @return FALSE if there was some error during evaluation of commands
+ */
+scpi_bool_t SCPI_Parse(scpi_t * context, const char * data, int len) {
+    scpi_bool_t result = TRUE;
+    int r;
+    scpi_header_t prev;
+    const char * message = data;
+    int length = len;
+
+    if (context == NULL) {
+        return FALSE;
+    }
+
+#if USE_MESSAGE_CACHE
+    if (scpiCache_MessageMatch(context, data, len, FALSE)) {
+        context->output_count = 0;
+        result = replayMessage(context, data);
+        writeNewLine(context);
+        return result;
+    }
+#endif /* USE_MESSAGE_CACHE */
+
+    messageBegin(context, &prev);
+
+    while (1) {
+        r = scpiParser_detectProgramMessageUnit(&context->parser_state, data, len);
+
+        result &= parseUnit(context, &prev, message);
+
+        if (r < len) {
+            data += r;
+            len -= r;
+        } else {
+            break;
+        }
+
+    }
+
+    messageEnd(context, message, length);
+
+    return result;
+}
+
+/**
+ * Initialize SCPI context structure
+ * @param context
+ * @param command_list
+ * @param buffer
+ * @param interface
+ */
+void SCPI_Init(scpi_t * context) {
+    if (context->idn[0] == NULL) {
+        context->idn[0] = SCPI_DEFAULT_1_MANUFACTURE;
+    }
+    if (context->idn[1] == NULL) {
+        context->idn[1] = SCPI_DEFAULT_2_MODEL;
+    }
+    if (context->idn[2] == NULL) {
+        context->idn[2] = SCPI_DEFAULT_3;
+    }
+    if (context->idn[3] == NULL) {
+        context->idn[3] = SCPI_DEFAULT_4_REVISION;
+    }
+
+    context->buffer.position = 0;
+    context->input_state.unit = 0;
+    context->input_state.start = 0;
+    context->input_state.scanned = 0;
+    context->input_state.message = FALSE;
+#if USE_ARBITRARY_BLOCK_STREAM
+    context->input_state.streaming = FALSE;
+    context->input_state.block = FALSE;
+    context->input_state.block_search = 0;
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+#if USE_NUMERIC_LIST_STREAM
+    context->input_state.listing = FALSE;
+#endif /* USE_NUMERIC_LIST_STREAM */
+#if USE_INPUT_POOL
+    context->input_state.pool = NULL;
+    context->input_state.pool_count = 0;
+#endif /* USE_INPUT_POOL */
+#if USE_PARAMETER_CACHE
+    context->parser_state.parameterHits = 0;
+    context->parser_state.parameterMisses = 0;
+#endif /* USE_PARAMETER_CACHE */
+    SCPI_ErrorInit(context);
+
+#if USE_DISPATCH_CACHE || USE_MESSAGE_CACHE
+    SCPI_DispatchCacheClear(context);
+#endif
+}
+
+#if USE_INPUT_POOL
+/**
+ * Bits of pool chunks
+ * @param first - first chunk
+ * @param count - number of chunks
+ * @return mask of chunks
+ */
+static uint32_t poolChunks(size_t first, size_t count) {
+    uint32_t mask = (count >= 32) ? 0xFFFFFFFFUL : (((uint32_t) 1 << count) - 1);
+    return mask << first;
+}
+
+/**
+ * Use given number of pool chunks as the input buffer
+ *
+ * Borrowed chunks are extended in place if following chunks are free,
+ * otherwise data are copied to free chunks.
+ *
+ * @param context
+ * @param count - number of chunks
+ * @return FALSE if there are not enough free chunks
+ */
+static scpi_bool_t inputBorrow(scpi_t * context, size_t count) {
+    scpi_input_state_t * input = &context->input_state;
+    scpi_input_pool_t * pool = input->pool;
+    uint32_t own = 0;
+    size_t first;
+    char * data;
+
+    if (input->pool_count > 0) {
+        own = poolChunks(input->pool_first, input->pool_count);
+        if ((input->pool_first + count <= pool->chunks)
+                && !(pool->used & ~own & poolChunks(input->pool_first, count))) {
+            pool->used |= poolChunks(input->pool_first, count);
+            input->pool_count = count;
+            context->buffer.length = count * pool->chunk_size;
+            if (context->buffer.length > input->pool_limit) {
+                context->buffer.length = input->pool_limit;
+            }
+            return TRUE;
+        }
+    }
+
+    for (first = 0; first + count <= pool->chunks; first++) {
+        if (pool->used & poolChunks(first, count)) {
+            continue;
+        }
+
+        data = pool->data + first * pool->chunk_size;
+        memcpy(data, context->buffer.data, context->buffer.position + 1);
+        if (input->pool_count > 0) {
+            pool->used &= ~own;
+        } else {
+            input->own_data = context->buffer.data;
+            input->own_length = context->buffer.length;
+        }
+        pool->used |= poolChunks(first, count);
+        input->pool_first = first;
+        input->pool_count = count;
+        context->buffer.data = data;
+        context->buffer.length = count * pool->chunk_size;
+        if (context->buffer.length > input->pool_limit) {
+            context->buffer.length = input->pool_limit;
+        }
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ * Grow the input buffer into pool chunks
+ *
+ * Number of borrowed chunks is doubled if possible, so long message is
+ * not copied with each received piece.
+ *
+ * @param context
+ * @param length - required length of the input buffer
+ * @return FALSE if the pool can't provide such buffer
+ */
+static scpi_bool_t inputGrow(scpi_t * context, size_t length) {
+    scpi_input_state_t * input = &context->input_state;
+    scpi_input_pool_t * pool = input->pool;
+    size_t count;
+    size_t limit;
+
+    if (!pool || (length > input->pool_limit)) {
+        return FALSE;
+    }
+
+    count = (length + pool->chunk_size - 1) / pool->chunk_size;
+    if (count > pool->chunks) {
+        return FALSE;
+    }
+
+    limit = (input->pool_limit + pool->chunk_size - 1) / pool->chunk_size;
+    if (limit > pool->chunks) {
+        limit = pool->chunks;
+    }
+    if ((2 * input->pool_count > count) && inputBorrow(context, (2 * input->pool_count < limit) ? 2 * input->pool_count : limit)) {
+        return TRUE;
+    }
+
+    return inputBorrow(context, count);
+}
+
+/**
+ * Return borrowed chunks to the pool and use own input buffer again
+ *
+ * Data in the input buffer are not moved, they have to be already in own
+ * buffer or dropped.
+ *
+ * @param context
+ */
+static void inputRelease(scpi_t * context) {
+    scpi_input_state_t * input = &context->input_state;
+
+    if (input->pool_count > 0) {
+        input->pool->used &= ~poolChunks(input->pool_first, input->pool_count);
+        input->pool_count = 0;
+        context->buffer.data = input->own_data;
+        context->buffer.length = input->own_length;
+    }
+}
+#endif /* USE_INPUT_POOL */
+
+/**
+ * Execute program message unit just detected in the input buffer
+ *
+ * Units are executed as soon as they are terminated. The message is
+ * finished by a unit terminated by new line or by forced end of message.
+ * Executed data are not moved out of the input buffer, the next message
+ * starts where the previous one ended. The buffer starts from its
+ * beginning again when all data are executed, the rest is moved by
+ * compactInput only when space is needed.
+ *
+ * @param context
+ * @param len - length of the unit in the input buffer
+ * @param end - force end of message
+ * @return FALSE if there was some error during evaluation of the unit
+ */
+static scpi_bool_t inputUnit(scpi_t * context, size_t len, scpi_bool_t end) {
+    scpi_input_state_t * input = &context->input_state;
+    scpi_bool_t result = TRUE;
+
+#if USE_ARBITRARY_BLOCK_STREAM
+    /* next unit is searched for arbitrary block from its beginning */
+    input->block_search = 0;
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+
+    if (!input->message) {
+#if USE_MESSAGE_CACHE
+        size_t length = scpiCache_MessageMatch(context, context->buffer.data + input->unit, context->buffer.position - input->unit, !end);
+        if (length > 0) {
+            context->output_count = 0;
+            result = replayMessage(context, context->buffer.data + input->unit);
+            writeNewLine(context);
+            input->unit += length;
+            len = 0;
+            end = FALSE;
+        } else
+#endif /* USE_MESSAGE_CACHE */
+        {
+            messageBegin(context, &input->prev);
+            input->message = TRUE;
+            input->start = input->unit;
+        }
+    }
+
+    if (len > 0) {
+        result = parseUnit(context, &input->prev, context->buffer.data + input->start);
+        input->unit += len;
+        if (context->parser_state.termination == SCPI_MESSAGE_TERMINATION_NL) {
+            end = TRUE;
+        }
+    }
+
+    if (end) {
+        messageEnd(context, context->buffer.data + input->start, input->unit - input->start);
+        input->message = FALSE;
+    }
+
+    if (!input->message && (input->unit == context->buffer.position)) {
+#if USE_INPUT_POOL
+        inputRelease(context);
+#endif /* USE_INPUT_POOL */
+        context->buffer.position = 0;
+        context->buffer.data[context->buffer.position] = 0;
+        input->unit = 0;
+    }
+
+    return result;
+}
+
+/**
+ * Test if the message continuing by given data is terminated by new line
+ *
+ * Invalid unit may also be just incomplete (e.g. unterminated string), so
+ * it is executed only together with the rest of the message.
+ *
+ * @param context
+ * @param data - beginning of the next unit
+ * @param len - length of data
+ * @return TRUE if new line terminated unit follows
+ */
+static scpi_bool_t inputMessageTerminated(scpi_t * context, const char * data, size_t len) {
+    size_t pos = 0;
+
+    while (pos < len) {
+        pos += scpiParser_detectProgramMessageUnit(&context->parser_state, data + pos, len - pos);
+        if (context->parser_state.termination == SCPI_MESSAGE_TERMINATION_NL) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Drop executed data from the input buffer
+ * @param context
+ */
+static void compactInput(scpi_t * context) {
+    scpi_input_state_t * input = &context->input_state;
+
+    if (input->unit > 0) {
+#if USE_MESSAGE_CACHE
+        if (input->message && (input->start < input->unit)) {
+            /* beginning of the message is lost, it can't be remembered */
+            scpiCache_MessageEnd(context, NULL, 0);
+        }
+#endif /* USE_MESSAGE_CACHE */
+#if USE_INPUT_POOL
+        if ((input->pool_count > 0) && (context->buffer.position - input->unit < input->own_length)) {
+            /* rest fits own buffer again */
+            memcpy(input->own_data, context->buffer.data + input->unit, context->buffer.position - input->unit);
+            inputRelease(context);
+        } else
+#endif /* USE_INPUT_POOL */
+        {
+            memmove(context->buffer.data, context->buffer.data + input->unit, context->buffer.position - input->unit);
+        }
+        context->buffer.position -= input->unit;
+        context->buffer.data[context->buffer.position] = 0;
+        input->scanned -= input->unit;
+        input->unit = 0;
+        input->start = 0;
+    }
+}
+
+#if USE_ARBITRARY_BLOCK_STREAM
+/**
+ * Start streaming if the unterminated unit in the input buffer ends by
+ * arbitrary block of command with stream callback
+ *
+ * Program data before the block are passed to the callback, received part
+ * of the block too and the unit is removed from the input buffer.
+ *
+ * Search for the block continues from input->block_search, so program
+ * data received in many pieces are not searched again from the beginning.
+ *
+ * @param context
+ * @return FALSE if the callback failed
+ */
+static scpi_bool_t inputStreamBegin(scpi_t * context) {
+    scpi_input_state_t * input = &context->input_state;
+    lex_state_t lex;
+    scpi_token_t token;
+    scpi_token_t tmp;
+    scpi_header_t header;
+    size_t prefix;
+    size_t data;
+    size_t len;
+    const char * ptr;
+    scpi_bool_t result;
+
+    input->block = FALSE;
+
+    if (input->unit >= context->buffer.position) {
+        return TRUE;
+    }
+
+    lex.buffer = lex.pos = context->buffer.data + input->unit;
+    lex.len = context->buffer.position - input->unit;
+    scpiLex_WhiteSpace(&lex, &tmp);
+    if ((scpiLex_ProgramHeader(&lex, &token) <= 0)
+            || (token.type == SCPI_TOKEN_INVALID)
+            /* header is complete only when followed by white space */
+            || (scpiLex_WhiteSpace(&lex, &tmp) == 0)) {
+        return TRUE;
+    }
+    lex.buffer = lex.pos;
+    lex.len = context->buffer.data + context->buffer.position - lex.buffer;
+    lex.pos = lex.buffer + input->block_search;
+
+    switch (findBlock(&lex, &prefix, &data, &len, &input->block_search)) {
+        case 0:
+            /* next data can complete the block header */
+            input->block = TRUE;
+            return TRUE;
+        case 1:
+            break;
+        default:
+            return TRUE;
+    }
+
+    if (!foldHeader(input->message ? &input->prev : NULL, token.ptr, token.len, context->header_buffer, sizeof (context->header_buffer), &header)
+            || !findCommandHeader(context, &header)
+            || (context->param_list.cmd->stream == NULL)) {
+        return TRUE;
+    }
+
+    if (!input->message) {
+        messageBegin(context, &input->prev);
+        input->message = TRUE;
+    }
+#if USE_MESSAGE_CACHE
+    /* the unit is not kept in the input buffer, message can't be remembered */
+    scpiCache_MessageEnd(context, NULL, 0);
+#endif /* USE_MESSAGE_CACHE */
+    input->prev = header;
+
+    context->param_list.lex_state.buffer = lex.buffer;
+    context->param_list.lex_state.pos = lex.buffer;
+    context->param_list.lex_state.len = prefix;
+    context->param_list.cmd_raw.data = token.ptr;
+    context->param_list.cmd_raw.position = 0;
+    context->param_list.cmd_raw.length = token.len;
+
+    ptr = lex.buffer + data;
+    input->stream = (len == SCPI_BLOCK_LENGTH_INDEFINITE) ? len : len - ((size_t) lex.len - data);
+    input->streaming = TRUE;
+    input->block_search = 0;
+
+    result = streamBegin(context, len);
+    result = result && streamData(context, ptr, (size_t) lex.len - data);
+
+    context->buffer.position = input->unit;
+    context->buffer.data[context->buffer.position] = 0;
+
+    return result;
+}
+
+/**
+ * Pass received data to stream callback
  * @param context
- * @result TRUE if context->paramlist is filled with correct values
+ * @param data - received data
+ * @param len - length of received data
+ * @param result - FALSE if the callback failed
+ * @return number of bytes belonging to the block
  */
-static scpi_bool_t findCommandHeader(scpi_t * context, const char * header, int len) {
-    int32_t i;
-    const scpi_command_t * cmd;
-
-    for (i = 0; context->cmdlist[i].pattern != NULL; i++) {
-        cmd = &context->cmdlist[i];
-        if (matchCommand(cmd->pattern, header, len, NULL, 0, 0)) {
-            context->param_list.cmd = cmd;
-            return TRUE;
+static size_t inputStreamData(scpi_t * context, const char * data, size_t len, scpi_bool_t * result) {
+    scpi_input_state_t * input = &context->input_state;
+    const char * nl;
+    scpi_bool_t end;
+
+    if (input->stream == SCPI_BLOCK_LENGTH_INDEFINITE) {
+        /* new line terminates the message and the block */
+        nl = (const char *) memchr(data, '\n', len);
+        end = nl != NULL;
+        if (end) {
+            len = nl - data;
         }
+    } else {
+        if (len > input->stream) {
+            len = input->stream;
+        }
+        input->stream -= len;
+        end = input->stream == 0;
     }
-    return FALSE;
+
+    *result = streamData(context, data, len);
+
+    if (end) {
+        input->streaming = FALSE;
+        *result = streamEvent(context, SCPI_STREAM_END, NULL, 0);
+    }
+
+    return len;
 }
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
 
+#if USE_NUMERIC_LIST_STREAM
 /**
- * Parse one command line
+ * Start passing numeric list to list callback if the unterminated unit in
+ * the input buffer belongs to command with list callback
+ *
+ * Program header is removed from the input buffer, the unit continues
+ * only by the list.
+ *
  * @param context
- * @param data - complete command line
- * @param len - command line length
- * @return FALSE if there was some error during evaluation of commands
+ * @return FALSE if the callback failed
  */
-scpi_bool_t SCPI_Parse(scpi_t * context, char * data, int len) {
-    scpi_bool_t result = TRUE;
-    scpi_parser_state_t * state;
-    int r;
-    scpi_token_t cmd_prev = {SCPI_TOKEN_UNKNOWN, NULL, 0};
+static scpi_bool_t inputListBegin(scpi_t * context) {
+    scpi_input_state_t * input = &context->input_state;
+    lex_state_t lex;
+    scpi_token_t token;
+    scpi_token_t tmp;
+    scpi_header_t header;
 
-    if (context == NULL) {
-        return FALSE;
+    if (input->unit >= context->buffer.position) {
+        return TRUE;
     }
 
-    state = &context->parser_state;
-    context->output_count = 0;
+    lex.buffer = lex.pos = context->buffer.data + input->unit;
+    lex.len = context->buffer.position - input->unit;
+    scpiLex_WhiteSpace(&lex, &tmp);
+    if ((scpiLex_ProgramHeader(&lex, &token) <= 0)
+            || (token.type == SCPI_TOKEN_INVALID)
+            /* header is complete only when followed by white space */
+            || (scpiLex_WhiteSpace(&lex, &tmp) == 0)
+            /* the header was already checked with previous data */
+            || (token.ptr + token.len < context->buffer.data + input->scanned)) {
+        return TRUE;
+    }
 
-    while (1) {
-        r = scpiParser_detectProgramMessageUnit(state, data, len);
+    if (!foldHeader(input->message ? &input->prev : NULL, token.ptr, token.len, context->header_buffer, sizeof (context->header_buffer), &header)
+            || !findCommandHeader(context, &header)
+            || (context->param_list.cmd->list == NULL)) {
+        return TRUE;
+    }
 
-        if (state->programHeader.type == SCPI_TOKEN_INVALID) {
-            SCPI_ErrorPush(context, SCPI_ERROR_INVALID_CHARACTER);
-            result = FALSE;
-        } else if (state->programHeader.len > 0) {
+    if (!input->message) {
+        messageBegin(context, &input->prev);
+        input->message = TRUE;
+    }
+#if USE_MESSAGE_CACHE
+    /* the unit is not kept in the input buffer, message can't be remembered */
+    scpiCache_MessageEnd(context, NULL, 0);
+#endif /* USE_MESSAGE_CACHE */
+    input->prev = header;
 
-            composeCompoundCommand(&cmd_prev, &state->programHeader);
+    context->param_list.lex_state.buffer = lex.pos;
+    context->param_list.lex_state.pos = lex.pos;
+    context->param_list.lex_state.len = 0;
+    context->param_list.cmd_raw.data = token.ptr;
+    context->param_list.cmd_raw.position = 0;
+    context->param_list.cmd_raw.length = token.len;
 
-            if (findCommandHeader(context, state->programHeader.ptr, state->programHeader.len)) {
+    input->unit = lex.pos - context->buffer.data;
+    input->listing = TRUE;
 
-                context->param_list.lex_state.buffer = state->programData.ptr;
-                context->param_list.lex_state.pos = context->param_list.lex_state.buffer;
-                context->param_list.lex_state.len = state->programData.len;
-                context->param_list.cmd_raw.data = state->programHeader.ptr;
-                context->param_list.cmd_raw.position = 0;
-                context->param_list.cmd_raw.length = state->programHeader.len;
+    return listBegin(context);
+}
 
-                result &= processCommand(context);
-                cmd_prev = state->programHeader;
-            } else {
-                SCPI_ErrorPush(context, SCPI_ERROR_UNDEFINED_HEADER);
-                result = FALSE;
-            }
-        }
+/**
+ * Pass numbers received in the input buffer to list callback
+ *
+ * Decoded numbers are dropped from the input buffer, incomplete number at
+ * the end is kept. Termination of the unit ends the list.
+ *
+ * @param context
+ * @param end - end of message, rest of the buffer completes the list
+ * @return FALSE if the callback failed
+ */
+static scpi_bool_t inputListData(scpi_t * context, scpi_bool_t end) {
+    scpi_input_state_t * input = &context->input_state;
+    const char * data = context->buffer.data + input->unit;
+    size_t len = context->buffer.position - input->unit;
+    size_t term = scanTerminator(data, len);
+    lex_state_t lex;
+    scpi_token_t tmp;
+    scpi_bool_t result;
 
-        if (r < len) {
-            data += r;
-            len -= r;
-        } else {
-            break;
+    if (term == len) {
+        input->unit += listData(context, data, len, end);
+        if (!end) {
+            return !input->list_error;
         }
-
+    } else {
+        listData(context, data, term, TRUE);
+        lex.buffer = lex.pos = data + term;
+        lex.len = (int) (len - term);
+        input->unit += term + ((data[term] == ';') ? 1 : scpiLex_NewLine(&lex, &tmp));
     }
 
-    /* conditionaly write new line */
-    writeNewLine(context);
+    input->listing = FALSE;
+#if USE_ARBITRARY_BLOCK_STREAM
+    input->block_search = 0;
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+    result = listEnd(context, input->list_error);
+
+    if ((term < len) && (data[term] != ';')) {
+        result &= inputUnit(context, 0, TRUE);
+    }
 
     return result;
 }
+#endif /* USE_NUMERIC_LIST_STREAM */
 
 /**
- * Initialize SCPI context structure
+ * Input buffer overrun - invalidate buffer
  * @param context
- * @param command_list
- * @param buffer
- * @param interface
  */
-void SCPI_Init(scpi_t * context) {
-    if (context->idn[0] == NULL) {
-        context->idn[0] = SCPI_DEFAULT_1_MANUFACTURE;
+static void inputOverrun(scpi_t * context) {
+    scpi_input_state_t * input = &context->input_state;
+
+#if USE_NUMERIC_LIST_STREAM
+    if (input->listing) {
+        input->listing = FALSE;
+        listEnd(context, TRUE);
+    }
+#endif /* USE_NUMERIC_LIST_STREAM */
+#if USE_INPUT_POOL
+    inputRelease(context);
+#endif /* USE_INPUT_POOL */
+    context->buffer.position = 0;
+    context->buffer.data[context->buffer.position] = 0;
+    input->unit = 0;
+    input->scanned = 0;
+    input->message = FALSE;
+#if USE_ARBITRARY_BLOCK_STREAM
+    input->block_search = 0;
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+    SCPI_ErrorPush(context, SCPI_ERROR_INPUT_BUFFER_OVERRUN);
+}
+
+/**
+ * Execute program message units terminated by data just added to the
+ * input buffer
+ * @param context
+ * @return FALSE if there was some error during evaluation of units
+ */
+static scpi_bool_t inputReceived(scpi_t * context) {
+    scpi_input_state_t * input = &context->input_state;
+    scpi_bool_t result = TRUE;
+    int cmdlen;
+
+#if USE_NUMERIC_LIST_STREAM
+    if (input->listing) {
+        result = inputListData(context, FALSE);
+        if (input->listing) {
+            input->scanned = context->buffer.position;
+            return result;
+        }
     }
-    if (context->idn[1] == NULL) {
-        context->idn[1] = SCPI_DEFAULT_2_MODEL;
+#endif /* USE_NUMERIC_LIST_STREAM */
+
+    /* unit can be terminated only by data not searched yet */
+    if (scanTerminator(context->buffer.data + input->scanned, context->buffer.position - input->scanned) == context->buffer.position - input->scanned) {
+#if USE_ARBITRARY_BLOCK_STREAM
+        /* or it can continue by streamed block */
+        if ((input->block || memchr(context->buffer.data + input->scanned, '#', context->buffer.position - input->scanned))
+                && !inputStreamBegin(context)) {
+            result = FALSE;
+        }
+        if (!input->streaming)
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+        {
+#if USE_NUMERIC_LIST_STREAM
+            if (!inputListBegin(context) || (input->listing && !inputListData(context, FALSE))) {
+                result = FALSE;
+            }
+#endif /* USE_NUMERIC_LIST_STREAM */
+        }
+        input->scanned = context->buffer.position;
+        return result;
     }
-    if (context->idn[2] == NULL) {
-        context->idn[2] = SCPI_DEFAULT_3;
+
+    while (input->unit < context->buffer.position) {
+        cmdlen = scpiParser_detectProgramMessageUnit(&context->parser_state, context->buffer.data + input->unit, context->buffer.position - input->unit);
+
+        /* wait for the rest of unterminated unit */
+        if (context->parser_state.termination == SCPI_MESSAGE_TERMINATION_NONE) {
+            if ((context->parser_state.programHeader.type == SCPI_TOKEN_UNKNOWN)
+                    || (input->unit + cmdlen >= context->buffer.position)
+                    || !inputMessageTerminated(context, context->buffer.data + input->unit + cmdlen, context->buffer.position - input->unit - cmdlen)) {
+                break;
+            }
+            cmdlen = scpiParser_detectProgramMessageUnit(&context->parser_state, context->buffer.data + input->unit, context->buffer.position - input->unit);
+        }
+
+        result &= inputUnit(context, cmdlen, FALSE);
     }
-    if (context->idn[3] == NULL) {
-        context->idn[3] = SCPI_DEFAULT_4_REVISION;
+
+#if USE_ARBITRARY_BLOCK_STREAM
+    if (!inputStreamBegin(context)) {
+        result = FALSE;
+    }
+    if (!input->streaming)
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+    {
+#if USE_NUMERIC_LIST_STREAM
+        if (!inputListBegin(context) || (input->listing && !inputListData(context, FALSE))) {
+            result = FALSE;
+        }
+#endif /* USE_NUMERIC_LIST_STREAM */
     }
+    input->scanned = context->buffer.position;
 
-    context->buffer.position = 0;
-    SCPI_ErrorInit(context);
+    return result;
 }
 
 /**
@@ -303,55 +1544,308 @@ void SCPI_Init(scpi_t * context) {
  * command line termination. If the termination is found or if len=0, command
  * parser is called.
  *
+ * Program message units are detected and executed only once. Data received
+ * without any unit termination are just searched for it, so the work does
+ * not grow with number of pieces the message is received in.
+ *
  * @param context
  * @param data - data to process
  * @param len - length of data
  * @return
  */
 scpi_bool_t SCPI_Input(scpi_t * context, const char * data, int len) {
+    scpi_input_state_t * input = &context->input_state;
     scpi_bool_t result = TRUE;
-    size_t totcmdlen = 0;
-    int cmdlen = 0;
+    int cmdlen;
 
     if (len == 0) {
+#if USE_ARBITRARY_BLOCK_STREAM
+        if (input->streaming && (input->stream == SCPI_BLOCK_LENGTH_INDEFINITE)) {
+            /* end of message terminates block of indefinite length */
+            input->streaming = FALSE;
+            result = streamEvent(context, SCPI_STREAM_END, NULL, 0);
+        } else if (input->streaming) {
+            /* message ends by incomplete block */
+            input->streaming = FALSE;
+            streamEvent(context, SCPI_STREAM_ABORT, NULL, 0);
+            SCPI_ErrorPush(context, SCPI_ERROR_INVALID_BLOCK_DATA);
+            result = FALSE;
+        }
+        input->block = FALSE;
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+
         context->buffer.data[context->buffer.position] = 0;
-        result = SCPI_Parse(context, context->buffer.data, context->buffer.position);
-        context->buffer.position = 0;
+#if USE_NUMERIC_LIST_STREAM
+        if (input->listing) {
+            result &= inputListData(context, TRUE);
+        }
+#endif /* USE_NUMERIC_LIST_STREAM */
+        while (input->unit < context->buffer.position) {
+            cmdlen = scpiParser_detectProgramMessageUnit(&context->parser_state, context->buffer.data + input->unit, context->buffer.position - input->unit);
+            result &= inputUnit(context, cmdlen, context->buffer.position == input->unit + cmdlen);
+        }
+        if (input->message) {
+            result &= inputUnit(context, 0, TRUE);
+        }
+        input->scanned = context->buffer.position;
     } else {
         int buffer_free;
 
+#if USE_ARBITRARY_BLOCK_STREAM
+        if (input->streaming) {
+            cmdlen = (int) inputStreamData(context, data, len, &result);
+            data += cmdlen;
+            len -= cmdlen;
+            if (len == 0) {
+                return result;
+            }
+        }
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+
         buffer_free = context->buffer.length - context->buffer.position;
         if (len > (buffer_free - 1)) {
-            /* Input buffer overrun - invalidate buffer */
-            context->buffer.position = 0;
-            context->buffer.data[context->buffer.position] = 0;
-            SCPI_ErrorPush(context, SCPI_ERROR_INPUT_BUFFER_OVERRUN);
+            compactInput(context);
+            buffer_free = context->buffer.length - context->buffer.position;
+        }
+        if ((len > (buffer_free - 1))
+#if USE_INPUT_POOL
+                && !inputGrow(context, context->buffer.position + len + 1)
+#endif /* USE_INPUT_POOL */
+                ) {
+            inputOverrun(context);
             return FALSE;
         }
         memcpy(&context->buffer.data[context->buffer.position], data, len);
         context->buffer.position += len;
         context->buffer.data[context->buffer.position] = 0;
 
+        result &= inputReceived(context);
+    }
+
+    return result;
+}
+
+/**
+ * Parse data in place, without copying them to the input buffer
+ *
+ * Program message units are executed directly from the data as in
+ * SCPI_Input. Unterminated unit at the end is not consumed, it has to be
+ * passed again together with following data or to SCPI_Input. The data
+ * have to stay valid only during the call.
+ *
+ * If the input buffer holds data from SCPI_Input not executed yet, data
+ * are added to the input buffer by SCPI_Input.
+ *
+ * @param context
+ * @param data - data to process
+ * @param len - length of data, 0 to end the message as SCPI_Input
+ * @param consumed - return number of bytes executed
+ * @return FALSE if there was some error during evaluation of commands
+ */
+scpi_bool_t SCPI_InputView(scpi_t * context, const char * data, size_t len, size_t * consumed) {
+    scpi_input_state_t * input = &context->input_state;
+    scpi_parser_state_t * state = &context->parser_state;
+    scpi_bool_t result = TRUE;
+    size_t pos = 0;
+    size_t cmdlen;
 
-        while (1) {
-            cmdlen = scpiParser_detectProgramMessageUnit(&context->parser_state, context->buffer.data + totcmdlen, context->buffer.position - totcmdlen);
-            totcmdlen += cmdlen;
+    if (!consumed) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return FALSE;
+    }
 
-            if (context->parser_state.termination == SCPI_MESSAGE_TERMINATION_NL) {
-                result = SCPI_Parse(context, context->buffer.data, totcmdlen);
-                memmove(context->buffer.data, context->buffer.data + totcmdlen, context->buffer.position - totcmdlen);
-                context->buffer.position -= totcmdlen;
-                totcmdlen = 0;
-            } else {
-                if (context->parser_state.programHeader.type == SCPI_TOKEN_UNKNOWN) break;
-                if (totcmdlen >= context->buffer.position) break;
+    if (len > INT_MAX) {
+        /* rest is left for the next call */
+        len = INT_MAX;
+    }
+
+    if ((len == 0) || (context->buffer.position > 0)
+#if USE_ARBITRARY_BLOCK_STREAM
+            || input->streaming
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+#if USE_NUMERIC_LIST_STREAM
+            || input->listing
+#endif /* USE_NUMERIC_LIST_STREAM */
+            ) {
+        result = SCPI_Input(context, data, (int) len);
+        *consumed = len;
+        return result;
+    }
+
+    while (pos < len) {
+        cmdlen = (size_t) scpiParser_detectProgramMessageUnit(state, data + pos, (int) (len - pos));
+
+        /* wait for the rest of unterminated unit */
+        if (state->termination == SCPI_MESSAGE_TERMINATION_NONE) {
+            if ((state->programHeader.type == SCPI_TOKEN_UNKNOWN)
+                    || (pos + cmdlen >= len)
+                    || !inputMessageTerminated(context, data + pos + cmdlen, len - pos - cmdlen)) {
+                break;
             }
+            cmdlen = (size_t) scpiParser_detectProgramMessageUnit(state, data + pos, (int) (len - pos));
+        }
+
+        if (!input->message) {
+            messageBegin(context, &input->prev);
+            input->message = TRUE;
+        }
+        result &= parseUnit(context, &input->prev, data + pos);
+        pos += cmdlen;
+
+        if (state->termination == SCPI_MESSAGE_TERMINATION_NL) {
+            /* layout of message in caller's memory is not remembered */
+            messageEnd(context, NULL, 0);
+            input->message = FALSE;
+        }
+    }
+
+    *consumed = pos;
+    return result;
+}
+
+/**
+ * Get free part of the input buffer, so data can be received directly
+ * into it and passed to the parser by SCPI_InputCommit without a copy.
+ *
+ * Executed units of unfinished message are dropped when they occupy more
+ * space than is free. If the buffer is full of one unterminated unit, it
+ * grows into the input pool or it is invalidated as if SCPI_Input was
+ * called.
+ *
+ * @param context
+ * @param data - return beginning of free space
+ * @param len - return length of free space
+ * @return FALSE if the buffer overflowed, the whole buffer is free then
+ */
+scpi_bool_t SCPI_InputReserve(scpi_t * context, char ** data, size_t * len) {
+    scpi_input_state_t * input = &context->input_state;
+    scpi_bool_t result = TRUE;
+    size_t buffer_free;
+
+    if (!data || !len) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return FALSE;
+    }
+
+    buffer_free = context->buffer.length - context->buffer.position - 1;
+    if (input->unit >= buffer_free) {
+        compactInput(context);
+        buffer_free = context->buffer.length - context->buffer.position - 1;
+    }
+    if (buffer_free == 0) {
+#if USE_INPUT_POOL
+        if (inputGrow(context, context->buffer.position + 2)) {
+            buffer_free = context->buffer.length - context->buffer.position - 1;
+        } else
+#endif /* USE_INPUT_POOL */
+        {
+            inputOverrun(context);
+            buffer_free = context->buffer.length - 1;
+            result = FALSE;
+        }
+    }
+
+    *data = context->buffer.data + context->buffer.position;
+    *len = buffer_free;
+
+    return result;
+}
+
+/**
+ * Pass data received into the space returned by SCPI_InputReserve to the
+ * parser, it is the same as SCPI_Input with the data.
+ *
+ * End of message (SCPI_Input with len=0) is still signaled by SCPI_Input.
+ *
+ * @param context
+ * @param len - length of received data, at most the reserved length
+ * @return FALSE if there was some error during evaluation of commands
+ */
+scpi_bool_t SCPI_InputCommit(scpi_t * context, size_t len) {
+    scpi_bool_t result = TRUE;
+
+    if (len == 0) {
+        return TRUE;
+    }
+
+    if (len >= context->buffer.length - context->buffer.position) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return FALSE;
+    }
+
+#if USE_ARBITRARY_BLOCK_STREAM
+    if (context->input_state.streaming) {
+        char * data = context->buffer.data + context->buffer.position;
+        size_t used = inputStreamData(context, data, len, &result);
+        len -= used;
+        if (len == 0) {
+            return result;
         }
+        /* block ended, rest of data is parsed */
+        memmove(data, data + used, len);
     }
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+
+    context->buffer.position += len;
+    context->buffer.data[context->buffer.position] = 0;
+
+    result &= inputReceived(context);
 
     return result;
 }
 
+#if USE_INPUT_POOL
+/**
+ * Initialize pool of chunks for input buffers
+ *
+ * The pool can be shared by more contexts used from the same thread.
+ *
+ * @param pool
+ * @param data - memory for all chunks
+ * @param chunk_size - size of one chunk
+ * @param chunks - number of chunks, at most SCPI_INPUT_POOL_CHUNKS
+ */
+void SCPI_InputPoolInit(scpi_input_pool_t * pool, char * data, size_t chunk_size, size_t chunks) {
+    if (chunks > SCPI_INPUT_POOL_CHUNKS) {
+        chunks = SCPI_INPUT_POOL_CHUNKS;
+    }
+
+    pool->data = data;
+    pool->chunk_size = chunk_size;
+    pool->chunks = (data && (chunk_size > 0)) ? chunks : 0;
+    pool->used = 0;
+}
+
+/**
+ * Let the input buffer grow into pool chunks
+ *
+ * Message which doesn't fit the input buffer is moved to contiguous free
+ * chunks, chunks are returned when all data in them are executed. Call it
+ * after SCPI_Init, when no message is being received.
+ *
+ * @param context
+ * @param pool - pool of chunks, NULL to use only own input buffer
+ * @param limit - maximal length of the input buffer, including the
+ *                terminating zero
+ */
+void SCPI_InputPoolSet(scpi_t * context, scpi_input_pool_t * pool, size_t limit) {
+    scpi_input_state_t * input = &context->input_state;
+
+    if (input->pool_count > 0) {
+        /* keep unexecuted data if they fit */
+        if (context->buffer.position < input->own_length) {
+            memcpy(input->own_data, context->buffer.data, context->buffer.position + 1);
+        } else {
+            inputOverrun(context);
+        }
+        inputRelease(context);
+    }
+
+    input->pool = pool;
+    input->pool_limit = limit;
+}
+#endif /* USE_INPUT_POOL */
+
 /* writing results */
 
 /**
@@ -625,6 +2119,56 @@ size_t SCPI_ResultBufferFloat(scpi_t * context, const float *data, uint32_t size
 
 /* parsing parameters */
 
+/**
+ * Write header of arbitrary block program data to the result, data of the
+ * block follow by SCPI_ResultArbitraryBlockChunk
+ *
+ * Block of indefinite length "#0" has to be the last result of the
+ * message, it is terminated by new line at the end of the message.
+ *
+ * @param context
+ * @param len - length of the block or SCPI_BLOCK_LENGTH_INDEFINITE
+ * @return
+ */
+size_t SCPI_ResultArbitraryBlockBegin(scpi_t * context, size_t len) {
+    char block_header[12];
+    size_t header_len;
+    block_header[0] = '#';
+
+    if (len == SCPI_BLOCK_LENGTH_INDEFINITE) {
+        block_header[1] = '0';
+        header_len = 0;
+    } else {
+        SCPI_UInt32ToStrBase((uint32_t) len, block_header + 2, 10, 10);
+        header_len = strlen(block_header + 2);
+        block_header[1] = (char) (header_len + '0');
+    }
+
+    context->output_count++;
+    return writeData(context, block_header, header_len + 2);
+}
+
+/**
+ * Write part of arbitrary block data to the result
+ * @param context
+ * @param data
+ * @param len
+ * @return
+ */
+size_t SCPI_ResultArbitraryBlockChunk(scpi_t * context, const char * data, size_t len) {
+    return writeData(context, data, len);
+}
+
+/**
+ * Finish arbitrary block started by SCPI_ResultArbitraryBlockBegin
+ * @param context
+ * @return
+ */
+size_t SCPI_ResultArbitraryBlockEnd(scpi_t * context) {
+    flushData(context);
+    return 0;
+}
+
 /**
  * Write arbitrary block program data to the result
  * @param context
@@ -634,18 +2178,10 @@ size_t SCPI_ResultBufferFloat(scpi_t * context, const float *data, uint32_t size
  */
 size_t SCPI_ResultArbitraryBlock(scpi_t * context, const char * data, size_t len) {
     size_t result = 0;
-    char block_header[12];
-    size_t header_len;
-    block_header[0] = '#';
-    SCPI_UInt32ToStrBase((uint32_t) len, block_header + 2, 10, 10);
 
-    header_len = strlen(block_header + 2);
-    block_header[1] = (char) (header_len + '0');
-
-    result += writeData(context, block_header, header_len + 2);
+    result += SCPI_ResultArbitraryBlockBegin(context, len);
     result += writeData(context, data, len);
 
-    context->output_count++;
     return result;
 }
 
@@ -666,10 +2202,75 @@ size_t SCPI_ResultBool(scpi_t * context, scpi_bool_t val) {
  * @param token
  * @param ptr
  */
-static void invalidateToken(scpi_token_t * token, char * ptr) {
-    token->len = 0;
-    token->ptr = ptr;
-    token->type = SCPI_TOKEN_UNKNOWN;
+static void invalidateToken(scpi_token_t * token, const char * ptr) {
+    token->len = 0;
+    token->ptr = ptr;
+    token->type = SCPI_TOKEN_UNKNOWN;
+}
+
+/**
+ * Take next parameter remembered while detecting program message unit
+ * @param context
+ * @param parameter
+ * @return FALSE if the parameter has to be lexed again
+ */
+static scpi_bool_t takeParameter(scpi_t * context, scpi_parameter_t * parameter) {
+#if USE_PARAMETER_CACHE
+    scpi_parser_state_t * parser = &context->parser_state;
+    lex_state_t * state = &context->param_list.lex_state;
+    const scpi_parameter_token_t * param;
+    size_t index = context->input_count - 1;
+
+    if ((index < parser->parameterCount) && (state->buffer == parser->programData.ptr)) {
+        param = &parser->parameters[index];
+        if (state->pos == state->buffer + param->start) {
+            parameter->type = (scpi_token_type_t) param->type;
+            parameter->ptr = state->buffer + param->offset;
+            parameter->len = param->len;
+            state->pos = state->buffer + param->end;
+            parser->parameterHits++;
+            return TRUE;
+        }
+    }
+    parser->parameterMisses++;
+#else
+    (void) context;
+    (void) parameter;
+#endif /* USE_PARAMETER_CACHE */
+
+    return FALSE;
+}
+
+/**
+ * Suffix of the last parameter returned by SCPI_Parameter
+ * @param context
+ * @param parameter - the last parameter
+ * @param suffix - suffix of the parameter
+ * @return FALSE if the suffix has to be lexed again
+ */
+scpi_bool_t scpiParser_parameterSuffix(scpi_t * context, const scpi_parameter_t * parameter, scpi_token_t * suffix) {
+#if USE_PARAMETER_CACHE
+    const scpi_parser_state_t * parser = &context->parser_state;
+    const lex_state_t * state = &context->param_list.lex_state;
+    const scpi_parameter_token_t * param;
+    size_t index = context->input_count - 1;
+
+    if ((index < parser->parameterCount) && (state->buffer == parser->programData.ptr)) {
+        param = &parser->parameters[index];
+        if ((param->suffix != 0) && (parameter->ptr == state->buffer + param->offset)) {
+            suffix->type = SCPI_TOKEN_SUFFIX_PROGRAM_DATA;
+            suffix->ptr = state->buffer + param->suffix;
+            suffix->len = param->offset + param->len - param->suffix;
+            return TRUE;
+        }
+    }
+#else
+    (void) context;
+    (void) parameter;
+    (void) suffix;
+#endif /* USE_PARAMETER_CACHE */
+
+    return FALSE;
 }
 
 /**
@@ -710,7 +2311,9 @@ scpi_bool_t SCPI_Parameter(scpi_t * context, scpi_parameter_t * parameter, scpi_
 
     context->input_count++;
 
-    scpiParser_parseProgramData(&context->param_list.lex_state, parameter);
+    if (!takeParameter(context, parameter)) {
+        scpiParser_parseProgramData(&context->param_list.lex_state, parameter);
+    }
 
     switch (parameter->type) {
         case SCPI_TOKEN_HEXNUM:
@@ -760,6 +2363,9 @@ scpi_bool_t SCPI_ParamIsNumber(scpi_parameter_t * parameter, scpi_bool_t suffixA
  * @return TRUE if succesful
  */
 static scpi_bool_t ParamSignToUInt32(scpi_t * context, scpi_parameter_t * parameter, uint32_t * value, scpi_bool_t sign) {
+    scpi_bool_t overflow = FALSE;
+    size_t len = (size_t) parameter->len;
+    size_t used;
 
     if (!value) {
         SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
@@ -768,21 +2374,32 @@ static scpi_bool_t ParamSignToUInt32(scpi_t * context, scpi_parameter_t * parame
 
     switch (parameter->type) {
         case SCPI_TOKEN_HEXNUM:
-            return strBaseToUInt32(parameter->ptr, value, 16) > 0 ? TRUE : FALSE;
+            used = strBaseToUInt32(parameter->ptr, len, value, 16, &overflow);
+            break;
         case SCPI_TOKEN_OCTNUM:
-            return strBaseToUInt32(parameter->ptr, value, 8) > 0 ? TRUE : FALSE;
+            used = strBaseToUInt32(parameter->ptr, len, value, 8, &overflow);
+            break;
         case SCPI_TOKEN_BINNUM:
-            return strBaseToUInt32(parameter->ptr, value, 2) > 0 ? TRUE : FALSE;
+            used = strBaseToUInt32(parameter->ptr, len, value, 2, &overflow);
+            break;
         case SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA:
         case SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA_WITH_SUFFIX:
             if (sign) {
-                return strBaseToInt32(parameter->ptr, (int32_t *) value, 10) > 0 ? TRUE : FALSE;
+                used = strBaseToInt32(parameter->ptr, len, (int32_t *) value, 10, &overflow);
             } else {
-                return strBaseToUInt32(parameter->ptr, value, 10) > 0 ? TRUE : FALSE;
+                used = strBaseToUInt32(parameter->ptr, len, value, 10, &overflow);
             }
+            break;
         default:
             return FALSE;
     }
+
+    if (overflow) {
+        SCPI_ErrorPush(context, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return FALSE;
+    }
+
+    return used > 0 ? TRUE : FALSE;
 }
 
 /**
@@ -794,6 +2411,9 @@ static scpi_bool_t ParamSignToUInt32(scpi_t * context, scpi_parameter_t * parame
  * @return TRUE if succesful
  */
 static scpi_bool_t ParamSignToUInt64(scpi_t * context, scpi_parameter_t * parameter, uint64_t * value, scpi_bool_t sign) {
+    scpi_bool_t overflow = FALSE;
+    size_t len = (size_t) parameter->len;
+    size_t used;
 
     if (!value) {
         SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
@@ -802,21 +2422,32 @@ static scpi_bool_t ParamSignToUInt64(scpi_t * context, scpi_parameter_t * parame
 
     switch (parameter->type) {
         case SCPI_TOKEN_HEXNUM:
-            return strBaseToUInt64(parameter->ptr, value, 16) > 0 ? TRUE : FALSE;
+            used = strBaseToUInt64(parameter->ptr, len, value, 16, &overflow);
+            break;
         case SCPI_TOKEN_OCTNUM:
-            return strBaseToUInt64(parameter->ptr, value, 8) > 0 ? TRUE : FALSE;
+            used = strBaseToUInt64(parameter->ptr, len, value, 8, &overflow);
+            break;
         case SCPI_TOKEN_BINNUM:
-            return strBaseToUInt64(parameter->ptr, value, 2) > 0 ? TRUE : FALSE;
+            used = strBaseToUInt64(parameter->ptr, len, value, 2, &overflow);
+            break;
         case SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA:
         case SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA_WITH_SUFFIX:
             if (sign) {
-                return strBaseToInt64(parameter->ptr, (int64_t *) value, 10) > 0 ? TRUE : FALSE;
+                used = strBaseToInt64(parameter->ptr, len, (int64_t *) value, 10, &overflow);
             } else {
-                return strBaseToUInt64(parameter->ptr, value, 10) > 0 ? TRUE : FALSE;
+                used = strBaseToUInt64(parameter->ptr, len, value, 10, &overflow);
             }
+            break;
         default:
             return FALSE;
     }
+
+    if (overflow) {
+        SCPI_ErrorPush(context, SCPI_ERROR_DATA_OUT_OF_RANGE);
+        return FALSE;
+    }
+
+    return used > 0 ? TRUE : FALSE;
 }
 
 /**
@@ -888,7 +2519,7 @@ scpi_bool_t SCPI_ParamToFloat(scpi_t * context, scpi_parameter_t * parameter, fl
             break;
         case SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA:
         case SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA_WITH_SUFFIX:
-            result = strToFloat(parameter->ptr, value) > 0 ? TRUE : FALSE;
+            result = strToFloat(parameter->ptr, (size_t) parameter->len, value) > 0 ? TRUE : FALSE;
             break;
         default:
             result = FALSE;
@@ -921,7 +2552,7 @@ scpi_bool_t SCPI_ParamToDouble(scpi_t * context, scpi_parameter_t * parameter, d
             break;
         case SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA:
         case SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA_WITH_SUFFIX:
-            result = strToDouble(parameter->ptr, value) > 0 ? TRUE : FALSE;
+            result = strToDouble(parameter->ptr, (size_t) parameter->len, value) > 0 ? TRUE : FALSE;
             break;
         default:
             result = FALSE;
@@ -1334,6 +2965,8 @@ scpi_bool_t SCPI_ParamChoice(scpi_t * context, const scpi_choice_def_t * options
 /**
  * Red Pitaya added function
  * TODO, replace with upstream equivalent
+ *
+ * Size of data is not checked, use SCPI_ParamArrayFloat
  */
 scpi_bool_t SCPI_ParamBufferFloat(scpi_t * context, float *data, uint32_t *size, scpi_bool_t mandatory) {
     *size = 0;
@@ -1352,6 +2985,8 @@ scpi_bool_t SCPI_ParamBufferFloat(scpi_t * context, float *data, uint32_t *size,
 /**
  * Red Pitaya added function
  * TODO, replace with upstream equivalent
+ *
+ * Size of data is not checked, use SCPI_ParamArrayInt32
  */
 scpi_bool_t SCPI_ParamBufferInt32(scpi_t * context, int32_t *data, uint32_t *size, scpi_bool_t mandatory) {
     *size = 0;
@@ -1367,13 +3002,248 @@ scpi_bool_t SCPI_ParamBufferInt32(scpi_t * context, int32_t *data, uint32_t *siz
     return true;
 }
 
+/* Element type of SCPI_ParamArray* */
+typedef enum {
+    ARRAY_FLOAT,
+    ARRAY_DOUBLE,
+    ARRAY_INT16,
+    ARRAY_INT32,
+    ARRAY_UINT64,
+} array_type_t;
+
+/**
+ * Convert decimal number directly from program data
+ *
+ * Only the common form of number is converted here, anything else (other
+ * base, suffix, range error, ...) is left to the single parameter reader.
+ *
+ * @param str - beginning of the number
+ * @param len - length of the rest of program data
+ * @param type - element type
+ * @param data - array
+ * @param index - element to store the number to
+ * @return number of bytes used, 0 if the number has to be read as parameter
+ */
+static size_t arrayNumber(const char * str, size_t len, array_type_t type, void * data, size_t index) {
+    scpi_bool_t overflow = FALSE;
+    int32_t value;
+    size_t used = 0;
+
+    switch (type) {
+        case ARRAY_FLOAT:
+            used = strToFloat(str, len, (float *) data + index);
+            break;
+        case ARRAY_DOUBLE:
+            used = strToDouble(str, len, (double *) data + index);
+            break;
+        case ARRAY_INT16:
+            used = strBaseToInt32(str, len, &value, 10, &overflow);
+            if ((used > 0) && ((value < INT16_MIN) || (value > INT16_MAX))) {
+                overflow = TRUE;
+            }
+            if ((used > 0) && !overflow) {
+                ((int16_t *) data)[index] = (int16_t) value;
+            }
+            break;
+        case ARRAY_INT32:
+            used = strBaseToInt32(str, len, (int32_t *) data + index, 10, &overflow);
+            break;
+        case ARRAY_UINT64:
+            used = strBaseToUInt64(str, len, (uint64_t *) data + index, 10, &overflow);
+            break;
+    }
+
+    return overflow ? 0 : used;
+}
+
+/**
+ * Read one element of numeric array as single parameter
+ * @param context
+ * @param type - element type
+ * @param data - array
+ * @param index - element to store the number to
+ * @return FALSE if the parameter is not valid number of the type
+ */
+static scpi_bool_t arrayParameter(scpi_t * context, array_type_t type, void * data, size_t index) {
+    int32_t value;
+
+    switch (type) {
+        case ARRAY_FLOAT:
+            return SCPI_ParamFloat(context, (float *) data + index, TRUE);
+        case ARRAY_DOUBLE:
+            return SCPI_ParamDouble(context, (double *) data + index, TRUE);
+        case ARRAY_INT16:
+            if (!SCPI_ParamInt32(context, &value, TRUE)) {
+                return FALSE;
+            }
+            if ((value < INT16_MIN) || (value > INT16_MAX)) {
+                SCPI_ErrorPush(context, SCPI_ERROR_DATA_OUT_OF_RANGE);
+                return FALSE;
+            }
+            ((int16_t *) data)[index] = (int16_t) value;
+            return TRUE;
+        case ARRAY_INT32:
+            return SCPI_ParamInt32(context, (int32_t *) data + index, TRUE);
+        case ARRAY_UINT64:
+            return SCPI_ParamUInt64(context, (uint64_t *) data + index, TRUE);
+    }
+
+    return FALSE;
+}
+
+/**
+ * Read all remaining parameters as numeric array
+ *
+ * Plain decimal numbers are converted in one pass over program data,
+ * other elements are read by single parameter reader, so the result and
+ * errors are the same as reading the elements one by one.
+ *
+ * The converter stops at the separator, so it is not searched for by
+ * scanStructural. Elements are mostly shorter than the vector scanned by
+ * it and the extra pass over program data made reading slower.
+ *
+ * @param context
+ * @param type - element type
+ * @param data - array
+ * @param size - capacity of the array
+ * @param count - number of elements read, index of the first invalid
+ *                element on error
+ * @param mandatory - at least one element is required
+ * @return FALSE on invalid element or more elements than size
+ */
+static scpi_bool_t paramArray(scpi_t * context, array_type_t type, void * data, size_t size, size_t * count, scpi_bool_t mandatory) {
+    lex_state_t * state = &context->param_list.lex_state;
+    const char * end = state->buffer + state->len;
+    const char * p;
+    size_t used;
+    size_t n;
+
+    if (!data || !count) {
+        SCPI_ErrorPush(context, SCPI_ERROR_SYSTEM_ERROR);
+        return FALSE;
+    }
+
+    for (n = 0;; n++) {
+        *count = n;
+
+        if (state->pos >= end) {
+            if ((n == 0) && mandatory) {
+                SCPI_ErrorPush(context, SCPI_ERROR_MISSING_PARAMETER);
+                return FALSE;
+            }
+            return TRUE;
+        }
+
+        if (n >= size) {
+            SCPI_ErrorPush(context, SCPI_ERROR_TOO_MUCH_DATA);
+            return FALSE;
+        }
+
+        p = state->pos;
+        if (context->input_count != 0) {
+            p = (*p == ',') ? p + 1 : end;
+        }
+        while ((p < end) && ((*p == ' ') || (*p == '\t'))) {
+            p++;
+        }
+
+        used = (p < end) ? arrayNumber(p, end - p, type, data, n) : 0;
+        if (used > 0) {
+            p += used;
+            while ((p < end) && ((*p == ' ') || (*p == '\t'))) {
+                p++;
+            }
+            if ((p == end) || (*p == ',')) {
+                state->pos = p;
+                context->input_count++;
+                continue;
+            }
+        }
+
+        if (!arrayParameter(context, type, data, n)) {
+            return FALSE;
+        }
+    }
+}
+
+/**
+ * Read all remaining parameters as array of floats
+ * @param context
+ * @param data - array
+ * @param size - capacity of the array
+ * @param count - number of elements read, index of the first invalid
+ *                element on error
+ * @param mandatory - at least one element is required
+ * @return FALSE on invalid element or more elements than size
+ */
+scpi_bool_t SCPI_ParamArrayFloat(scpi_t * context, float * data, size_t size, size_t * count, scpi_bool_t mandatory) {
+    return paramArray(context, ARRAY_FLOAT, data, size, count, mandatory);
+}
+
+/**
+ * Read all remaining parameters as array of doubles
+ * @param context
+ * @param data - array
+ * @param size - capacity of the array
+ * @param count - number of elements read, index of the first invalid
+ *                element on error
+ * @param mandatory - at least one element is required
+ * @return FALSE on invalid element or more elements than size
+ */
+scpi_bool_t SCPI_ParamArrayDouble(scpi_t * context, double * data, size_t size, size_t * count, scpi_bool_t mandatory) {
+    return paramArray(context, ARRAY_DOUBLE, data, size, count, mandatory);
+}
+
+/**
+ * Read all remaining parameters as array of signed 16 bit integers
+ * @param context
+ * @param data - array
+ * @param size - capacity of the array
+ * @param count - number of elements read, index of the first invalid
+ *                element on error
+ * @param mandatory - at least one element is required
+ * @return FALSE on invalid element or more elements than size
+ */
+scpi_bool_t SCPI_ParamArrayInt16(scpi_t * context, int16_t * data, size_t size, size_t * count, scpi_bool_t mandatory) {
+    return paramArray(context, ARRAY_INT16, data, size, count, mandatory);
+}
+
+/**
+ * Read all remaining parameters as array of signed 32 bit integers
+ * @param context
+ * @param data - array
+ * @param size - capacity of the array
+ * @param count - number of elements read, index of the first invalid
+ *                element on error
+ * @param mandatory - at least one element is required
+ * @return FALSE on invalid element or more elements than size
+ */
+scpi_bool_t SCPI_ParamArrayInt32(scpi_t * context, int32_t * data, size_t size, size_t * count, scpi_bool_t mandatory) {
+    return paramArray(context, ARRAY_INT32, data, size, count, mandatory);
+}
+
+/**
+ * Read all remaining parameters as array of unsigned 64 bit integers
+ * @param context
+ * @param data - array
+ * @param size - capacity of the array
+ * @param count - number of elements read, index of the first invalid
+ *                element on error
+ * @param mandatory - at least one element is required
+ * @return FALSE on invalid element or more elements than size
+ */
+scpi_bool_t SCPI_ParamArrayUInt64(scpi_t * context, uint64_t * data, size_t size, size_t * count, scpi_bool_t mandatory) {
+    return paramArray(context, ARRAY_UINT64, data, size, count, mandatory);
+}
+
 /**
  * Parse one parameter and detect type
  * @param state
  * @param token
+ * @param suffix - beginning of suffix of decimal numeric program data
  * @return
  */
-int scpiParser_parseProgramData(lex_state_t * state, scpi_token_t * token) {
+static int parseProgramData(lex_state_t * state, scpi_token_t * token, const char ** suffix) {
     scpi_token_t tmp;
     int result = 0;
     int wsLen;
@@ -1381,42 +3251,79 @@ int scpiParser_parseProgramData(lex_state_t * state, scpi_token_t * token) {
     int realLen = 0;
     realLen += scpiLex_WhiteSpace(state, &tmp);
 
-    if (result == 0) result = scpiLex_NondecimalNumericData(state, token);
-    if (result == 0) result = scpiLex_CharacterProgramData(state, token);
-    if (result == 0) {
-        result = scpiLex_DecimalNumericProgramData(state, token);
-        if (result != 0) {
-            wsLen = scpiLex_WhiteSpace(state, &tmp);
-            suffixLen = scpiLex_SuffixProgramData(state, &tmp);
-            if (suffixLen > 0) {
-                token->len += wsLen + suffixLen;
-                token->type = SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA_WITH_SUFFIX;
-                result = token->len;
-            }
+    result = scpiLex_ProgramData(state, token);
+    if (token->type == SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA) {
+        wsLen = scpiLex_WhiteSpace(state, &tmp);
+        suffixLen = scpiLex_SuffixProgramData(state, &tmp);
+        if (suffixLen > 0) {
+            token->len += wsLen + suffixLen;
+            token->type = SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA_WITH_SUFFIX;
+            result = token->len;
+            *suffix = tmp.ptr;
+        } else {
+            realLen += wsLen;
         }
     }
 
-    if (result == 0) result = scpiLex_StringProgramData(state, token);
-    if (result == 0) result = scpiLex_ArbitraryBlockProgramData(state, token);
-    if (result == 0) result = scpiLex_ProgramExpression(state, token);
-
     realLen += scpiLex_WhiteSpace(state, &tmp);
 
     return result + realLen;
 }
 
+/**
+ * Parse one parameter and detect type
+ * @param state
+ * @param token
+ * @return
+ */
+int scpiParser_parseProgramData(lex_state_t * state, scpi_token_t * token) {
+    const char * suffix;
+
+    return parseProgramData(state, token, &suffix);
+}
+
+#if USE_PARAMETER_CACHE
+/**
+ * Remember parameter in parser state
+ * @param parser - parser state or NULL
+ * @param data - beginning of program data
+ * @param start - beginning of the parameter with white space
+ * @param token - the parameter
+ * @param suffix - beginning of suffix or NULL
+ * @param end - end of the parameter with white space
+ */
+static void rememberParameter(scpi_parser_state_t * parser, const char * data, const char * start, const scpi_token_t * token, const char * suffix, const char * end) {
+    scpi_parameter_token_t * param;
+
+    if ((parser == NULL) || (parser->parameterCount >= SCPI_PARAMETER_CACHE_SIZE) || ((end - data) > UINT16_MAX)) {
+        return;
+    }
+
+    param = &parser->parameters[parser->parameterCount++];
+    param->start = (uint16_t) (start - data);
+    param->end = (uint16_t) (end - data);
+    param->offset = (uint16_t) (token->ptr - data);
+    param->len = (uint16_t) token->len;
+    param->suffix = suffix ? (uint16_t) (suffix - data) : 0;
+    param->type = (uint8_t) token->type;
+}
+#endif /* USE_PARAMETER_CACHE */
+
 /**
  * Skip all parameters to correctly detect end of command line.
  * @param state
  * @param token
  * @param numberOfParameters
+ * @param parser - parser state to remember the parameters in or NULL
  * @return
  */
-int scpiParser_parseAllProgramData(lex_state_t * state, scpi_token_t * token, int * numberOfParameters) {
+static int parseAllProgramData(lex_state_t * state, scpi_token_t * token, int * numberOfParameters, scpi_parser_state_t * parser) {
 
     int result;
     scpi_token_t tmp;
     int paramCount = 0;
+    const char * start;
+    const char * suffix;
 
     token->len = -1;
     token->type = SCPI_TOKEN_ALL_PROGRAM_DATA;
@@ -1433,9 +3340,14 @@ int scpiParser_parseAllProgramData(lex_state_t * state, scpi_token_t * token, in
             break;
         }
 
-        result = scpiParser_parseProgramData(state, &tmp);
+        start = state->pos;
+        suffix = NULL;
+        result = parseProgramData(state, &tmp, &suffix);
         if (tmp.type != SCPI_TOKEN_UNKNOWN) {
             token->len += result;
+#if USE_PARAMETER_CACHE
+            rememberParameter(parser, token->ptr, start, &tmp, suffix, state->pos);
+#endif /* USE_PARAMETER_CACHE */
         } else {
             token->type = SCPI_TOKEN_UNKNOWN;
             token->len = 0;
@@ -1449,12 +3361,32 @@ int scpiParser_parseAllProgramData(lex_state_t * state, scpi_token_t * token, in
         token->len = 0;
     }
 
+#if USE_PARAMETER_CACHE
+    if ((parser != NULL) && (paramCount < 0)) {
+        parser->parameterCount = 0;
+    }
+#else
+    (void) parser;
+    (void) start;
+#endif /* USE_PARAMETER_CACHE */
+
     if (numberOfParameters != NULL) {
         *numberOfParameters = paramCount;
     }
     return token->len;
 }
 
+/**
+ * Skip all parameters to correctly detect end of command line.
+ * @param state
+ * @param token
+ * @param numberOfParameters
+ * @return
+ */
+int scpiParser_parseAllProgramData(lex_state_t * state, scpi_token_t * token, int * numberOfParameters) {
+    return parseAllProgramData(state, token, numberOfParameters, NULL);
+}
+
 /**
  * Skip complete command line - program header and parameters
  * @param state
@@ -1462,7 +3394,7 @@ int scpiParser_parseAllProgramData(lex_state_t * state, scpi_token_t * token, in
  * @param len
  * @return
  */
-int scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, char * buffer, int len) {
+int scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, const char * buffer, int len) {
     lex_state_t lex_state;
     scpi_token_t tmp;
     int result = 0;
@@ -1470,13 +3402,16 @@ int scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, char * buff
     lex_state.buffer = lex_state.pos = buffer;
     lex_state.len = len;
     state->numberOfParameters = 0;
+#if USE_PARAMETER_CACHE
+    state->parameterCount = 0;
+#endif /* USE_PARAMETER_CACHE */
 
     /* ignore whitespace at the begginig */
     scpiLex_WhiteSpace(&lex_state, &tmp);
 
     if (scpiLex_ProgramHeader(&lex_state, &state->programHeader) >= 0) {
         if (scpiLex_WhiteSpace(&lex_state, &tmp) > 0) {
-            scpiParser_parseAllProgramData(&lex_state, &state->programData, &state->numberOfParameters);
+            parseAllProgramData(&lex_state, &state->programData, &state->numberOfParameters, state);
         } else {
             invalidateToken(&state->programData, lex_state.pos);
         }
@@ -1490,6 +3425,8 @@ int scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, char * buff
 
     if (!scpiLex_IsEos(&lex_state) && (result == 0)) {
         lex_state.pos++;
+        /* skip the rest of invalid program message unit */
+        lex_state.pos += scanTerminator(lex_state.pos, lex_state.buffer + lex_state.len - lex_state.pos);
 
         state->programHeader.len = 1;
         state->programHeader.type = SCPI_TOKEN_INVALID;
@@ -1509,6 +3446,23 @@ int scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, char * buff
 }
 
 
+/**
+ * Compiled pattern of current command, compiled on first use
+ * @param context
+ * @return compiled pattern or NULL if it can't be compiled
+ */
+static const scpi_pattern_t * currentPattern(scpi_t * context) {
+    const char * pattern = context->param_list.cmd->pattern;
+
+    if (context->cmd_pattern.pattern != pattern) {
+        if (!SCPI_PatternCompile(&context->cmd_pattern, pattern)) {
+            return NULL;
+        }
+    }
+
+    return &context->cmd_pattern;
+}
+
 /**
  * Check current command
  *  - suitable for one handle to multiple commands
@@ -1517,14 +3471,18 @@ int scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, char * buff
  * @return
  */
 scpi_bool_t SCPI_IsCmd(scpi_t * context, const char * cmd) {
-    const char * pattern;
+    const scpi_pattern_t * compiled;
 
     if (!context->param_list.cmd) {
         return FALSE;
     }
 
-    pattern = context->param_list.cmd->pattern;
-    return matchCommand(pattern, cmd, strlen(cmd), NULL, 0, 0);
+    compiled = currentPattern(context);
+    if (compiled) {
+        return SCPI_PatternMatch(compiled, cmd, strlen(cmd), NULL, 0, 0);
+    }
+
+    return matchCommand(context->param_list.cmd->pattern, cmd, strlen(cmd), NULL, 0, 0);
 }
 
 #if USE_COMMAND_TAGS
@@ -1542,12 +3500,205 @@ int32_t SCPI_CmdTag(scpi_t * context) {
 }
 #endif /* USE_COMMAND_TAGS */
 
+/**
+ * Return ID of current command
+ *
+ * ID is the position of the command in context->cmdlist, so IDs are dense
+ * and can be used to index tables or in switch statements.
+ *
+ * @param context
+ * @return ID of command or -1 if there is no current command
+ */
+int32_t SCPI_CmdId(scpi_t * context) {
+    if (context->param_list.cmd && context->param_list.table) {
+        return (int32_t) (context->param_list.cmd - context->param_list.table->cmdlist);
+    } else if (context->param_list.cmd && context->cmdlist) {
+        return (int32_t) (context->param_list.cmd - context->cmdlist);
+    } else {
+        return -1;
+    }
+}
+
+/**
+ * Return command table of current command
+ * @param context
+ * @return table attached by SCPI_CommandTableAdd() or NULL if the command
+ * is from context->cmdlist or there is no current command
+ */
+const scpi_command_table_t * SCPI_CmdTable(scpi_t * context) {
+    if (context->param_list.cmd) {
+        return context->param_list.table;
+    } else {
+        return NULL;
+    }
+}
+
+/**
+ * Attach command list to the context at runtime
+ *
+ * Commands of the list are accepted after all keywords of the prefix,
+ * e.g. "VOLTage?" with prefix "SLOT2" is called for "SLOT2:VOLT?". The
+ * prefix has only mandatory keywords without numeric suffixes, NULL or ""
+ * attaches the commands to the root. The context command list is searched
+ * first, then tables in order they were added.
+ *
+ * The table is initialized here and table->cmdindex is always reset to
+ * NULL, also when the same table is added again after removal. An index
+ * of the list, built by SCPI_CommandIndexBuild(), is used only if it is
+ * installed to table->cmdindex after every successful call. Nothing else
+ * is built or copied, so other contexts are not affected at all.
+ *
+ * @param context
+ * @param table - storage for the table, valid until it is removed
+ * @param cmdlist - command list terminated by SCPI_CMD_LIST_END
+ * @param prefix - prefix of all commands in the list, must stay valid
+ * @return TRUE if successful, FALSE if prefix is malformed or table is already added
+ */
+scpi_bool_t SCPI_CommandTableAdd(scpi_t * context, scpi_command_table_t * table, const scpi_command_t * cmdlist, const char * prefix) {
+    scpi_command_table_t ** link;
+    uint8_t i;
+
+    if ((table == NULL) || (cmdlist == NULL)) {
+        return FALSE;
+    }
+
+    for (link = &context->tables; *link != NULL; link = &(*link)->next) {
+        if (*link == table) {
+            return FALSE;
+        }
+    }
+
+    if (!SCPI_PatternCompile(&table->prefix, prefix ? prefix : "") || table->prefix.query || table->prefix.group_count) {
+        return FALSE;
+    }
+
+    for (i = 0; i < table->prefix.count; i++) {
+        if (table->prefix.keywords[i].slot >= 0) {
+            return FALSE;
+        }
+    }
+
+    table->cmdlist = cmdlist;
+    table->cmdindex = NULL;
+    table->next = NULL;
+    *link = table;
+
+#if USE_DISPATCH_CACHE || USE_MESSAGE_CACHE
+    scpiCache_Invalidate(context);
+#endif
+
+    return TRUE;
+}
+
+/**
+ * Detach command list attached by SCPI_CommandTableAdd()
+ * @param context
+ * @param table
+ * @return TRUE if successful, FALSE if table was not attached to the context
+ */
+scpi_bool_t SCPI_CommandTableRemove(scpi_t * context, scpi_command_table_t * table) {
+    scpi_command_table_t ** link;
+
+    for (link = &context->tables; *link != NULL; link = &(*link)->next) {
+        if (*link == table) {
+            *link = table->next;
+            table->next = NULL;
+
+            if (context->param_list.table == table) {
+                context->param_list.cmd = NULL;
+                context->param_list.table = NULL;
+            }
+
+#if USE_DISPATCH_CACHE || USE_MESSAGE_CACHE
+            scpiCache_Invalidate(context);
+#endif
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Find ID of the pattern in command list
+ * @param cmdlist - command list terminated by SCPI_CMD_LIST_END
+ * @param pattern - pattern exactly as written in command list
+ * @return ID of command or -1 if the pattern is not in command list
+ */
+int32_t SCPI_CommandId(const scpi_command_t * cmdlist, const char * pattern) {
+    int32_t i;
+
+    for (i = 0; cmdlist[i].pattern != NULL; i++) {
+        if (strcmp(cmdlist[i].pattern, pattern) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
 scpi_bool_t SCPI_Match(const char * pattern, const char * value, size_t len) {
+    scpi_pattern_t compiled;
+
+    if (SCPI_PatternCompile(&compiled, pattern)) {
+        return SCPI_PatternMatch(&compiled, value, len, NULL, 0, 0);
+    }
+
     return matchCommand(pattern, value, len, NULL, 0, 0);
 }
 
+/**
+ * Get numeric suffixes of current command
+ *
+ * Suffixes are captured while the command is resolved, so this is just a
+ * copy unless more than SCPI_COMMAND_NUMBERS suffixes are requested.
+ *
+ * @param context
+ * @param numbers - storage for suffixes, in order of '#' in the pattern
+ * @param len - length of numbers storage
+ * @param default_value - value of suffix not present in command
+ * @return TRUE if there is current command
+ */
 scpi_bool_t SCPI_CommandNumbers(scpi_t * context, int32_t * numbers, size_t len, int32_t default_value) {
-    return matchCommand(context->param_list.cmd->pattern, context->param_list.cmd_raw.data, context->param_list.cmd_raw.length, numbers, len, default_value);
+    const scpi_pattern_t * compiled;
+    size_t i;
+
+    if (!context->param_list.cmd) {
+        for (i = 0; i < len; i++) {
+            numbers[i] = default_value;
+        }
+        return FALSE;
+    }
+
+    if (len > SCPI_COMMAND_NUMBERS) {
+        compiled = currentPattern(context);
+        if (compiled) {
+            return matchHeader(compiled, &context->param_list.header, numbers, len, default_value, NULL);
+        }
+    }
+
+    for (i = 0; i < len; i++) {
+        numbers[i] = SCPI_CommandNumber(context, i, default_value);
+    }
+
+    return TRUE;
+}
+
+/**
+ * Get one numeric suffix of current command
+ * @param context
+ * @param index - order of '#' in the pattern, less than SCPI_COMMAND_NUMBERS
+ * @param default_value - value of suffix not present in command
+ * @return suffix or default_value
+ */
+int32_t SCPI_CommandNumber(scpi_t * context, size_t index, int32_t default_value) {
+    const scpi_command_numbers_t * numbers = &context->param_list.numbers;
+
+    if (context->param_list.cmd && (index < SCPI_COMMAND_NUMBERS) && (numbers->given & (1UL << index))) {
+        return numbers->values[index];
+    }
+
+    return default_value;
 }
 
 /**
@@ -45,7 +45,8 @@ extern "C" {
 
     int scpiParser_parseProgramData(lex_state_t * state, scpi_token_t * token) LOCAL;
     int scpiParser_parseAllProgramData(lex_state_t * state, scpi_token_t * token, int * numberOfParameters) LOCAL;
-    int scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, char * buffer, int len) LOCAL;
+    int scpiParser_detectProgramMessageUnit(scpi_parser_state_t * state, const char * buffer, int len) LOCAL;
+    scpi_bool_t scpiParser_parameterSuffix(scpi_t * context, const scpi_parameter_t * parameter, scpi_token_t * suffix) LOCAL;
 
 #ifdef	__cplusplus
 }
@@ -77,9 +77,9 @@ arbitraryBlockProgramData
 	;
 		
 PROGRAM_MNEMONIC	: 	ALPHA (ALPHA | DIGIT | UNDERSCORE)*;
-HEXNUM			:	SHARP H HEXDIGIT*;
-BINNUM			:	SHARP Q OCTDIGIT*;
-OCTNUM			:	SHARP B BINDIGIT*;
+HEXNUM			:	SHARP H HEXDIGIT+;
+OCTNUM			:	SHARP Q OCTDIGIT+;
+BINNUM			:	SHARP B BINDIGIT+;
 UNDERSCORE		:	'_';
 SEMICOLON 		:	';';
 QUESTION		:	'?';
@@ -90,7 +90,7 @@ NL			:	'\r'? '\n' ;
 WS  			:   	(SPACE | TAB);
 
 DECIMAL_NUMERIC_PROGRAM_DATA_WITH_SUFFIX	:	DECIMAL_NUMERIC_PROGRAM_DATA WS* (SUFFIX_PROGRAM_DATA)?;
-fragment DECIMAL_NUMERIC_PROGRAM_DATA	:	MANTISA WS* (EXPONENT)?;
+fragment DECIMAL_NUMERIC_PROGRAM_DATA	:	MANTISA (WS* EXPONENT)?;
 SINGLE_QUOTE_PROGRAM_DATA	:	SINGLE_QUOTE ( (NON_SINGLE_QUOTE) | (SINGLE_QUOTE SINGLE_QUOTE))* SINGLE_QUOTE;
 DOUBLE_QUOTE_PROGRAM_DATA	:	DOUBLE_QUOTE ( (NON_DOUBLE_QUOTE) | (DOUBLE_QUOTE DOUBLE_QUOTE))* DOUBLE_QUOTE;
 //SUFFIX_PROGRAM_DATA	:	SLASH? (ALPHA+ (MINUS? DIGIT)?) ((SLASH | DOT) (ALPHA+ (MINUS? DIGIT)?))*;	
@@ -98,7 +98,7 @@ fragment SUFFIX_PROGRAM_DATA	:	SLASH? ALPHA+ ((SLASH | DOT) ALPHA+)*;
 //fragment SUFFIX_PROGRAM_DATA	:	ALPHA+;	
 
 fragment PROGRAM_EXPRESSION_CHARACTER	: 	(SPACE | '!' | '$'..'&' | '*'..':' | '<' ..'~');
-PROGRAM_EXPRESSION	:	LBRACKET PROGRAM_EXPRESSION_CHARACTER RBRACKET;
+PROGRAM_EXPRESSION	:	LBRACKET PROGRAM_EXPRESSION_CHARACTER* RBRACKET;
 	
 fragment PLUSMN		:	(PLUS | MINUS);
 fragment MANTISA	:	PLUSMN? ( (NUMBER) | (NUMBER DOT NUMBER?) | (DOT NUMBER));
@@ -135,7 +135,8 @@ fragment DOT		:	'.';
 fragment SLASH		:	'/';
 fragment SINGLE_QUOTE	:	'\'';
 fragment DOUBLE_QUOTE	:	'"';
-fragment NON_SINGLE_QUOTE 	:	~SINGLE_QUOTE;
-fragment NON_DOUBLE_QUOTE 	:	~DOUBLE_QUOTE;
+fragment NON_SINGLE_QUOTE 	:	~(SINGLE_QUOTE | NON_ASCII);
+fragment NON_DOUBLE_QUOTE 	:	~(DOUBLE_QUOTE | NON_ASCII);
+fragment NON_ASCII	:	('\u0080'..'\u00FF');
 
 
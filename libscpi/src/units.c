@@ -42,6 +42,7 @@
 #include "scpi/utils.h"
 #include "scpi/error.h"
 #include "lexer_private.h"
+#include "parser_private.h"
 
 
 /*
@@ -286,9 +287,11 @@ scpi_bool_t SCPI_ParamNumber(scpi_t * context, const scpi_choice_def_t * special
             SCPI_ParamToDouble(context, &param, &(value->value));
             break;
         case SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA_WITH_SUFFIX:
-            scpiLex_DecimalNumericProgramData(&state, &token);
-            scpiLex_WhiteSpace(&state, &token);
-            scpiLex_SuffixProgramData(&state, &token);
+            if (!scpiParser_parameterSuffix(context, &param, &token)) {
+                scpiLex_DecimalNumericProgramData(&state, &token);
+                scpiLex_WhiteSpace(&state, &token);
+                scpiLex_SuffixProgramData(&state, &token);
+            }
 
             SCPI_ParamToDouble(context, &param, &(value->value));
 
@@ -44,6 +44,14 @@
 #include "utils_private.h"
 #include "scpi/utils.h"
 
+#if HAVE_AVX2
+#include <immintrin.h>
+#elif HAVE_SSE2
+#include <emmintrin.h>
+#elif HAVE_NEON
+#include <arm_neon.h>
+#endif
+
 static size_t patternSeparatorShortPos(const char * pattern, size_t len);
 static size_t patternSeparatorPos(const char * pattern, size_t len);
 static size_t cmdSeparatorPos(const char * cmd, size_t len);
@@ -281,75 +289,328 @@ size_t SCPI_DoubleToStr(double val, char * str, size_t len) {
 }
 
 /**
- * Converts string to signed 32bit integer representation
- * @param str   string value
- * @param val   32bit integer result
- * @return      number of bytes used in string
+ * Load 8 characters, the first one to the lowest byte
+ * @param str
+ * @return characters
  */
-size_t strBaseToInt32(const char * str, int32_t * val, int8_t base) {
-    char * endptr;
-    *val = strtol(str, &endptr, base);
-    return endptr - str;
+static uint64_t load8(const char * str) {
+    uint64_t w = 0;
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    memcpy(&w, str, sizeof (w));
+#else
+    int i;
+
+    for (i = 7; i >= 0; i--) {
+        w = (w << 8) | (uint8_t) str[i];
+    }
+#endif
+    return w;
 }
 
 /**
- * Converts string to unsigned 32bit integer representation
- * @param str   string value
- * @param val   32bit integer result
- * @return      number of bytes used in string
+ * Value of digit in given base
+ * @param c - character
+ * @param base - 2, 8, 10 or 16
+ * @return value of the digit or base if c is not a digit
  */
-size_t strBaseToUInt32(const char * str, uint32_t * val, int8_t base) {
-    char * endptr;
-    *val = strtoul(str, &endptr, base);
-    return endptr - str;
+static unsigned digitValue(char c, int8_t base) {
+    unsigned value;
+
+    if ((c >= '0') && (c <= '9')) {
+        value = (unsigned) (c - '0');
+    } else if ((c >= 'a') && (c <= 'f')) {
+        value = (unsigned) (c - 'a' + 10);
+    } else if ((c >= 'A') && (c <= 'F')) {
+        value = (unsigned) (c - 'A' + 10);
+    } else {
+        return (unsigned) base;
+    }
+
+    return (value < (unsigned) base) ? value : (unsigned) base;
 }
 
+#define BYTES(x) (UINT64_C(0x0101010101010101) * (x))
+
 /**
- * Converts string to signed 64bit integer representation
- * @param str   string value
- * @param val   64bit integer result
- * @return      number of bytes used in string
+ * Mask of 7-bit characters in range [lo, hi], 0x80 in each such byte
+ * @param w - characters
+ * @param lo
+ * @param hi
+ * @return mask
  */
-size_t strBaseToInt64(const char * str, int64_t * val, int8_t base) {
-    char * endptr;
-    *val = strtol(str, &endptr, base);
-    return endptr - str;
+static uint64_t bytesInRange(uint64_t w, uint8_t lo, uint8_t hi) {
+    return (w + BYTES(0x80 - lo)) & ~(w + BYTES(0x7F - hi)) & BYTES(0x80);
 }
 
 /**
- * Converts string to unsigned 64bit integer representation
- * @param str   string value
- * @param val   64bit integer result
- * @return      number of bytes used in string
+ * Test if all 8 characters are digits in given base
+ * @param w - characters loaded by load8
+ * @param base - 2, 8, 10 or 16
+ * @return TRUE if all are digits
+ */
+static scpi_bool_t isDigits8(uint64_t w, int8_t base) {
+    switch (base) {
+        case 2:
+            return (w & BYTES(0xFE)) == BYTES(0x30);
+        case 8:
+            return (w & BYTES(0xF8)) == BYTES(0x30);
+        case 10:
+            return ((w & BYTES(0xF0)) == BYTES(0x30))
+                    && (((w + BYTES(0x06)) & BYTES(0xF0)) == BYTES(0x30));
+        default:
+            if (w & BYTES(0x80)) {
+                return FALSE;
+            }
+            w |= BYTES(0x20);
+            return (bytesInRange(w, '0', '9') | bytesInRange(w, 'a', 'f')) == BYTES(0x80);
+    }
+}
+
+/**
+ * Convert 8 digits at once
+ * @param w - digits loaded by load8
+ * @param base - 2, 8, 10 or 16
+ * @return value of the digits
+ */
+static uint32_t digits8(uint64_t w, int8_t base) {
+    switch (base) {
+        case 2:
+            return (uint32_t) (((w & BYTES(0x01)) * UINT64_C(0x8040201008040201)) >> 56);
+        case 8:
+            w &= BYTES(0x07);
+            w = ((w & UINT64_C(0x0700070007000700)) >> 8) | ((w & UINT64_C(0x0007000700070007)) << 3);
+            w = ((w & UINT64_C(0x0000003F0000003F)) << 6) | ((w & UINT64_C(0x003F0000003F0000)) >> 16);
+            return (uint32_t) (((w & 0xFFF) << 12) | ((w >> 32) & 0xFFF));
+        case 10:
+            w &= BYTES(0x0F);
+            w = (w * 10 + (w >> 8)) & UINT64_C(0x00FF00FF00FF00FF);
+            w = (w * 100 + (w >> 16)) & UINT64_C(0x0000FFFF0000FFFF);
+            return (uint32_t) ((w * 10000 + (w >> 32)) & 0xFFFFFFFF);
+        default:
+            /* hexadecimal, letters have bit 6 set */
+            w = (w & BYTES(0x0F)) + 9 * ((w >> 6) & BYTES(0x01));
+            w = ((w & UINT64_C(0x0F000F000F000F00)) >> 8) | ((w & UINT64_C(0x000F000F000F000F)) << 4);
+            w = ((w & UINT64_C(0x000000FF000000FF)) << 8) | ((w & UINT64_C(0x00FF000000FF0000)) >> 16);
+            return (uint32_t) (((w & 0xFFFF) << 16) | ((w >> 32) & 0xFFFF));
+    }
+}
+
+/**
+ * Converts string to unsigned 64bit integer, sign is returned separately
+ *
+ * Leading white space and sign are skipped. Digits are converted eight at
+ * once while they are available.
+ *
+ * @param str       string value
+ * @param len       length of string
+ * @param val       absolute value, UINT64_MAX on overflow
+ * @param base      2, 8, 10 or 16
+ * @param negative  TRUE if there was minus sign
+ * @param overflow  TRUE if the value does not fit
+ * @return          number of bytes used in string
+ */
+static size_t strBaseToMagnitude(const char * str, size_t len, uint64_t * val, int8_t base, scpi_bool_t * negative, scpi_bool_t * overflow) {
+    /* multiplier of 8 digits and the largest values which can be
+     * multiplied without overflow, the limits only by digits up to the
+     * remainders */
+    static const struct {
+        uint64_t chunk_mul;
+        uint64_t chunk_limit;
+        uint64_t chunk_rem;
+        uint64_t limit;
+        uint64_t rem;
+    } limits[] = {
+        {256, UINT64_C(0xFFFFFFFFFFFFFF), 255, UINT64_C(0x7FFFFFFFFFFFFFFF), 1},
+        {UINT64_C(0x1000000), UINT64_C(0xFFFFFFFFFF), UINT64_C(0xFFFFFF), UINT64_C(0x1FFFFFFFFFFFFFFF), 7},
+        {100000000, UINT64_C(184467440737), 9551615, UINT64_C(1844674407370955161), 5},
+        {UINT64_C(0x100000000), UINT64_C(0xFFFFFFFF), UINT64_C(0xFFFFFFFF), UINT64_C(0xFFFFFFFFFFFFFFF), 15},
+    };
+    uint64_t value = 0;
+    scpi_bool_t over = FALSE;
+    uint64_t digit;
+    uint64_t w;
+    size_t i = 0;
+    size_t start;
+    size_t b;
+
+    *val = 0;
+    *negative = FALSE;
+    *overflow = FALSE;
+
+    while ((i < len) && ((str[i] == ' ') || (str[i] == '\t'))) {
+        i++;
+    }
+    if ((i < len) && ((str[i] == '+') || (str[i] == '-'))) {
+        *negative = str[i] == '-';
+        i++;
+    }
+    start = i;
+
+    switch (base) {
+        case 2: b = 0;
+            break;
+        case 8: b = 1;
+            break;
+        case 10: b = 2;
+            break;
+        default: b = 3;
+            break;
+    }
+
+    for (;;) {
+        if ((i + 8 <= len) && isDigits8(w = load8(str + i), base)) {
+            digit = digits8(w, base);
+            if ((value > limits[b].chunk_limit) || ((value == limits[b].chunk_limit) && (digit > limits[b].chunk_rem))) {
+                over = TRUE;
+            }
+            value = value * limits[b].chunk_mul + digit;
+            i += 8;
+        } else if ((i < len) && ((digit = digitValue(str[i], base)) < (unsigned) base)) {
+            if ((value > limits[b].limit) || ((value == limits[b].limit) && (digit > limits[b].rem))) {
+                over = TRUE;
+            }
+            value = value * (uint64_t) base + digit;
+            i++;
+        } else {
+            break;
+        }
+    }
+
+    if (i == start) {
+        /* no digit, nothing is used */
+        *val = 0;
+        *negative = FALSE;
+        *overflow = FALSE;
+        return 0;
+    }
+
+    *val = over ? UINT64_C(0xFFFFFFFFFFFFFFFF) : value;
+    *overflow = over;
+
+    return i;
+}
+
+/**
+ * Converts string to signed integer in range [-min, max]
+ * @param str       string value
+ * @param len       length of string
+ * @param val       result, saturated on overflow
+ * @param base      2, 8, 10 or 16
+ * @param max       largest positive value
+ * @param min       magnitude of the most negative value
+ * @param overflow  TRUE if the value is out of range
+ * @return          number of bytes used in string
  */
-size_t strBaseToUInt64(const char * str, uint64_t * val, int8_t base) {
-    char * endptr;
-    *val = strtoull(str, &endptr, base);
-    return endptr - str;
+static size_t strBaseToSigned(const char * str, size_t len, int64_t * val, int8_t base, uint64_t max, uint64_t min, scpi_bool_t * overflow) {
+    uint64_t magnitude;
+    scpi_bool_t negative;
+    size_t used;
+
+    used = strBaseToMagnitude(str, len, &magnitude, base, &negative, overflow);
+    if (used == 0) {
+        *val = 0;
+        return 0;
+    }
+
+    if (negative) {
+        if (*overflow || (magnitude > min)) {
+            *overflow = TRUE;
+            magnitude = min;
+        }
+        *val = (magnitude == 0) ? 0 : -(int64_t) (magnitude - 1) - 1;
+    } else {
+        if (*overflow || (magnitude > max)) {
+            *overflow = TRUE;
+            magnitude = max;
+        }
+        *val = (int64_t) magnitude;
+    }
+
+    return used;
+}
+
+/**
+ * Converts string to unsigned integer in range [0, max]
+ * @param str       string value
+ * @param len       length of string
+ * @param val       result, saturated on overflow
+ * @param base      2, 8, 10 or 16
+ * @param max       largest value
+ * @param overflow  TRUE if the value is out of range
+ * @return          number of bytes used in string
+ */
+static size_t strBaseToUnsigned(const char * str, size_t len, uint64_t * val, int8_t base, uint64_t max, scpi_bool_t * overflow) {
+    scpi_bool_t negative;
+    size_t used;
+
+    used = strBaseToMagnitude(str, len, val, base, &negative, overflow);
+    if (negative && (*val != 0)) {
+        *overflow = TRUE;
+        *val = 0;
+    } else if (*overflow || (*val > max)) {
+        *overflow = TRUE;
+        *val = max;
+    }
+
+    return used;
 }
 
 /**
- * Converts string to float (32 bit) representation
- * @param str   string value
- * @param val   float result
- * @return      number of bytes used in string
+ * Converts string to signed 32bit integer representation
+ * @param str       string value
+ * @param len       length of string
+ * @param val       32bit integer result
+ * @param base      2, 8, 10 or 16
+ * @param overflow  TRUE if the value does not fit, val is saturated
+ * @return          number of bytes used in string
  */
-size_t strToFloat(const char * str, float * val) {
-    char * endptr;
-    *val = strtof(str, &endptr);
-    return endptr - str;
+size_t strBaseToInt32(const char * str, size_t len, int32_t * val, int8_t base, scpi_bool_t * overflow) {
+    int64_t tmp;
+    size_t used = strBaseToSigned(str, len, &tmp, base, INT32_MAX, (uint64_t) INT32_MAX + 1, overflow);
+    *val = (int32_t) tmp;
+    return used;
 }
 
 /**
- * Converts string to double (64 bit) representation
- * @param str   string value
- * @param val   double result
- * @return      number of bytes used in string
+ * Converts string to unsigned 32bit integer representation
+ * @param str       string value
+ * @param len       length of string
+ * @param val       32bit integer result
+ * @param base      2, 8, 10 or 16
+ * @param overflow  TRUE if the value does not fit, val is saturated
+ * @return          number of bytes used in string
+ */
+size_t strBaseToUInt32(const char * str, size_t len, uint32_t * val, int8_t base, scpi_bool_t * overflow) {
+    uint64_t tmp;
+    size_t used = strBaseToUnsigned(str, len, &tmp, base, UINT32_MAX, overflow);
+    *val = (uint32_t) tmp;
+    return used;
+}
+
+/**
+ * Converts string to signed 64bit integer representation
+ * @param str       string value
+ * @param len       length of string
+ * @param val       64bit integer result
+ * @param base      2, 8, 10 or 16
+ * @param overflow  TRUE if the value does not fit, val is saturated
+ * @return          number of bytes used in string
  */
-size_t strToDouble(const char * str, double * val) {
-    char * endptr;
-    *val = strtod(str, &endptr);
-    return endptr - str;
+size_t strBaseToInt64(const char * str, size_t len, int64_t * val, int8_t base, scpi_bool_t * overflow) {
+    return strBaseToSigned(str, len, val, base, INT64_MAX, (uint64_t) INT64_MAX + 1, overflow);
+}
+
+/**
+ * Converts string to unsigned 64bit integer representation
+ * @param str       string value
+ * @param len       length of string
+ * @param val       64bit integer result
+ * @param base      2, 8, 10 or 16
+ * @param overflow  TRUE if the value does not fit, val is saturated
+ * @return          number of bytes used in string
+ */
+size_t strBaseToUInt64(const char * str, size_t len, uint64_t * val, int8_t base, scpi_bool_t * overflow) {
+    return strBaseToUnsigned(str, len, val, base, UINT64_C(0xFFFFFFFFFFFFFFFF), overflow);
 }
 
 /**
@@ -372,6 +633,317 @@ scpi_bool_t compareStr(const char * str1, size_t len1, const char * str2, size_t
     return FALSE;
 }
 
+/**
+ * Convert ASCII lowercase letters in 8 bytes to uppercase
+ * @param x - 8 characters
+ * @return converted characters
+ */
+static uint64_t upperCase8(uint64_t x) {
+    uint64_t heptets = x & UINT64_C(0x7F7F7F7F7F7F7F7F);
+    /* bit 7 of each byte is set for 'a' <= byte <= 'z' */
+    uint64_t lower = ((heptets + UINT64_C(0x1F1F1F1F1F1F1F1F)) ^ (heptets + UINT64_C(0x0505050505050505))) & ~x & UINT64_C(0x8080808080808080);
+    return x ^ (lower >> 2);
+}
+
+/**
+ * Copy string and convert ASCII lowercase letters to uppercase
+ *
+ * Independent of locale. Uses SSE2 or NEON if available.
+ *
+ * @param dst - destination, may be the same as src
+ * @param src - source
+ * @param len - number of characters
+ */
+void upperCase(char * dst, const char * src, size_t len) {
+    uint64_t x;
+    char c;
+
+#if HAVE_SSE2
+    __m128i v;
+    __m128i lower;
+
+    for (; len >= 16; len -= 16, src += 16, dst += 16) {
+        v = _mm_loadu_si128((const __m128i *) src);
+        lower = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('z' + 1)));
+        v = _mm_sub_epi8(v, _mm_and_si128(lower, _mm_set1_epi8(0x20)));
+        _mm_storeu_si128((__m128i *) dst, v);
+    }
+#elif HAVE_NEON
+    uint8x16_t v;
+    uint8x16_t lower;
+
+    for (; len >= 16; len -= 16, src += 16, dst += 16) {
+        v = vld1q_u8((const uint8_t *) src);
+        lower = vcleq_u8(vsubq_u8(v, vdupq_n_u8('a')), vdupq_n_u8('z' - 'a'));
+        v = vsubq_u8(v, vandq_u8(lower, vdupq_n_u8(0x20)));
+        vst1q_u8((uint8_t *) dst, v);
+    }
+#endif
+
+    for (; len >= 8; len -= 8, src += 8, dst += 8) {
+        memcpy(&x, src, 8);
+        x = upperCase8(x);
+        memcpy(dst, &x, 8);
+    }
+
+    for (; len > 0; len--) {
+        c = *src++;
+        *dst++ = ((c >= 'a') && (c <= 'z')) ? (c - 'a' + 'A') : c;
+    }
+}
+
+/**
+ * Test if character is structural, see scanStructural
+ * @param c
+ * @return TRUE if c is structural
+ */
+static scpi_bool_t isStructural(char c) {
+    switch (c) {
+        case '\r':
+        case '\n':
+        case ';':
+        case ',':
+        case '"':
+        case '\'':
+        case '#':
+            return TRUE;
+        default:
+            return (uint8_t) c >= 0x80;
+    }
+}
+
+#if HAVE_AVX2
+static uint64_t structural32(const char * data) {
+    __m256i v = _mm256_loadu_si256((const __m256i *) data);
+    __m256i m;
+
+    m = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+    m = _mm256_or_si256(m, _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(';')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+    m = _mm256_or_si256(m, _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\''))));
+    m = _mm256_or_si256(m, _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('#')), v));
+
+    return (uint32_t) _mm256_movemask_epi8(m);
+}
+#elif HAVE_SSE2
+static uint64_t structural16(const char * data) {
+    __m128i v = _mm_loadu_si128((const __m128i *) data);
+    __m128i m;
+
+    m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+    m = _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(';')), _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+    m = _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\''))));
+    m = _mm_or_si128(m, _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('#')), v));
+
+    return (uint32_t) _mm_movemask_epi8(m);
+}
+#elif HAVE_NEON
+static uint64_t structural16(const char * data) {
+    static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t v = vld1q_u8((const uint8_t *) data);
+    uint8x16_t m;
+    uint8x8_t sum;
+
+    m = vorrq_u8(vceqq_u8(v, vdupq_n_u8('\r')), vceqq_u8(v, vdupq_n_u8('\n')));
+    m = vorrq_u8(m, vorrq_u8(vceqq_u8(v, vdupq_n_u8(';')), vceqq_u8(v, vdupq_n_u8(','))));
+    m = vorrq_u8(m, vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\''))));
+    m = vorrq_u8(m, vorrq_u8(vceqq_u8(v, vdupq_n_u8('#')), vcgeq_u8(v, vdupq_n_u8(0x80))));
+
+    /* one bit per byte, like movemask */
+    m = vandq_u8(m, vld1q_u8(weights));
+    sum = vpadd_u8(vget_low_u8(m), vget_high_u8(m));
+    sum = vpadd_u8(sum, sum);
+    sum = vpadd_u8(sum, sum);
+
+    return vget_lane_u8(sum, 0) | ((uint64_t) vget_lane_u8(sum, 1) << 8);
+}
+#endif
+
+/**
+ * Find structural characters in a chunk of input
+ *
+ * Structural characters are program message terminators and separators
+ * ('\r', '\n', ';', ','), quotes and '#'. Bytes above 0x7F are reported
+ * too, because they can not be part of string program data.
+ *
+ * Uses AVX2, SSE2 or NEON if available.
+ *
+ * @param data - input
+ * @param len - length of input, at most 64 characters are scanned
+ * @return bitmap, bit i is set if data[i] is structural
+ */
+uint64_t scanStructural(const char * data, size_t len) {
+    uint64_t bits = 0;
+    size_t i = 0;
+
+    if (len > 64) {
+        len = 64;
+    }
+
+#if HAVE_AVX2
+    for (; i + 32 <= len; i += 32) {
+        bits |= structural32(data + i) << i;
+    }
+#elif HAVE_SSE2 || HAVE_NEON
+    for (; i + 16 <= len; i += 16) {
+        bits |= structural16(data + i) << i;
+    }
+#endif
+
+    for (; i < len; i++) {
+        if (isStructural(data[i])) {
+            bits |= (uint64_t) 1 << i;
+        }
+    }
+
+    return bits;
+}
+
+/**
+ * Position of the lowest set bit
+ * @param bits - nonzero bitmap
+ * @return index of the bit
+ */
+static size_t lowestBit(uint64_t bits) {
+#if defined(__GNUC__)
+    return (size_t) __builtin_ctzll(bits);
+#else
+    size_t i = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+/**
+ * Find next structural character, see scanStructural
+ * @param data - input
+ * @param len - length of input
+ * @return position of the character or len if there is none
+ */
+size_t scanStructuralNext(const char * data, size_t len) {
+    uint64_t bits;
+    size_t pos;
+
+    for (pos = 0; pos < len; pos += 64) {
+        bits = scanStructural(data + pos, len - pos);
+        if (bits) {
+            return pos + lowestBit(bits);
+        }
+    }
+
+    return len;
+}
+
+/**
+ * Find next program message terminator or program message unit separator
+ * @param data - input
+ * @param len - length of input
+ * @return position of '\r', '\n' or ';' or len if there is none
+ */
+size_t scanTerminator(const char * data, size_t len) {
+    uint64_t bits;
+    size_t pos;
+    size_t i;
+
+    for (pos = 0; pos < len; pos += 64) {
+        bits = scanStructural(data + pos, len - pos);
+        while (bits) {
+            i = pos + lowestBit(bits);
+            if ((data[i] == '\r') || (data[i] == '\n') || (data[i] == ';')) {
+                return i;
+            }
+            bits &= bits - 1;
+        }
+    }
+
+    return len;
+}
+
+/**
+ * Compare pattern with upper-cased keyword of the same length
+ * @param pattern - pattern in any case
+ * @param keyword - upper-cased keyword
+ * @param len - number of characters
+ * @return TRUE if equal
+ */
+static scpi_bool_t compareUpper(const char * pattern, const char * keyword, size_t len) {
+    uint64_t a;
+    uint64_t b;
+    char c;
+
+    for (; len >= 8; len -= 8, pattern += 8, keyword += 8) {
+        memcpy(&a, pattern, 8);
+        memcpy(&b, keyword, 8);
+        if (upperCase8(a) != b) {
+            return FALSE;
+        }
+    }
+
+    for (; len > 0; len--) {
+        c = *pattern++;
+        if ((((c >= 'a') && (c <= 'z')) ? (c - 'a' + 'A') : c) != *keyword++) {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/**
+ * Compare pattern keyword with upper-cased header keyword
+ * @param pattern
+ * @param pattern_len
+ * @param keyword - keyword upper-cased by foldHeader
+ * @param keyword_len
+ * @return TRUE if lengths and characters are equal
+ */
+scpi_bool_t compareKeyword(const char * pattern, size_t pattern_len, const char * keyword, size_t keyword_len) {
+    return (pattern_len == keyword_len) && compareUpper(pattern, keyword, pattern_len);
+}
+
+/**
+ * Compare pattern keyword with upper-cased header keyword followed by number
+ * @param pattern
+ * @param pattern_len
+ * @param keyword - keyword upper-cased by foldHeader
+ * @param keyword_len
+ * @param num - parsed number, not modified if keyword has no number, or NULL
+ * @return TRUE if keyword starts with pattern and the rest are digits of
+ * a number that fits in int32_t
+ */
+scpi_bool_t compareKeywordAndNum(const char * pattern, size_t pattern_len, const char * keyword, size_t keyword_len, int32_t * num) {
+    size_t i;
+    int32_t value;
+    scpi_bool_t overflow;
+
+    if ((keyword_len < pattern_len) || !compareUpper(pattern, keyword, pattern_len)) {
+        return FALSE;
+    }
+
+    if (keyword_len == pattern_len) {
+        return TRUE;
+    }
+
+    for (i = pattern_len; i < keyword_len; i++) {
+        if ((keyword[i] < '0') || (keyword[i] > '9')) {
+            return FALSE;
+        }
+    }
+
+    strBaseToInt32(keyword + pattern_len, keyword_len - pattern_len, &value, 10, &overflow);
+    if (overflow) {
+        return FALSE;
+    }
+
+    if (num) {
+        *num = value;
+    }
+
+    return TRUE;
+}
+
 /**
  * Compare two strings, one be longer but may contains only numbers in that section
  * @param str1
@@ -396,8 +968,9 @@ scpi_bool_t compareStrAndNum(const char * str1, size_t len1, const char * str2,
                 //*num = 1;
             } else {
                 int32_t tmpNum;
-                i = len1 + strBaseToInt32(str2 + len1, &tmpNum, 10);
-                if (i != len2) {
+                scpi_bool_t overflow;
+                i = len1 + strBaseToInt32(str2 + len1, len2 - len1, &tmpNum, 10, &overflow);
+                if ((i != len2) || overflow) {
                     result = FALSE;
                 } else {
                     *num = tmpNum;
@@ -410,6 +983,13 @@ scpi_bool_t compareStrAndNum(const char * str1, size_t len1, const char * str2,
                     break;
                 }
             }
+
+            if (result && (len1 != len2)) {
+                int32_t tmpNum;
+                scpi_bool_t overflow;
+                strBaseToInt32(str2 + len1, len2 - len1, &tmpNum, 10, &overflow);
+                result = !overflow;
+            }
         }
     }
 
@@ -684,49 +1264,588 @@ scpi_bool_t matchCommand(const char * pattern, const char * cmd, size_t len, int
 }
 
 /**
- * Compose command from previous command anc current command
+ * Compile pattern for repeated matching by SCPI_PatternMatch
  *
- * @param prev pointer to previous command
- * @param current pointer of current command
+ * Keyword boundaries, short form lengths, optional parts and numeric
+ * suffix slots are found once. The pattern string must stay valid as long
+ * as the compiled pattern is used.
  *
- * prev and current should be in the same memory buffer
+ * @param compiled - storage for compiled pattern
+ * @param pattern - pattern, e.g. "[:SOURce#]:FREQuency[:CW]?"
+ * @return TRUE if successful, FALSE if pattern is malformed or has more than SCPI_PATTERN_KEYWORDS keywords
  */
-scpi_bool_t composeCompoundCommand(const scpi_token_t * prev, scpi_token_t * current) {
+scpi_bool_t SCPI_PatternCompile(scpi_pattern_t * compiled, const char * pattern) {
+    uint8_t open[SCPI_PATTERN_KEYWORDS];
+    size_t depth = 0;
+    size_t len;
     size_t i;
+    size_t start;
+    int8_t slots = 0;
+    uint8_t g;
+    scpi_pattern_keyword_t * keyword;
+
+    compiled->pattern = NULL;
+    compiled->count = 0;
+    compiled->group_count = 0;
+    compiled->query = FALSE;
 
-    /* Invalid input */
-    if (current == NULL || current->ptr == NULL || current->len == 0)
+    if (pattern == NULL) {
         return FALSE;
+    }
 
-    /* no previous command - nothing to do*/
-    if (prev->ptr == NULL || prev->len == 0)
-        return TRUE;
+    len = strlen(pattern);
+    if (len > UINT16_MAX) {
+        return FALSE;
+    }
+
+    if ((len > 0) && (pattern[len - 1] == '?')) {
+        compiled->query = TRUE;
+        len--;
+    }
 
-    /* Common command or command root - nothing to do */
-    if (current->ptr[0] == '*' || current->ptr[0] == ':')
+    for (i = 0; i < len;) {
+        switch (pattern[i]) {
+            case '[':
+                if ((depth >= SCPI_PATTERN_KEYWORDS) || (compiled->group_count >= SCPI_PATTERN_KEYWORDS)) {
+                    return FALSE;
+                }
+                /* groups are stored in order of opening, so nested groups
+                 * starting at the same keyword follow each other */
+                open[depth++] = compiled->group_count;
+                compiled->groups[compiled->group_count].start = compiled->count;
+                compiled->groups[compiled->group_count].end = compiled->count;
+                compiled->group_count++;
+                i++;
+                break;
+            case ']':
+                if (depth == 0) {
+                    return FALSE;
+                }
+                /* group can be skipped, continue after its last keyword */
+                compiled->groups[open[--depth]].end = compiled->count;
+                i++;
+                break;
+            case ':':
+                i++;
+                break;
+            default:
+                if ((compiled->count >= SCPI_PATTERN_KEYWORDS) || (slots == INT8_MAX)) {
+                    return FALSE;
+                }
+                keyword = &compiled->keywords[compiled->count];
+                for (start = i; (i < len) && (pattern[i] != ':') && (pattern[i] != '[') && (pattern[i] != ']'); i++) {
+                }
+
+                keyword->offset = start;
+                keyword->group = 0;
+                for (g = compiled->group_count; (g > 0) && (compiled->groups[g - 1].start == compiled->count); g--) {
+                    keyword->group = g;
+                }
+                keyword->slot = -1;
+                if (pattern[i - 1] == '#') {
+                    keyword->slot = slots++;
+                    i--;
+                }
+
+                if (i - start > UINT8_MAX) {
+                    return FALSE;
+                }
+                keyword->length = i - start;
+                keyword->short_length = patternSeparatorShortPos(pattern + start, i - start);
+
+                if (keyword->slot >= 0) {
+                    i++;
+                }
+                compiled->count++;
+                break;
+        }
+    }
+
+    if (depth != 0) {
+        return FALSE;
+    }
+
+    compiled->pattern = pattern;
+    return TRUE;
+}
+
+/**
+ * Match keywords of header starting with k-th keyword of the pattern
+ * @param compiled - compiled pattern
+ * @param k - index of the keyword in pattern
+ * @param header - program header
+ * @param h - index of the keyword in header
+ * @param numbers - storage for numeric suffixes or NULL
+ * @param numbers_len - length of numbers storage
+ * @param default_value - value of numeric suffix not present in command
+ * @param given - bit set for every suffix present in command or NULL
+ * @return TRUE if the rest of the header matches the rest of the pattern
+ */
+static scpi_bool_t patternMatchKeyword(const scpi_pattern_t * compiled, uint8_t k, const scpi_header_t * header, uint8_t h, int32_t * numbers, size_t numbers_len, int32_t default_value, uint32_t * given) {
+    const scpi_pattern_keyword_t * keyword;
+    const scpi_keyword_t * word;
+    const char * str;
+    const char * word_str;
+    int32_t num = default_value;
+    int32_t * num_ptr = NULL;
+    size_t matched = 0;
+    scpi_bool_t result;
+    uint8_t g;
+
+    if (k >= compiled->count) {
+        return h == header->count;
+    }
+
+    keyword = &compiled->keywords[k];
+
+    if (h < header->count) {
+        str = compiled->pattern + keyword->offset;
+        word = &header->keywords[h];
+        word_str = header->buffer + word->offset;
+
+        if (keyword->slot >= 0) {
+            if (numbers && ((size_t) keyword->slot < numbers_len)) {
+                num_ptr = &num;
+            }
+            if (compareKeywordAndNum(str, keyword->length, word_str, word->length, num_ptr)) {
+                matched = keyword->length;
+                result = TRUE;
+            } else {
+                matched = keyword->short_length;
+                result = compareKeywordAndNum(str, keyword->short_length, word_str, word->length, num_ptr);
+            }
+        } else {
+            result = compareKeyword(str, keyword->length, word_str, word->length) ||
+                    compareKeyword(str, keyword->short_length, word_str, word->length);
+        }
+
+        if (result && patternMatchKeyword(compiled, k + 1, header, h + 1, numbers, numbers_len, default_value, given)) {
+            if (num_ptr) {
+                numbers[keyword->slot] = num;
+                if (given && (word->length > matched)) {
+                    *given |= 1UL << keyword->slot;
+                }
+            }
+            return TRUE;
+        }
+    }
+
+    /* skip optional groups starting here, each nesting level has its own end */
+    for (g = keyword->group; (g > 0) && (g <= compiled->group_count) && (compiled->groups[g - 1].start == k); g++) {
+        if ((compiled->groups[g - 1].end > k) &&
+                patternMatchKeyword(compiled, compiled->groups[g - 1].end, header, h, numbers, numbers_len, default_value, given)) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**
+ * Match program header against compiled pattern
+ * @param compiled - pattern compiled by SCPI_PatternCompile
+ * @param header - program header split by foldHeader
+ * @param numbers - storage for numeric suffixes or NULL
+ * @param numbers_len - length of numbers storage, at most 32 if given is used
+ * @param default_value - value of numeric suffix not present in command
+ * @param given - bit set for every suffix present in command or NULL
+ * @return TRUE if header matches pattern
+ */
+scpi_bool_t matchHeader(const scpi_pattern_t * compiled, const scpi_header_t * header, int32_t * numbers, size_t numbers_len, int32_t default_value, uint32_t * given) {
+    size_t i;
+
+    if (numbers) {
+        for (i = 0; i < numbers_len; i++) {
+            numbers[i] = default_value;
+        }
+    }
+
+    if (given) {
+        *given = 0;
+    }
+
+    if ((compiled->pattern == NULL) || (header->query != compiled->query)) {
+        return FALSE;
+    }
+
+    return patternMatchKeyword(compiled, 0, header, 0, numbers, numbers_len, default_value, given);
+}
+
+/**
+ * Match keywords of header starting with h-th keyword against the rest of
+ * pattern string
+ * @param pattern - rest of the pattern
+ * @param end - end of the pattern without trailing '?'
+ * @param depth - number of optional groups entered and not closed yet
+ * @param slot - index of the next numeric suffix in pattern
+ * @param header - program header
+ * @param h - index of the keyword in header
+ * @param numbers - storage for numeric suffixes or NULL
+ * @param numbers_len - length of numbers storage
+ * @param default_value - value of numeric suffix not present in command
+ * @param given - bit set for every suffix present in command or NULL
+ * @param malformed - set to TRUE if brackets of the pattern are unbalanced
+ * @return TRUE if the rest of the header matches the rest of the pattern
+ */
+static scpi_bool_t patternMatchText(const char * pattern, const char * end, size_t depth, size_t slot, const scpi_header_t * header, uint8_t h, int32_t * numbers, size_t numbers_len, int32_t default_value, uint32_t * given, scpi_bool_t * malformed) {
+    const scpi_keyword_t * word;
+    const char * word_str;
+    const char * p;
+    size_t length;
+    size_t short_length;
+    size_t nested;
+    size_t matched = 0;
+    int32_t num = default_value;
+    int32_t * num_ptr = NULL;
+    scpi_bool_t suffix;
+    scpi_bool_t result;
+
+    for (; pattern < end; pattern++) {
+        if (*pattern == ']') {
+            if (depth == 0) {
+                *malformed = TRUE;
+                return FALSE;
+            }
+            depth--;
+        } else if (*pattern != ':') {
+            break;
+        }
+    }
+
+    if (pattern == end) {
+        if (depth != 0) {
+            *malformed = TRUE;
+            return FALSE;
+        }
+        return h == header->count;
+    }
+
+    if (*pattern == '[') {
+        /* enter optional group first, skip it if the rest does not match */
+        if (patternMatchText(pattern + 1, end, depth + 1, slot, header, h, numbers, numbers_len, default_value, given, malformed)) {
+            return TRUE;
+        }
+        for (p = pattern, nested = 0; p < end; p++) {
+            if (*p == '[') {
+                nested++;
+            } else if (*p == ']') {
+                if (--nested == 0) {
+                    break;
+                }
+            } else if (*p == '#') {
+                slot++;
+            }
+        }
+        if (p == end) {
+            *malformed = TRUE;
+            return FALSE;
+        }
+        return patternMatchText(p + 1, end, depth, slot, header, h, numbers, numbers_len, default_value, given, malformed);
+    }
+
+    if (h >= header->count) {
+        return FALSE;
+    }
+
+    for (p = pattern; (p < end) && (*p != ':') && (*p != '[') && (*p != ']'); p++) {
+    }
+    length = p - pattern;
+    suffix = pattern[length - 1] == '#';
+    if (suffix) {
+        length--;
+    }
+    short_length = patternSeparatorShortPos(pattern, length);
+
+    word = &header->keywords[h];
+    word_str = header->buffer + word->offset;
+
+    if (suffix) {
+        if (numbers && (slot < numbers_len)) {
+            num_ptr = &num;
+        }
+        if (compareKeywordAndNum(pattern, length, word_str, word->length, num_ptr)) {
+            matched = length;
+            result = TRUE;
+        } else {
+            matched = short_length;
+            result = compareKeywordAndNum(pattern, short_length, word_str, word->length, num_ptr);
+        }
+    } else {
+        result = compareKeyword(pattern, length, word_str, word->length) ||
+                compareKeyword(pattern, short_length, word_str, word->length);
+    }
+
+    if (result && patternMatchText(p, end, depth, slot + (suffix ? 1 : 0), header, h + 1, numbers, numbers_len, default_value, given, malformed)) {
+        if (num_ptr) {
+            numbers[slot] = num;
+            if (given && (word->length > matched)) {
+                *given |= 1UL << slot;
+            }
+        }
         return TRUE;
+    }
 
-    /* Previsou command was common command - nothing to do */
-    if (prev->ptr[0] == '*')
+    return FALSE;
+}
+
+/**
+ * Match program header joined back to text by matchCommand
+ * @param pattern
+ * @param header - program header
+ * @param numbers - storage for numeric suffixes or NULL
+ * @param numbers_len - length of numbers storage
+ * @param default_value - value of numeric suffix not present in command
+ * @return TRUE if header matches pattern
+ */
+static scpi_bool_t matchHeaderCommand(const char * pattern, const scpi_header_t * header, int32_t * numbers, size_t numbers_len, int32_t default_value) {
+    char text[UINT8_MAX + SCPI_HEADER_KEYWORDS + 1];
+    const scpi_keyword_t * word;
+    size_t pos = 0;
+    uint8_t i;
+
+    for (i = 0; i < header->count; i++) {
+        word = &header->keywords[i];
+        if (i > 0) {
+            text[pos++] = ':';
+        }
+        memcpy(text + pos, header->buffer + word->offset, word->length);
+        pos += word->length;
+    }
+
+    if (header->query) {
+        text[pos++] = '?';
+    }
+
+    return matchCommand(pattern, text, pos, numbers, numbers_len, default_value);
+}
+
+/**
+ * Match program header against pattern string
+ *
+ * The pattern is walked as it is, so a command list can be searched
+ * without compiling every pattern and without the SCPI_PATTERN_KEYWORDS
+ * limit. Pattern with unbalanced brackets is left to matchCommand.
+ *
+ * @param pattern - pattern, e.g. "[:SOURce#]:FREQuency[:CW]?"
+ * @param header - program header split by foldHeader
+ * @param numbers - storage for numeric suffixes or NULL
+ * @param numbers_len - length of numbers storage, at most 32 if given is used
+ * @param default_value - value of numeric suffix not present in command
+ * @param given - bit set for every suffix present in command or NULL
+ * @return TRUE if header matches pattern
+ */
+scpi_bool_t matchHeaderPattern(const char * pattern, const scpi_header_t * header, int32_t * numbers, size_t numbers_len, int32_t default_value, uint32_t * given) {
+    scpi_bool_t malformed = FALSE;
+    size_t len;
+    size_t i;
+
+    if (numbers) {
+        for (i = 0; i < numbers_len; i++) {
+            numbers[i] = default_value;
+        }
+    }
+
+    if (given) {
+        *given = 0;
+    }
+
+    len = strlen(pattern);
+    if (((len > 0) && (pattern[len - 1] == '?')) != header->query) {
+        return FALSE;
+    }
+    if (header->query) {
+        len--;
+    }
+
+    if (patternMatchText(pattern, pattern + len, 0, 0, header, 0, numbers, numbers_len, default_value, given, &malformed)) {
         return TRUE;
+    }
 
-    /* Find last occurence of ':' */
-    for (i = prev->len; i > 0; i--) {
-        if (prev->ptr[i - 1] == ':') {
-            break;
+    if (malformed) {
+        return matchHeaderCommand(pattern, header, numbers, numbers_len, default_value);
+    }
+
+    return FALSE;
+}
+
+/**
+ * Match leading keywords of program header against compiled prefix
+ *
+ * Prefix has only mandatory keywords without numeric suffixes.
+ *
+ * @param compiled - prefix compiled by SCPI_PatternCompile
+ * @param header - program header
+ * @param rest - header without keywords matched by the prefix
+ * @return TRUE if header starts with the prefix
+ */
+scpi_bool_t matchHeaderPrefix(const scpi_pattern_t * compiled, const scpi_header_t * header, scpi_header_t * rest) {
+    const scpi_pattern_keyword_t * keyword;
+    const scpi_keyword_t * word;
+    const char * str;
+    uint8_t i;
+
+    if (header->count <= compiled->count) {
+        return FALSE;
+    }
+
+    for (i = 0; i < compiled->count; i++) {
+        keyword = &compiled->keywords[i];
+        word = &header->keywords[i];
+        str = compiled->pattern + keyword->offset;
+        if (!compareKeyword(str, keyword->length, header->buffer + word->offset, word->length) &&
+                !compareKeyword(str, keyword->short_length, header->buffer + word->offset, word->length)) {
+            return FALSE;
         }
     }
 
-    /* Previous command was simple command - nothing to do*/
-    if (i == 0)
+    rest->buffer = header->buffer;
+    for (i = compiled->count; i < header->count; i++) {
+        rest->keywords[i - compiled->count] = header->keywords[i];
+    }
+    rest->count = header->count - compiled->count;
+    rest->query = header->query;
+    rest->resume = -1;
+    rest->resume_depth = 0;
+    rest->prefix = -1;
+
+    return TRUE;
+}
+
+/**
+ * Match command against compiled pattern
+ * @param compiled - pattern compiled by SCPI_PatternCompile
+ * @param value - command
+ * @param len - max length of command
+ * @param numbers - storage for numeric suffixes or NULL
+ * @param numbers_len - length of numbers storage
+ * @param default_value - value of numeric suffix not present in command
+ * @return TRUE if command matches pattern
+ */
+scpi_bool_t SCPI_PatternMatch(const scpi_pattern_t * compiled, const char * value, size_t len, int32_t * numbers, size_t numbers_len, int32_t default_value) {
+    scpi_header_t header;
+    char buffer[SCPI_HEADER_LENGTH];
+    size_t i;
+
+    if ((compiled == NULL) || (value == NULL) || !foldHeader(NULL, value, len, buffer, sizeof (buffer), &header)) {
+        if (numbers) {
+            for (i = 0; i < numbers_len; i++) {
+                numbers[i] = default_value;
+            }
+        }
+        return FALSE;
+    }
+
+    return matchHeader(compiled, &header, numbers, numbers_len, default_value, NULL);
+}
+
+/**
+ * Split program header to keywords
+ *
+ * Relative header in compound message, e.g. "AC?" in "MEAS:VOLT:DC?;AC?",
+ * starts with keywords of previous header without its last keyword.
+ * Keywords are positions in the buffer, nothing is copied or modified.
+ *
+ * @param prev - header of previous command in the same buffer or NULL
+ * @param buffer - buffer with program header
+ * @param pos - position of program header in buffer
+ * @param len - max length of program header
+ * @param header - result
+ * @return TRUE if successful, FALSE if header is malformed, has more than SCPI_HEADER_KEYWORDS keywords or ends beyond 255 characters of buffer
+ */
+scpi_bool_t composeHeader(const scpi_header_t * prev, const char * buffer, size_t pos, size_t len, scpi_header_t * header) {
+    const char * cmd = buffer + pos;
+    size_t i;
+    size_t start;
+
+    header->buffer = buffer;
+    header->count = 0;
+    header->query = FALSE;
+    header->resume = -1;
+    header->resume_depth = 0;
+    header->prefix = -1;
+
+    len = SCPIDEFINE_strnlen(cmd, len);
+
+    if (pos + len > UINT8_MAX) {
+        return FALSE;
+    }
+
+    if ((len > 0) && (cmd[len - 1] == '?')) {
+        header->query = TRUE;
+        len--;
+    }
+
+    if (len == 0) {
         return TRUE;
+    }
+
+    if (cmd[0] == ':') {
+        /* handle errornouse ":*IDN?" */
+        if ((len > 1) && (cmd[1] == '*')) {
+            return FALSE;
+        }
+        cmd++;
+        len--;
+    } else if ((cmd[0] != '*') && prev && (prev->count > 1)) {
+        /* previous command was compound command - inherit its path */
+        for (i = 0; i + 1 < prev->count; i++) {
+            header->keywords[i] = prev->keywords[i];
+        }
+        header->count = prev->count - 1;
+        header->resume = prev->prefix;
+        header->resume_depth = header->count;
+    }
+
+    for (start = 0, i = 0; i <= len; i++) {
+        if ((i == len) || (cmd[i] == ':')) {
+            if ((i == start) || (header->count >= SCPI_HEADER_KEYWORDS)) {
+                return FALSE;
+            }
+            header->keywords[header->count].offset = (uint8_t) (cmd + start - buffer);
+            header->keywords[header->count].length = (uint8_t) (i - start);
+            header->count++;
+            start = i + 1;
+        }
+    }
 
-    current->ptr -= i;
-    current->len += i;
-    memmove(current->ptr, prev->ptr, i);
     return TRUE;
 }
 
+/**
+ * Copy program header to buffer in upper case and split it to keywords
+ *
+ * Keywords inherited from previous header are already in the buffer, the
+ * rest of the header is placed after them, so keywords of both headers
+ * stay valid. The buffer has to be used for all headers of a message.
+ *
+ * @param prev - header of previous command, folded to the same buffer, or NULL
+ * @param cmd - program header
+ * @param len - max length of program header
+ * @param buffer - buffer for upper-cased header
+ * @param size - size of buffer
+ * @param header - result
+ * @return TRUE if successful, FALSE if header is malformed or too long
+ */
+scpi_bool_t foldHeader(const scpi_header_t * prev, const char * cmd, size_t len, char * buffer, size_t size, scpi_header_t * header) {
+    size_t pos = 0;
+    const scpi_keyword_t * last;
+
+    len = SCPIDEFINE_strnlen(cmd, len);
+
+    if ((len > 0) && (cmd[0] != ':') && (cmd[0] != '*') && prev && (prev->count > 1)) {
+        last = &prev->keywords[prev->count - 2];
+        pos = (size_t) last->offset + last->length;
+    }
+
+    if ((pos > size) || (len > size - pos)) {
+        return FALSE;
+    }
+
+    upperCase(buffer + pos, cmd, len);
+
+    return composeHeader(prev, buffer, pos, len, header);
+}
+
 
 
 #if !HAVE_STRNLEN
@@ -55,20 +55,30 @@ extern "C" {
     char * strnpbrk(const char *str, size_t size, const char *set) LOCAL;
     scpi_bool_t compareStr(const char * str1, size_t len1, const char * str2, size_t len2) LOCAL;
     scpi_bool_t compareStrAndNum(const char * str1, size_t len1, const char * str2, size_t len2, int32_t * num) LOCAL;
+    void upperCase(char * dst, const char * src, size_t len) LOCAL;
+    uint64_t scanStructural(const char * data, size_t len) LOCAL;
+    size_t scanStructuralNext(const char * data, size_t len) LOCAL;
+    size_t scanTerminator(const char * data, size_t len) LOCAL;
+    scpi_bool_t compareKeyword(const char * pattern, size_t pattern_len, const char * keyword, size_t keyword_len) LOCAL;
+    scpi_bool_t compareKeywordAndNum(const char * pattern, size_t pattern_len, const char * keyword, size_t keyword_len, int32_t * num) LOCAL;
     size_t UInt32ToStrBaseSign(uint32_t val, char * str, size_t len, int8_t base, scpi_bool_t sign) LOCAL;
     size_t UInt64ToStrBaseSign(uint64_t val, char * str, size_t len, int8_t base, scpi_bool_t sign) LOCAL;
-    size_t strBaseToInt32(const char * str, int32_t * val, int8_t base) LOCAL;
-    size_t strBaseToUInt32(const char * str, uint32_t * val, int8_t base) LOCAL;
-    size_t strBaseToInt64(const char * str, int64_t * val, int8_t base) LOCAL;
-    size_t strBaseToUInt64(const char * str, uint64_t * val, int8_t base) LOCAL;
-    size_t strToFloat(const char * str, float * val) LOCAL;
-    size_t strToDouble(const char * str, double * val) LOCAL;
+    size_t strBaseToInt32(const char * str, size_t len, int32_t * val, int8_t base, scpi_bool_t * overflow) LOCAL;
+    size_t strBaseToUInt32(const char * str, size_t len, uint32_t * val, int8_t base, scpi_bool_t * overflow) LOCAL;
+    size_t strBaseToInt64(const char * str, size_t len, int64_t * val, int8_t base, scpi_bool_t * overflow) LOCAL;
+    size_t strBaseToUInt64(const char * str, size_t len, uint64_t * val, int8_t base, scpi_bool_t * overflow) LOCAL;
+    size_t strToFloat(const char * str, size_t len, float * val) LOCAL;
+    size_t strToDouble(const char * str, size_t len, double * val) LOCAL;
     scpi_bool_t locateText(const char * str1, size_t len1, const char ** str2, size_t * len2) LOCAL;
     scpi_bool_t locateStr(const char * str1, size_t len1, const char ** str2, size_t * len2) LOCAL;
     size_t skipWhitespace(const char * cmd, size_t len) LOCAL;
     scpi_bool_t matchPattern(const char * pattern, size_t pattern_len, const char * str, size_t str_len, int32_t * num) LOCAL;
     scpi_bool_t matchCommand(const char * pattern, const char * cmd, size_t len, int32_t *numbers, size_t numbers_len, int32_t default_value) LOCAL;
-    scpi_bool_t composeCompoundCommand(const scpi_token_t * prev, scpi_token_t * current) LOCAL;
+    scpi_bool_t composeHeader(const scpi_header_t * prev, const char * buffer, size_t pos, size_t len, scpi_header_t * header) LOCAL;
+    scpi_bool_t foldHeader(const scpi_header_t * prev, const char * cmd, size_t len, char * buffer, size_t size, scpi_header_t * header) LOCAL;
+    scpi_bool_t matchHeader(const scpi_pattern_t * compiled, const scpi_header_t * header, int32_t * numbers, size_t numbers_len, int32_t default_value, uint32_t * given) LOCAL;
+    scpi_bool_t matchHeaderPattern(const char * pattern, const scpi_header_t * header, int32_t * numbers, size_t numbers_len, int32_t default_value, uint32_t * given) LOCAL;
+    scpi_bool_t matchHeaderPrefix(const scpi_pattern_t * compiled, const scpi_header_t * header, scpi_header_t * rest) LOCAL;
 
 #if !HAVE_STRNLEN
     size_t BSD_strnlen(const char *s, size_t maxlen) LOCAL;
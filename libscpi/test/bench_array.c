@@ -0,0 +1,173 @@
+/*
+ * File:   bench_array.c
+ *
+ * Microbenchmark of numeric array parameters. Compares reading of 1M
+ * comma separated numbers one by one by SCPI_ParamDouble/SCPI_ParamInt32
+ * to SCPI_ParamArrayDouble/SCPI_ParamArrayInt32. Only the time spent in
+ * the command callback is measured, detection of the program message unit
+ * is the same for both.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "scpi/scpi.h"
+
+#define BENCH_VALUES 1000000
+#define HEADER_LENGTH 14
+
+static char message[BENCH_VALUES * 12 + 32];
+static double doubles[BENCH_VALUES];
+static int32_t int32s[BENCH_VALUES];
+static size_t count;
+static clock_t spent;
+
+static scpi_result_t loopDouble(scpi_t * context) {
+    clock_t start = clock();
+
+    for (count = 0; count < BENCH_VALUES; count++) {
+        if (!SCPI_ParamDouble(context, &doubles[count], FALSE)) {
+            break;
+        }
+    }
+
+    spent = clock() - start;
+    return SCPI_RES_OK;
+}
+
+static scpi_result_t arrayDouble(scpi_t * context) {
+    clock_t start = clock();
+
+    SCPI_ParamArrayDouble(context, doubles, BENCH_VALUES, &count, TRUE);
+
+    spent = clock() - start;
+    return SCPI_RES_OK;
+}
+
+static scpi_result_t loopInt32(scpi_t * context) {
+    clock_t start = clock();
+
+    for (count = 0; count < BENCH_VALUES; count++) {
+        if (!SCPI_ParamInt32(context, &int32s[count], FALSE)) {
+            break;
+        }
+    }
+
+    spent = clock() - start;
+    return SCPI_RES_OK;
+}
+
+static scpi_result_t arrayInt32(scpi_t * context) {
+    clock_t start = clock();
+
+    SCPI_ParamArrayInt32(context, int32s, BENCH_VALUES, &count, TRUE);
+
+    spent = clock() - start;
+    return SCPI_RES_OK;
+}
+
+static const scpi_command_t commands[] = {
+    { .pattern = "LOOP:DOUBle", .callback = loopDouble,},
+    { .pattern = "ARRay:DOUBle", .callback = arrayDouble,},
+    { .pattern = "LOOP:INTeger", .callback = loopInt32,},
+    { .pattern = "ARRay:INTeger", .callback = arrayInt32,},
+    SCPI_CMD_LIST_END
+};
+
+static int errors = 0;
+
+static size_t writeOutput(scpi_t * context, const char * data, size_t len) {
+    (void) context;
+    (void) data;
+    return len;
+}
+
+static int error(scpi_t * context, int_fast16_t err) {
+    (void) context;
+    (void) err;
+    errors++;
+    return 0;
+}
+
+static scpi_interface_t interface = {
+    .write = writeOutput,
+    .error = error,
+};
+
+static char input_buffer[256];
+static scpi_reg_val_t registers[SCPI_REG_COUNT];
+
+static scpi_t context = {
+    .cmdlist = commands,
+    .buffer = {
+        .length = sizeof (input_buffer),
+        .data = input_buffer,
+    },
+    .interface = &interface,
+    .registers = registers,
+    .units = scpi_units_def,
+};
+
+static double run(const char * header, size_t values) {
+    memset(message, ' ', HEADER_LENGTH);
+    memcpy(message, header, strlen(header));
+    SCPI_Parse(&context, message, (int) strlen(message));
+
+    if ((count != values) || errors) {
+        printf("%s: read %u values, %d errors\n", header, (unsigned) count, errors);
+    }
+
+    return (double) spent * 1e9 / CLOCKS_PER_SEC / (double) values;
+}
+
+int main(void) {
+    double sum_loop = 0;
+    double sum = 0;
+    size_t len;
+    size_t i;
+
+    SCPI_Init(&context);
+
+    len = HEADER_LENGTH;
+    for (i = 0; i < BENCH_VALUES; i++) {
+        len += sprintf(message + len, "%u.%03u,", (unsigned) (i % 1000), (unsigned) (i % 997));
+    }
+    message[len - 1] = '\n';
+
+    printf("SCPI_ParamDouble:      %8.1f ns/number\n", run("LOOP:DOUB", BENCH_VALUES));
+    for (i = 0; i < BENCH_VALUES; i++) {
+        sum_loop += doubles[i];
+    }
+    printf("SCPI_ParamArrayDouble: %8.1f ns/number\n", run("ARR:DOUB", BENCH_VALUES));
+    for (i = 0; i < BENCH_VALUES; i++) {
+        sum += doubles[i];
+    }
+    if (sum != sum_loop) {
+        printf("results differ\n");
+        return 1;
+    }
+
+    len = HEADER_LENGTH;
+    for (i = 0; i < BENCH_VALUES; i++) {
+        len += sprintf(message + len, "%d,", (int) (i * 2147) - 1000000000);
+    }
+    message[len - 1] = '\n';
+
+    printf("SCPI_ParamInt32:       %8.1f ns/number\n", run("LOOP:INT", BENCH_VALUES));
+    sum_loop = 0;
+    for (i = 0; i < BENCH_VALUES; i++) {
+        sum_loop += int32s[i];
+    }
+    printf("SCPI_ParamArrayInt32:  %8.1f ns/number\n", run("ARR:INT", BENCH_VALUES));
+    sum = 0;
+    for (i = 0; i < BENCH_VALUES; i++) {
+        sum += int32s[i];
+    }
+    if (sum != sum_loop) {
+        printf("results differ\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * File:   bench_header.c
+ *
+ * Microbenchmark of command dispatch. Program messages with one command
+ * are passed to SCPI_Parse with a table of 300 commands, first without
+ * a command index, then with the index built by SCPI_CommandIndexBuild.
+ * Headers cycle through more distinct commands than the dispatch cache
+ * holds, so every message is resolved by searching the table.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "scpi/scpi.h"
+
+#define BENCH_ROUNDS 2000
+#define SUBSYSTEMS 15
+#define FUNCTIONS 10
+#define COMMANDS (SUBSYSTEMS * FUNCTIONS * 2)
+#define HEADERS 64
+
+static const char * subsystems[SUBSYSTEMS] = {
+    "SOURce#", "SENSe#", "MEASure", "CONFigure", "CALCulate#",
+    "TRIGger", "OUTPut#", "INPut#", "SYSTem", "STATus",
+    "DISPlay", "FORMat", "MEMory", "ROUTe", "CALibration",
+};
+
+static const char * functions[FUNCTIONS] = {
+    "VOLTage[:LEVel][:IMMediate]", "CURRent[:LEVel]", "FREQuency[:CW]", "POWer",
+    "RESistance", "PERiod", "PHASe:ADJust", "OFFSet", "STATe", "MODE",
+};
+
+/* short forms of subsystems and functions, used to compose headers */
+static const char * subsystems_short[SUBSYSTEMS] = {
+    "sour2", "sens", "meas", "conf", "calc3",
+    "trig", "outp1", "inp4", "syst", "stat",
+    "disp", "form", "mem", "rout", "cal",
+};
+
+static const char * functions_short[FUNCTIONS] = {
+    "volt:lev", "curr", "freq:cw", "pow",
+    "res", "per", "phas:adj", "offs", "stat", "mode",
+};
+
+static char pattern_text[COMMANDS][64];
+static scpi_command_t commands[COMMANDS + 1];
+static scpi_command_node_t nodes[2048];
+static scpi_command_index_t command_index;
+static char messages[HEADERS][64];
+static size_t executed;
+
+static scpi_result_t execute(scpi_t * context) {
+    (void) context;
+    executed++;
+    return SCPI_RES_OK;
+}
+
+static size_t writeOutput(scpi_t * context, const char * data, size_t len) {
+    (void) context;
+    (void) data;
+    return len;
+}
+
+static int errors = 0;
+
+static int error(scpi_t * context, int_fast16_t err) {
+    (void) context;
+    (void) err;
+    errors++;
+    return 0;
+}
+
+static scpi_interface_t interface = {
+    .write = writeOutput,
+    .error = error,
+};
+
+static char input_buffer[256];
+static scpi_reg_val_t registers[SCPI_REG_COUNT];
+
+static scpi_t context = {
+    .cmdlist = commands,
+    .buffer = {
+        .length = sizeof (input_buffer),
+        .data = input_buffer,
+    },
+    .interface = &interface,
+    .registers = registers,
+    .units = scpi_units_def,
+};
+
+static double run(void) {
+    clock_t start;
+    size_t r, h;
+
+    executed = 0;
+    start = clock();
+    for (r = 0; r < BENCH_ROUNDS; r++) {
+        for (h = 0; h < HEADERS; h++) {
+            SCPI_Parse(&context, messages[h], strlen(messages[h]));
+        }
+    }
+
+    if ((executed != BENCH_ROUNDS * HEADERS) || errors) {
+        printf("executed %u commands, %d errors\n", (unsigned) executed, errors);
+    }
+
+    return (double) (clock() - start) * 1e9 / CLOCKS_PER_SEC / (BENCH_ROUNDS * HEADERS);
+}
+
+int main(void) {
+    size_t s, f, i, h;
+
+    for (i = 0, s = 0; s < SUBSYSTEMS; s++) {
+        for (f = 0; f < FUNCTIONS; f++, i += 2) {
+            sprintf(pattern_text[i], "%s:%s", subsystems[s], functions[f]);
+            sprintf(pattern_text[i + 1], "%s:%s?", subsystems[s], functions[f]);
+            commands[i].pattern = pattern_text[i];
+            commands[i].callback = execute;
+            commands[i + 1].pattern = pattern_text[i + 1];
+            commands[i + 1].callback = execute;
+        }
+    }
+
+    /* spread headers over the whole table, queries and settings */
+    for (h = 0; h < HEADERS; h++) {
+        i = (h * 37) % (SUBSYSTEMS * FUNCTIONS);
+        sprintf(messages[h], "%s:%s%s\r\n", subsystems_short[i / FUNCTIONS],
+                functions_short[i % FUNCTIONS], (h & 1) ? "?" : "");
+    }
+
+    SCPI_Init(&context);
+
+    printf("table of %u commands\n", (unsigned) COMMANDS);
+    printf("SCPI_Parse without index: %8.1f ns/message\n", run());
+
+    if ((SCPI_CommandIndexNodes(commands) > sizeof (nodes) / sizeof (nodes[0])) ||
+            !SCPI_CommandIndexBuild(&command_index, commands, nodes, sizeof (nodes) / sizeof (nodes[0]))) {
+        printf("cannot build index\n");
+        return 1;
+    }
+    context.cmdindex = &command_index;
+    printf("SCPI_Parse with index:    %8.1f ns/message\n", run());
+
+    return errors ? 1 : 0;
+}
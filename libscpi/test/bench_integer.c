@@ -0,0 +1,76 @@
+/*
+ * File:   bench_integer.c
+ *
+ * Microbenchmark of integer parameter conversion. Compares the C library
+ * strtol/strtoull, which need NUL terminated input, to the length bounded
+ * strBaseTo* functions for decimal, hexadecimal, octal and binary data.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scpi/scpi.h"
+#include "../src/utils_private.h"
+
+#define BENCH_ROUNDS 200000
+
+static const struct {
+    const char * str;
+    int8_t base;
+} numbers[] = {
+    {"5", 10},
+    {"1024", 10},
+    {"2147483647", 10},
+    {"18446744073709551615", 10},
+    {"DEADBEEF", 16},
+    {"0123456789abcdef", 16},
+    {"17777777777", 8},
+    {"1010101011110000", 2},
+};
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+static double elapsed(clock_t start, size_t ops) {
+    return (double) (clock() - start) * 1e9 / CLOCKS_PER_SEC / (double) ops;
+}
+
+int main(void) {
+    size_t lens[ARRAY_SIZE(numbers)];
+    size_t ops = BENCH_ROUNDS * ARRAY_SIZE(numbers);
+    uint64_t sum_libc = 0;
+    uint64_t sum = 0;
+    uint64_t val;
+    scpi_bool_t overflow;
+    clock_t start;
+    size_t r, n;
+
+    for (n = 0; n < ARRAY_SIZE(numbers); n++) {
+        lens[n] = strlen(numbers[n].str);
+    }
+
+    start = clock();
+    for (r = 0; r < BENCH_ROUNDS; r++) {
+        for (n = 0; n < ARRAY_SIZE(numbers); n++) {
+            sum_libc += strtoull(numbers[n].str, NULL, numbers[n].base);
+        }
+    }
+    printf("strtoull:        %8.1f ns/number\n", elapsed(start, ops));
+
+    start = clock();
+    for (r = 0; r < BENCH_ROUNDS; r++) {
+        for (n = 0; n < ARRAY_SIZE(numbers); n++) {
+            strBaseToUInt64(numbers[n].str, lens[n], &val, numbers[n].base, &overflow);
+            sum += val;
+        }
+    }
+    printf("strBaseToUInt64: %8.1f ns/number\n", elapsed(start, ops));
+
+    if (sum != sum_libc) {
+        printf("results differ\n");
+        return 1;
+    }
+
+    return 0;
+}
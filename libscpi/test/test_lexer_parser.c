@@ -110,6 +110,9 @@ static void testNondecimal(void) {
     TEST_TOKEN("#H123fe5A", scpiLex_NondecimalNumericData, 2, 7, SCPI_TOKEN_HEXNUM);
     TEST_TOKEN("#B0111010101", scpiLex_NondecimalNumericData, 2, 10, SCPI_TOKEN_BINNUM);
     TEST_TOKEN("#Q125725433", scpiLex_NondecimalNumericData, 2, 9, SCPI_TOKEN_OCTNUM);
+    TEST_TOKEN("#Q128", scpiLex_NondecimalNumericData, 2, 2, SCPI_TOKEN_OCTNUM);
+    TEST_TOKEN("#H, ", scpiLex_NondecimalNumericData, 0, 0, SCPI_TOKEN_UNKNOWN);
+    TEST_TOKEN("10", scpiLex_NondecimalNumericData, 0, 0, SCPI_TOKEN_UNKNOWN);
 }
 
 static void testCharacterProgramData(void) {
@@ -153,7 +156,9 @@ static void testArbitraryBlock(void) {
     TEST_TOKEN("#12AB, ", scpiLex_ArbitraryBlockProgramData, 3, 2, SCPI_TOKEN_ARBITRARY_BLOCK_PROGRAM_DATA);
     TEST_TOKEN("#13AB", scpiLex_ArbitraryBlockProgramData, 0, 0, SCPI_TOKEN_UNKNOWN);
     TEST_TOKEN("#12\r\n, ", scpiLex_ArbitraryBlockProgramData, 3, 2, SCPI_TOKEN_ARBITRARY_BLOCK_PROGRAM_DATA);
-    TEST_TOKEN("#02AB, ", scpiLex_ArbitraryBlockProgramData, 0, 0, SCPI_TOKEN_UNKNOWN);
+    TEST_TOKEN("#02AB, ", scpiLex_ArbitraryBlockProgramData, 2, 5, SCPI_TOKEN_ARBITRARY_BLOCK_PROGRAM_DATA);
+    TEST_TOKEN("#0AB\r\n", scpiLex_ArbitraryBlockProgramData, 2, 3, SCPI_TOKEN_ARBITRARY_BLOCK_PROGRAM_DATA);
+    TEST_TOKEN("#0\n", scpiLex_ArbitraryBlockProgramData, 2, 0, SCPI_TOKEN_ARBITRARY_BLOCK_PROGRAM_DATA);
 }
 
 static void testExpression(void) {
@@ -172,6 +177,7 @@ static void testString(void) {
     TEST_TOKEN("\"ah\"\"oj\" ", scpiLex_StringProgramData, 0, 8, SCPI_TOKEN_DOUBLE_QUOTE_PROGRAM_DATA);
     TEST_TOKEN("\"\"", scpiLex_StringProgramData, 0, 2, SCPI_TOKEN_DOUBLE_QUOTE_PROGRAM_DATA);
     TEST_TOKEN("''", scpiLex_StringProgramData, 0, 2, SCPI_TOKEN_SINGLE_QUOTE_PROGRAM_DATA);
+    TEST_TOKEN("'ah\xe1oj' ", scpiLex_StringProgramData, 0, 0, SCPI_TOKEN_UNKNOWN);
 }
 
 static void testProgramData(void) {
@@ -193,7 +199,7 @@ static void testProgramData(void) {
     TEST_TOKEN("#12AB, ", scpiParser_parseProgramData, 3, 2, SCPI_TOKEN_ARBITRARY_BLOCK_PROGRAM_DATA);
     TEST_TOKEN("#13AB", scpiParser_parseProgramData, 0, 0, SCPI_TOKEN_UNKNOWN);
     TEST_TOKEN("#12\r\n, ", scpiParser_parseProgramData, 3, 2, SCPI_TOKEN_ARBITRARY_BLOCK_PROGRAM_DATA);
-    TEST_TOKEN("#02AB, ", scpiParser_parseProgramData, 0, 0, SCPI_TOKEN_UNKNOWN);
+    TEST_TOKEN("#02AB, ", scpiParser_parseProgramData, 2, 5, SCPI_TOKEN_ARBITRARY_BLOCK_PROGRAM_DATA);
 
     TEST_TOKEN("( 1 + 2 ) , ", scpiParser_parseProgramData, 0, 9, SCPI_TOKEN_PROGRAM_EXPRESSION);
     TEST_TOKEN("( 1 + 2  , ", scpiParser_parseProgramData, 0, 0, SCPI_TOKEN_UNKNOWN);
@@ -241,6 +247,7 @@ static void testAllProgramData(void) {
     TEST_ALL_TOKEN("#12\r\n, 1.5E12 V", scpiParser_parseAllProgramData, 0, 15, SCPI_TOKEN_ALL_PROGRAM_DATA, 2);
     TEST_ALL_TOKEN(" ( 1 + 2 ) ,#12\r\n, 1.5E12 V", scpiParser_parseAllProgramData, 0, 27, SCPI_TOKEN_ALL_PROGRAM_DATA, 3);
     TEST_ALL_TOKEN("\"ahoj\" , #12AB", scpiParser_parseAllProgramData, 0, 14, SCPI_TOKEN_ALL_PROGRAM_DATA, 2);
+    TEST_ALL_TOKEN("10 ,#H10", scpiParser_parseAllProgramData, 0, 8, SCPI_TOKEN_ALL_PROGRAM_DATA, 2);
 }
 
 
@@ -44,6 +44,159 @@ static scpi_result_t test_treeB(scpi_t* context) {
     return SCPI_RES_OK;
 }
 
+static scpi_result_t test_numbers(scpi_t* context) {
+    int32_t numbers[3];
+
+    SCPI_CommandNumbers(context, numbers, 3, -1);
+    SCPI_ResultInt32(context, numbers[0]);
+    SCPI_ResultInt32(context, numbers[1]);
+    SCPI_ResultInt32(context, numbers[2]);
+    SCPI_ResultInt32(context, SCPI_CommandNumber(context, 1, 7));
+
+    return SCPI_RES_OK;
+}
+
+static scpi_result_t test_parameters(scpi_t* context) {
+    scpi_number_t number;
+    int32_t value;
+
+    while (SCPI_ParamNumber(context, scpi_special_numbers_def, &number, FALSE)) {
+        if (!SCPI_ParamInt32(context, &value, TRUE)) {
+            return SCPI_RES_ERR;
+        }
+        SCPI_ResultDouble(context, number.value);
+        SCPI_ResultInt32(context, number.unit);
+        SCPI_ResultInt32(context, value);
+    }
+
+    return SCPI_RES_OK;
+}
+
+#if USE_ARBITRARY_BLOCK_STREAM
+static char stream_buffer[1200];
+static size_t stream_len = 0;
+static size_t stream_direct = 0;
+
+static scpi_result_t test_stream(scpi_t* context, scpi_stream_event_t event, const char * data, size_t len) {
+    int32_t channel;
+    int32_t option;
+
+    switch (event) {
+        case SCPI_STREAM_BEGIN:
+            if (!SCPI_ParamInt32(context, &channel, TRUE)
+                    || ((len != SCPI_BLOCK_LENGTH_INDEFINITE) && (len > sizeof (stream_buffer)))) {
+                return SCPI_RES_ERR;
+            }
+            while (SCPI_ParamInt32(context, &option, FALSE)) {
+                /* numbers between channel and the block are ignored */
+            }
+            stream_len = 0;
+            stream_direct = 0;
+            if (channel == 2) {
+                SCPI_StreamDestination(context, stream_buffer, sizeof (stream_buffer));
+            }
+            break;
+        case SCPI_STREAM_DATA:
+            if (len > sizeof (stream_buffer) - stream_len) {
+                return SCPI_RES_ERR;
+            }
+            if (data == stream_buffer + stream_len) {
+                stream_direct += len;
+            } else {
+                memcpy(stream_buffer + stream_len, data, len);
+            }
+            stream_len += len;
+            break;
+        case SCPI_STREAM_END:
+            SCPI_ResultInt32(context, (int32_t) stream_len);
+            break;
+        case SCPI_STREAM_ABORT:
+            stream_len = 0;
+            break;
+    }
+
+    return SCPI_RES_OK;
+}
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+
+#if USE_NUMERIC_LIST_STREAM
+static double list_batch[4];
+static size_t list_count = 0;
+static double list_sum = 0;
+
+static scpi_result_t test_list(scpi_t* context, scpi_stream_event_t event, const double * values, size_t count) {
+    size_t i;
+
+    switch (event) {
+        case SCPI_STREAM_BEGIN:
+            list_count = 0;
+            list_sum = 0;
+            SCPI_ListDestination(context, list_batch, 4);
+            break;
+        case SCPI_STREAM_DATA:
+            if ((values != list_batch) || (count > 4)) {
+                return SCPI_RES_ERR;
+            }
+            for (i = 0; i < count; i++) {
+                list_sum += values[i];
+            }
+            list_count += count;
+            break;
+        case SCPI_STREAM_END:
+            SCPI_ResultInt32(context, (int32_t) list_count);
+            SCPI_ResultDouble(context, list_sum);
+            break;
+        case SCPI_STREAM_ABORT:
+            list_count = 0;
+            break;
+    }
+
+    return SCPI_RES_OK;
+}
+#endif /* USE_NUMERIC_LIST_STREAM */
+
+static scpi_result_t test_blockQ(scpi_t* context) {
+    int32_t len;
+
+    if (!SCPI_ParamInt32(context, &len, TRUE)) {
+        return SCPI_RES_ERR;
+    }
+
+    SCPI_ResultArbitraryBlockBegin(context, (len < 0) ? SCPI_BLOCK_LENGTH_INDEFINITE : (size_t) len);
+    SCPI_ResultArbitraryBlockChunk(context, "ab", 2);
+    SCPI_ResultArbitraryBlockChunk(context, "cd", 2);
+    SCPI_ResultArbitraryBlockEnd(context);
+
+    return SCPI_RES_OK;
+}
+
+static scpi_result_t test_slotVoltage(scpi_t* context) {
+
+    SCPI_ResultInt32(context, 30);
+
+    return SCPI_RES_OK;
+}
+
+static scpi_result_t test_slotCurrent(scpi_t* context) {
+
+    SCPI_ResultInt32(context, SCPI_CommandNumber(context, 0, 1));
+
+    return SCPI_RES_OK;
+}
+
+static const scpi_command_t slot_commands[] = {
+    { .pattern = "VOLTage?", .callback = test_slotVoltage,},
+    { .pattern = "CURRent#?", .callback = test_slotCurrent,},
+    SCPI_CMD_LIST_END
+};
+
+/* patterns that can't be compiled by SCPI_PatternCompile */
+static const scpi_command_t long_commands[] = {
+    { .pattern = "LONG[:A][:B][:C][:D][:E][:F][:G][:H][:I][:J][:K][:L]:VOLTage?", .callback = test_slotVoltage,},
+    { .pattern = "[:UNBalanced:VOLTage?", .callback = test_slotVoltage,},
+    SCPI_CMD_LIST_END
+};
+
 static const scpi_command_t scpi_commands[] = {
     /* IEEE Mandated Commands (SCPI std V1999.0 4.1.1) */
     { .pattern = "*CLS", .callback = SCPI_CoreCls,},
@@ -75,6 +228,15 @@ static const scpi_command_t scpi_commands[] = {
 
     { .pattern = "TEST:TREEA?", .callback = test_treeA,},
     { .pattern = "TEST:TREEB?", .callback = test_treeB,},
+    { .pattern = "TEST:NUMbers#[:SUFFix#]:LAST#?", .callback = test_numbers,},
+    { .pattern = "TEST:PARameters?", .callback = test_parameters,},
+    { .pattern = "TEST:BLOCk?", .callback = test_blockQ,},
+#if USE_ARBITRARY_BLOCK_STREAM
+    { .pattern = "TEST:BLOCk", .callback = NULL, .stream = test_stream,},
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+#if USE_NUMERIC_LIST_STREAM
+    { .pattern = "TEST:LIST", .callback = NULL, .list = test_list,},
+#endif /* USE_NUMERIC_LIST_STREAM */
 
     SCPI_CMD_LIST_END
 };
@@ -195,6 +357,10 @@ static int clean_suite(void) {
 }
 
 static void testCommandsHandling(void) {
+#if USE_PARAMETER_CACHE
+    uint32_t hits;
+    uint32_t misses;
+#endif /* USE_PARAMETER_CACHE */
 #define TEST_INPUT(data, output) {                              \
     SCPI_Input(&scpi_context, data, strlen(data));              \
     CU_ASSERT_STRING_EQUAL(output, output_buffer);              \
@@ -210,6 +376,14 @@ static void testCommandsHandling(void) {
     TEST_INPUT("*IDN?\r\n*IDN?\r\n*IDN?\r\n*IDN?\r\n", "MA,IN,0,VER\r\nMA,IN,0,VER\r\nMA,IN,0,VER\r\nMA,IN,0,VER\r\n");
     output_buffer_clear();
 
+    /* executed messages are not moved out of the input buffer */
+    TEST_INPUT("*IDN?\r\n*IDN?\r\n*ID", "MA,IN,0,VER\r\nMA,IN,0,VER\r\n");
+    CU_ASSERT_EQUAL(scpi_context.input_state.unit, 14);
+    CU_ASSERT_EQUAL(scpi_context.buffer.position, 17);
+    TEST_INPUT("N?\r\n", "MA,IN,0,VER\r\nMA,IN,0,VER\r\nMA,IN,0,VER\r\n");
+    CU_ASSERT_EQUAL(scpi_context.buffer.position, 0);
+    output_buffer_clear();
+
     TEST_INPUT("*IDN?;*IDN?;*IDN?;*IDN?\r\n", "MA,IN,0,VER;MA,IN,0,VER;MA,IN,0,VER;MA,IN,0,VER\r\n");
     output_buffer_clear();
 
@@ -229,10 +403,57 @@ static void testCommandsHandling(void) {
     /* Test ctree traversal */
     TEST_INPUT("TEST:TREEA?;TREEB?\r\n", "10;20\r\n");
     output_buffer_clear();
+    CU_ASSERT_EQUAL(SCPI_CmdId(&scpi_context), SCPI_CommandId(scpi_commands, "TEST:TREEB?"));
+    CU_ASSERT_EQUAL(scpi_context.param_list.cmd, &scpi_commands[SCPI_CmdId(&scpi_context)]);
+    CU_ASSERT_EQUAL(SCPI_CommandId(scpi_commands, "*CLS"), 0);
+    CU_ASSERT_EQUAL(SCPI_CommandId(scpi_commands, "TEST:TREEC?"), -1);
+
+    TEST_INPUT("STAT:QUES:ENAB 4;ENAB?;EVEN?;:TEST:TREEB?;TREEA?;TREEB?\r\n", "4;0;20;10;20\r\n");
+    output_buffer_clear();
+
+    /* numeric suffixes, also of keywords inherited in compound message */
+    TEST_INPUT("TEST:NUM2:SUFF3:LAST4?;LAST?;:TEST:NUM:LAST5?;:TEST:NUMBERS12:LAST?\r\n", "2,3,4,3;2,3,-1,3;-1,-1,5,7;12,-1,-1,7\r\n");
+    output_buffer_clear();
 
     TEST_INPUT("TEST:TREEA?;:TEXT? \"PARAM1\", \"PARAM2\"\r\n", "10;\"PARAM2\"\r\n");
     output_buffer_clear();
 
+    /* message received in pieces, terminators inside of parameters */
+    {
+        const char * message = "TEST:TREEA?;:TEXT? \"A;B\", \"C;D\";*ESE 1;*IDN?\r\n*ESE?\r\n";
+        size_t i;
+
+        for (i = 0; message[i]; i++) {
+            SCPI_Input(&scpi_context, &message[i], 1);
+        }
+        CU_ASSERT_STRING_EQUAL("10;\"C;D\";MA,IN,0,VER\r\n1\r\n", output_buffer);
+        output_buffer_clear();
+    }
+
+    /* arbitrary block written in parts */
+    TEST_INPUT("TEST:BLOC? 4\r\n", "#14abcd\r\n");
+    output_buffer_clear();
+    TEST_INPUT("TEST:BLOC? -1\r\n", "#0abcd\r\n");
+    output_buffer_clear();
+
+    /* parameters tokenized while detecting the message unit */
+#if USE_PARAMETER_CACHE
+    hits = scpi_context.parser_state.parameterHits;
+    misses = scpi_context.parser_state.parameterMisses;
+#endif /* USE_PARAMETER_CACHE */
+    TEST_INPUT("TEST:PAR? 1.5 mV, 2, 10 ,#H10;PAR? 3V,4\r\n", "0.0015,1,2,10,0,16;3,1,4\r\n");
+    output_buffer_clear();
+#if USE_PARAMETER_CACHE
+    CU_ASSERT_EQUAL(scpi_context.parser_state.parameterHits, hits + 6);
+    CU_ASSERT_EQUAL(scpi_context.parser_state.parameterMisses, misses);
+
+    /* more parameters than cached are lexed again */
+    TEST_INPUT("TEST:PAR? 1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9\r\n", "1,0,1,2,0,2,3,0,3,4,0,4,5,0,5,6,0,6,7,0,7,8,0,8,9,0,9\r\n");
+    output_buffer_clear();
+    CU_ASSERT_EQUAL(scpi_context.parser_state.parameterHits, hits + 6 + SCPI_PARAMETER_CACHE_SIZE);
+    CU_ASSERT_EQUAL(scpi_context.parser_state.parameterMisses, misses + 18 - SCPI_PARAMETER_CACHE_SIZE);
+#endif /* USE_PARAMETER_CACHE */
+
     CU_ASSERT_EQUAL(err_buffer_pos, 0);
     error_buffer_clear();
 }
@@ -255,6 +476,26 @@ static void testErrorHandling(void) {
     TEST_ERROR("*ESE\r\n", "", FALSE, SCPI_ERROR_MISSING_PARAMETER);
     TEST_ERROR("*IDN? 12\r\n", "MA,IN,0,VER\r\n", FALSE, SCPI_ERROR_PARAMETER_NOT_ALLOWED);
     TEST_ERROR("TEXT? \"PARAM1\", \"PARAM2\"\r\n", "\"PARAM2\"\r\n", TRUE, 0);
+    TEST_ERROR("TEXT? \"PARAM1\" \"PARAM2\" X;*IDN?\r\n", "MA,IN,0,VER\r\n", FALSE, SCPI_ERROR_INVALID_CHARACTER);
+    CU_ASSERT_EQUAL(err_buffer_pos, 1);
+    TEST_ERROR("*IDN?;;*IDN?\r\n", "MA,IN,0,VER;MA,IN,0,VER\r\n", TRUE, 0);
+    TEST_ERROR("TEST:NUM4294967297:LAST2?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+    TEST_ERROR("TEST:NUM1:LAST99999999999?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+
+    /* header of SCPI_HEADER_LENGTH characters is the longest one accepted */
+    {
+        char message[SCPI_HEADER_LENGTH + 8];
+        size_t zeros = SCPI_HEADER_LENGTH - strlen("TEST:NUM1:LAST?");
+
+        memcpy(message, "TEST:NUM", 8);
+        memset(message + 8, '0', zeros);
+        strcpy(message + 8 + zeros, "1:LAST?\r\n");
+        TEST_ERROR(message, "1,-1,-1,7\r\n", TRUE, 0);
+
+        memmove(message + 9, message + 8, strlen(message + 8) + 1);
+        TEST_ERROR(message, "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+    }
+
     TEST_ERROR("ABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJ"
                "ABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJ"
                "ABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJABCDEFGHIJ",
@@ -318,6 +559,206 @@ static void testIEEE4882(void) {
     TEST_IEEE4882("SYSTem:VERSion?\r\n", "1999.0\r\n");
 }
 
+static void testCommandIndex(void) {
+    scpi_command_node_t nodes[64];
+    scpi_command_index_t index;
+    size_t count;
+
+    CU_ASSERT_FALSE(SCPI_CommandIndexBuild(&index, scpi_commands, nodes, 8));
+    CU_ASSERT_TRUE(SCPI_CommandIndexBuild(&index, scpi_commands, nodes, 64));
+    CU_ASSERT_EQUAL(index.cmdlist, scpi_commands);
+
+    /* size from SCPI_CommandIndexNodes is always enough */
+    count = index.count;
+    CU_ASSERT_TRUE(SCPI_CommandIndexNodes(scpi_commands) >= count);
+    CU_ASSERT_FALSE(SCPI_CommandIndexBuild(&index, scpi_commands, nodes, count - 1));
+    CU_ASSERT_TRUE(SCPI_CommandIndexBuild(&index, scpi_commands, nodes, count));
+    CU_ASSERT_EQUAL(SCPI_CommandIndexNodes(slot_commands), 3);
+
+    scpi_context.cmdindex = &index;
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    TEST_INPUT("*IDN?\r\n", "MA,IN,0,VER\r\n");
+    output_buffer_clear();
+
+    TEST_INPUT("*ESE 4;*ESE?\r\n", "4\r\n");
+    output_buffer_clear();
+
+    TEST_INPUT("TEST:TREEA?;TREEB?\r\n", "10;20\r\n");
+    output_buffer_clear();
+
+    TEST_INPUT("test:treea?;:TEXTfunction? \"PARAM1\", \"PARAM2\"\r\n", "10;\"PARAM2\"\r\n");
+    output_buffer_clear();
+
+    TEST_INPUT("STAT:QUES?;:STATus:QUEStionable:EVENt?\r\n", "0;0\r\n");
+    output_buffer_clear();
+
+    TEST_INPUT("syst:err?;:system:error:next?\r\n", "0,\"No error\";0,\"No error\"\r\n");
+    output_buffer_clear();
+
+    /* relative headers continue from the node of previous header */
+    TEST_INPUT("STAT:QUES:ENAB 4;ENAB?;EVEN?;:TEST:TREEB?;TREEA?;TREEB?\r\n", "4;0;20;10;20\r\n");
+    output_buffer_clear();
+
+    /* numeric suffixes, also of keywords inherited in compound message */
+    TEST_INPUT("TEST:NUM2:SUFF3:LAST4?;LAST?;:TEST:NUM:LAST5?;:TEST:NUMBERS12:LAST?\r\n", "2,3,4,3;2,3,-1,3;-1,-1,5,7;12,-1,-1,7\r\n");
+    output_buffer_clear();
+
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+    error_buffer_clear();
+
+    TEST_ERROR("TEST:TREEA?;TREEC?\r\n", "10\r\n", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+    output_buffer_clear();
+    TEST_ERROR("TEST:TREEC?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+    TEST_ERROR("TEST:TREEA\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+    TEST_ERROR("TREEA?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+    TEST_ERROR("SYST:ERR:NEXT:NEXT?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+    TEST_ERROR("TEST:NUM4294967297:LAST2?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+    TEST_ERROR("TEST:NUM1:LAST99999999999?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+
+    /* index built for other command list is ignored */
+    index.cmdlist = NULL;
+    TEST_ERROR("*IDN?\r\n", "MA,IN,0,VER\r\n", TRUE, 0);
+
+    scpi_context.cmdindex = NULL;
+    output_buffer_clear();
+    error_buffer_clear();
+}
+
+static void testDispatchCache(void) {
+#if USE_DISPATCH_CACHE || USE_MESSAGE_CACHE
+    scpi_dispatch_cache_t * cache = &scpi_context.dispatch_cache;
+#if USE_MESSAGE_CACHE
+    uint32_t hits;
+#endif
+
+    SCPI_DispatchCacheClear(&scpi_context);
+    output_buffer_clear();
+    error_buffer_clear();
+
+    TEST_INPUT("TEST:TREEA?;TREEB?\r\n", "10;20\r\n");
+    output_buffer_clear();
+#if USE_DISPATCH_CACHE
+    CU_ASSERT_EQUAL(cache->hits, 0);
+    CU_ASSERT_EQUAL(cache->misses, 2);
+#endif
+#if USE_MESSAGE_CACHE
+    CU_ASSERT_EQUAL(cache->message_hits, 0);
+    CU_ASSERT_EQUAL(cache->message_misses, 1);
+#endif
+
+    TEST_INPUT("TEST:TREEA?;TREEB?\r\n", "10;20\r\n");
+    output_buffer_clear();
+#if USE_MESSAGE_CACHE
+    CU_ASSERT_EQUAL(cache->message_hits, 1);
+    CU_ASSERT_EQUAL(cache->message_misses, 1);
+#elif USE_DISPATCH_CACHE
+    CU_ASSERT_EQUAL(cache->hits, 2);
+    CU_ASSERT_EQUAL(cache->misses, 2);
+#endif
+
+    /* same headers in different message */
+    TEST_INPUT("test:treeb?;:TEST:TREEA?\r\n", "20;10\r\n");
+    output_buffer_clear();
+    TEST_INPUT("TEST:TREEB?;TREEA?\r\n", "20;10\r\n");
+    output_buffer_clear();
+#if USE_DISPATCH_CACHE && !USE_MESSAGE_CACHE
+    /* headers are upper-cased, absolute header is the same as relative one */
+    CU_ASSERT_EQUAL(cache->hits, 6);
+    CU_ASSERT_EQUAL(cache->misses, 2);
+#endif
+
+    /* undefined header is never remembered */
+    TEST_ERROR("TEST:TREEC?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+    TEST_ERROR("TEST:TREEC?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+
+    /* change of command list is detected */
+    output_buffer_clear();
+    scpi_context.cmdlist = &scpi_commands[1];
+    TEST_INPUT("*IDN?\r\n", "MA,IN,0,VER\r\n");
+    output_buffer_clear();
+    TEST_INPUT("*IDN?\r\n", "MA,IN,0,VER\r\n");
+    output_buffer_clear();
+    scpi_context.cmdlist = scpi_commands;
+    CU_ASSERT_EQUAL(cache->cmdlist, &scpi_commands[1]);
+    TEST_INPUT("*IDN?\r\n", "MA,IN,0,VER\r\n");
+    CU_ASSERT_EQUAL(cache->cmdlist, scpi_commands);
+    output_buffer_clear();
+
+#if USE_MESSAGE_CACHE
+    /* message following another one in the input buffer */
+    hits = cache->message_hits;
+    TEST_INPUT("TEST:TREEA?;TREEB?\r\nTEST:TREEA?;TREEB?\r\n", "10;20\r\n10;20\r\n");
+    output_buffer_clear();
+    CU_ASSERT_EQUAL(cache->message_hits, hits + 1);
+#endif
+
+    error_buffer_clear();
+#endif
+}
+
+static void testCommandTables(void) {
+    scpi_command_table_t slot2;
+    scpi_command_table_t root;
+    scpi_command_node_t nodes[8];
+    scpi_command_index_t index;
+    scpi_pattern_t pattern;
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    CU_ASSERT_TRUE(SCPI_CommandTableAdd(&scpi_context, &slot2, slot_commands, "SLOT2"));
+    CU_ASSERT_FALSE(SCPI_CommandTableAdd(&scpi_context, &slot2, slot_commands, "SLOT2"));
+    CU_ASSERT_FALSE(SCPI_CommandTableAdd(&scpi_context, &root, slot_commands, "[:SLOT]"));
+    CU_ASSERT_FALSE(SCPI_CommandTableAdd(&scpi_context, &root, slot_commands, "SLOT#"));
+
+    TEST_INPUT("SLOT2:VOLT?;CURR3?;:SLOT2:CURRENT?;:TEST:TREEA?\r\n", "30;3;1;10\r\n");
+    output_buffer_clear();
+    CU_ASSERT_EQUAL(SCPI_CmdTable(&scpi_context), NULL);
+
+    TEST_INPUT("SLOT2:CURR5?\r\n", "5\r\n");
+    output_buffer_clear();
+    CU_ASSERT_EQUAL(SCPI_CmdTable(&scpi_context), &slot2);
+    CU_ASSERT_EQUAL(SCPI_CmdId(&scpi_context), 1);
+
+    /* the same list without prefix and with index */
+    TEST_ERROR("VOLT?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+    CU_ASSERT_TRUE(SCPI_CommandTableAdd(&scpi_context, &root, slot_commands, NULL));
+    CU_ASSERT_TRUE(SCPI_CommandIndexBuild(&index, slot_commands, nodes, 8));
+    root.cmdindex = &index;
+    TEST_ERROR("VOLT?;CURR2?\r\n", "30;2\r\n", TRUE, 0);
+    CU_ASSERT_EQUAL(SCPI_CmdTable(&scpi_context), &root);
+
+    /* index has to be installed again after the table is added again */
+    CU_ASSERT_TRUE(SCPI_CommandTableRemove(&scpi_context, &root));
+    CU_ASSERT_TRUE(SCPI_CommandTableAdd(&scpi_context, &root, slot_commands, NULL));
+    CU_ASSERT_EQUAL(root.cmdindex, NULL);
+    TEST_ERROR("VOLT?\r\n", "30\r\n", TRUE, 0);
+    root.cmdindex = &index;
+
+    CU_ASSERT_TRUE(SCPI_CommandTableRemove(&scpi_context, &slot2));
+    CU_ASSERT_FALSE(SCPI_CommandTableRemove(&scpi_context, &slot2));
+    TEST_ERROR("SLOT2:VOLT?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+    TEST_ERROR("VOLT?\r\n", "30\r\n", TRUE, 0);
+
+    CU_ASSERT_TRUE(SCPI_CommandTableRemove(&scpi_context, &root));
+    CU_ASSERT_EQUAL(scpi_context.tables, NULL);
+    TEST_ERROR("VOLT?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+
+    /* patterns are matched even if they can't be compiled */
+    CU_ASSERT_FALSE(SCPI_PatternCompile(&pattern, long_commands[0].pattern));
+    CU_ASSERT_FALSE(SCPI_PatternCompile(&pattern, long_commands[1].pattern));
+    CU_ASSERT_TRUE(SCPI_CommandTableAdd(&scpi_context, &root, long_commands, NULL));
+    TEST_ERROR("LONG:L:VOLT?;:LONG:A:K:VOLTAGE?;:UNB:VOLT?\r\n", "30;30;30\r\n", TRUE, 0);
+    TEST_ERROR("LONG:L:K:VOLT?\r\n", "", FALSE, SCPI_ERROR_UNDEFINED_HEADER);
+    CU_ASSERT_TRUE(SCPI_CommandTableRemove(&scpi_context, &root));
+
+    output_buffer_clear();
+    error_buffer_clear();
+}
+
 #define TEST_ParamInt32(data, mandatory, expected_value, expected_result, expected_error_code) \
 {                                                                                       \
     int32_t value;                                                                      \
@@ -355,6 +796,11 @@ static void testSCPI_ParamInt32(void) {
     // test range
     TEST_ParamInt32("2147483647", TRUE, 2147483647, TRUE, 0);
     TEST_ParamInt32("-2147483647", TRUE, -2147483647, TRUE, 0);
+    TEST_ParamInt32("-2147483648", TRUE, INT32_MIN, TRUE, 0);
+    TEST_ParamInt32("2147483648", TRUE, 0, FALSE, -222);
+    TEST_ParamInt32("-2147483649", TRUE, 0, FALSE, -222);
+    TEST_ParamInt32("#HFFFFFFFF", TRUE, -1, TRUE, 0);
+    TEST_ParamInt32("#H100000000", TRUE, 0, FALSE, -222);
 }
 
 #define TEST_ParamUInt32(data, mandatory, expected_value, expected_result, expected_error_code) \
@@ -394,6 +840,10 @@ static void testSCPI_ParamUInt32(void) {
     // test range
     TEST_ParamUInt32("2147483647", TRUE, 2147483647, TRUE, 0);
     TEST_ParamUInt32("4294967295", TRUE, 4294967295, TRUE, 0);
+    TEST_ParamUInt32("4294967296", TRUE, 0, FALSE, -222);
+    TEST_ParamUInt32("-1", TRUE, 0, FALSE, -222);
+    TEST_ParamUInt32("#B11111111111111111111111111111111", TRUE, 4294967295, TRUE, 0);
+    TEST_ParamUInt32("#Q40000000000", TRUE, 0, FALSE, -222);
 }
 
 #define TEST_ParamInt64(data, mandatory, expected_value, expected_result, expected_error_code) \
@@ -435,6 +885,8 @@ static void testSCPI_ParamInt64(void) {
     TEST_ParamInt64("-2147483647", TRUE, -2147483647LL, TRUE, 0);
     TEST_ParamInt64("9223372036854775807", TRUE, 9223372036854775807LL, TRUE, 0);
     TEST_ParamInt64("-9223372036854775807", TRUE, -9223372036854775807LL, TRUE, 0);
+    TEST_ParamInt64("9223372036854775808", TRUE, 0, FALSE, -222);
+    TEST_ParamInt64("-9223372036854775809", TRUE, 0, FALSE, -222);
 }
 
 #define TEST_ParamUInt64(data, mandatory, expected_value, expected_result, expected_error_code) \
@@ -476,6 +928,9 @@ static void testSCPI_ParamUInt64(void) {
     TEST_ParamUInt64("4294967295", TRUE, 4294967295, TRUE, 0);
     TEST_ParamUInt64("9223372036854775807", TRUE, 9223372036854775807ULL, TRUE, 0);
     TEST_ParamUInt64("18446744073709551615", TRUE, 18446744073709551615ULL, TRUE, 0);
+    TEST_ParamUInt64("18446744073709551616", TRUE, 0, FALSE, -222);
+    TEST_ParamUInt64("#HFFFFFFFFFFFFFFFF", TRUE, 18446744073709551615ULL, TRUE, 0);
+    TEST_ParamUInt64("#H10000000000000000", TRUE, 0, FALSE, -222);
 }
 
 
@@ -702,6 +1157,120 @@ static void testNumericList(void) {
     TEST_NumericListDouble("(12,5:6:3)", 2, FALSE, 0, 0, SCPI_EXPR_ERROR, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
 }
 
+static void setExpressionParameter(const char * data, scpi_parameter_t * param) {
+    SCPI_CoreCls(&scpi_context);
+    scpi_context.input_count = 0;
+    scpi_context.param_list.expr_list.ptr = NULL;
+    scpi_context.param_list.lex_state.buffer = data;
+    scpi_context.param_list.lex_state.len = strlen(data);
+    scpi_context.param_list.lex_state.pos = data;
+    CU_ASSERT_TRUE(SCPI_Parameter(&scpi_context, param, TRUE));
+}
+
+static void testNumericListIterator(void) {
+    static char data[8000];
+    scpi_parameter_t param;
+    scpi_parameter_t from;
+    scpi_parameter_t to;
+    scpi_expr_list_t list;
+    scpi_bool_t range[7];
+    int32_t valuesFrom[7];
+    int32_t valuesTo[7];
+    double doubleFrom[2];
+    double doubleTo[2];
+    scpi_bool_t isRange;
+    int32_t valueFrom;
+    int32_t valueTo;
+    size_t count;
+    size_t total;
+    size_t pos;
+    int i;
+
+    /* (0,1:2,2,3:4,...) */
+    pos = 0;
+    data[pos++] = '(';
+    for (i = 0; i < 1000; i++) {
+        if (i % 2) {
+            pos += sprintf(data + pos, "%d:%d,", i, i + 1);
+        } else {
+            pos += sprintf(data + pos, "%d,", i);
+        }
+    }
+    data[pos - 1] = ')';
+    data[pos] = '\0';
+
+    /* index based access in increasing order */
+    setExpressionParameter(data, &param);
+    for (i = 0; i < 1000; i++) {
+        CU_ASSERT_EQUAL(SCPI_ExprNumericListEntryInt(&scpi_context, &param, i, &isRange, &valueFrom, &valueTo), SCPI_EXPR_OK);
+        CU_ASSERT_EQUAL(isRange, (i % 2) ? TRUE : FALSE);
+        CU_ASSERT_EQUAL(valueFrom, i);
+        if (isRange) {
+            CU_ASSERT_EQUAL(valueTo, i + 1);
+        }
+    }
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListEntryInt(&scpi_context, &param, 1000, &isRange, &valueFrom, &valueTo), SCPI_EXPR_NO_MORE);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListEntryInt(&scpi_context, &param, 5, &isRange, &valueFrom, &valueTo), SCPI_EXPR_OK);
+    CU_ASSERT_EQUAL(valueFrom, 5);
+    CU_ASSERT_EQUAL(valueTo, 6);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListEntryInt(&scpi_context, &param, 4, &isRange, &valueFrom, &valueTo), SCPI_EXPR_OK);
+    CU_ASSERT_EQUAL(isRange, FALSE);
+    CU_ASSERT_EQUAL(valueFrom, 4);
+
+    /* bulk decoding in chunks */
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListBegin(&scpi_context, &param, &list), SCPI_EXPR_OK);
+    total = 0;
+    do {
+        count = 0;
+        CU_ASSERT(SCPI_ExprNumericListReadInt(&scpi_context, &list, range, valuesFrom, valuesTo, 7, &count) != SCPI_EXPR_ERROR);
+        for (pos = 0; pos < count; pos++) {
+            CU_ASSERT_EQUAL(range[pos], ((total + pos) % 2) ? TRUE : FALSE);
+            CU_ASSERT_EQUAL(valuesFrom[pos], (int32_t) (total + pos));
+            CU_ASSERT_EQUAL(valuesTo[pos], (int32_t) (total + pos + range[pos]));
+        }
+        total += count;
+    } while (count == 7);
+    CU_ASSERT_EQUAL(total, 1000);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListReadInt(&scpi_context, &list, range, valuesFrom, valuesTo, 7, &count), SCPI_EXPR_NO_MORE);
+    CU_ASSERT_EQUAL(count, 0);
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+
+    /* end of list detected when the arrays are just filled */
+    setExpressionParameter("(1.5:2,-3)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListBegin(&scpi_context, &param, &list), SCPI_EXPR_OK);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListReadDouble(&scpi_context, &list, range, doubleFrom, doubleTo, 2, &count), SCPI_EXPR_NO_MORE);
+    CU_ASSERT_EQUAL(count, 2);
+    CU_ASSERT_EQUAL(range[0], TRUE);
+    CU_ASSERT_DOUBLE_EQUAL(doubleFrom[0], 1.5, 0.0001);
+    CU_ASSERT_DOUBLE_EQUAL(doubleTo[0], 2, 0.0001);
+    CU_ASSERT_EQUAL(range[1], FALSE);
+    CU_ASSERT_DOUBLE_EQUAL(doubleFrom[1], -3, 0.0001);
+    CU_ASSERT_DOUBLE_EQUAL(doubleTo[1], -3, 0.0001);
+
+    /* entry by entry, error ends the list */
+    setExpressionParameter("(12,5:6:3)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListBegin(&scpi_context, &param, &list), SCPI_EXPR_OK);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListNext(&scpi_context, &list, &isRange, &from, &to), SCPI_EXPR_OK);
+    CU_ASSERT_EQUAL(isRange, FALSE);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListNext(&scpi_context, &list, &isRange, &from, &to), SCPI_EXPR_OK);
+    CU_ASSERT_EQUAL(isRange, TRUE);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListNext(&scpi_context, &list, &isRange, &from, &to), SCPI_EXPR_ERROR);
+    CU_ASSERT_EQUAL(SCPI_ErrorPop(&scpi_context), SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListNext(&scpi_context, &list, &isRange, &from, &to), SCPI_EXPR_NO_MORE);
+    CU_ASSERT_EQUAL(SCPI_ErrorCount(&scpi_context), 0);
+
+    setExpressionParameter("(1,2)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListBegin(&scpi_context, &param, &list), SCPI_EXPR_OK);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListReadInt(&scpi_context, &list, range, valuesFrom, valuesTo, 7, &count), SCPI_EXPR_NO_MORE);
+    CU_ASSERT_EQUAL(count, 2);
+
+    /* not an expression, the list is empty */
+    setExpressionParameter("12", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListBegin(&scpi_context, &param, &list), SCPI_EXPR_ERROR);
+    CU_ASSERT_EQUAL(SCPI_ErrorPop(&scpi_context), SCPI_ERROR_DATA_TYPE_ERROR);
+    CU_ASSERT_EQUAL(SCPI_ExprNumericListNext(&scpi_context, &list, &isRange, &from, &to), SCPI_EXPR_NO_MORE);
+}
+
 #define NOPAREN(...) __VA_ARGS__
 
 #define TEST_ChannelList(data, index, val_len, expected_range, expected_dimensions, _expected_from, _expected_to, expected_result, expected_error_code) \
@@ -770,6 +1339,87 @@ static void testChannelList(void) {
     TEST_ChannelList("(@1, 2)", 1, 1, FALSE, 0, (0), (0), SCPI_EXPR_ERROR, SCPI_ERROR_EXPRESSION_PARSING_ERROR);
 }
 
+static void testChannelListFlat(void) {
+    scpi_parameter_t param;
+    scpi_channel_geometry_t geometry;
+    int32_t values[16];
+    uint32_t bits[3];
+    size_t count;
+    int32_t expected2[] = {1, 1, 1, 2, 2, 1, 2, 2, 3, 2, 3, 1, 7, 5};
+    int32_t expected1[] = {5, 4, 3, 9};
+
+    setExpressionParameter("(@1!1:2!2,3!2:3!1,7!5)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprChannelListFlat(&scpi_context, &param, values, 2, 8, &count), SCPI_EXPR_OK);
+    CU_ASSERT_EQUAL(count, 7);
+    CU_ASSERT_EQUAL(memcmp(values, expected2, sizeof (expected2)), 0);
+
+    setExpressionParameter("(@5:3,9)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprChannelListFlat(&scpi_context, &param, values, 1, 16, &count), SCPI_EXPR_OK);
+    CU_ASSERT_EQUAL(count, 4);
+    CU_ASSERT_EQUAL(memcmp(values, expected1, sizeof (expected1)), 0);
+
+    setExpressionParameter("(@1:20)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprChannelListFlat(&scpi_context, &param, values, 1, 16, &count), SCPI_EXPR_ERROR);
+    CU_ASSERT_EQUAL(count, 16);
+    CU_ASSERT_EQUAL(SCPI_ErrorPop(&scpi_context), SCPI_ERROR_TOO_MUCH_DATA);
+
+    setExpressionParameter("(@1!2,3)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprChannelListFlat(&scpi_context, &param, values, 2, 16, &count), SCPI_EXPR_ERROR);
+    CU_ASSERT_EQUAL(SCPI_ErrorPop(&scpi_context), SCPI_ERROR_ILLEGAL_PARAMETER_VALUE);
+
+    setExpressionParameter("(@1!2,)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprChannelListFlat(&scpi_context, &param, values, 2, 16, &count), SCPI_EXPR_OK);
+    CU_ASSERT_EQUAL(count, 1);
+
+    setExpressionParameter("(@1!2 3)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprChannelListFlat(&scpi_context, &param, values, 2, 16, &count), SCPI_EXPR_ERROR);
+    CU_ASSERT_EQUAL(SCPI_ErrorPop(&scpi_context), SCPI_ERROR_EXPRESSION_PARSING_ERROR);
+
+    /* 3 x 32 matrix, rows 1 to 3, columns 0 to 31 */
+    geometry.dimensions = 2;
+    geometry.first[0] = 1;
+    geometry.size[0] = 3;
+    geometry.first[1] = 0;
+    geometry.size[1] = 32;
+
+    setExpressionParameter("(@1!4:1!9,3!0:2!31,1!31)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprChannelListBitset(&scpi_context, &param, &geometry, bits, 3), SCPI_EXPR_OK);
+    CU_ASSERT_EQUAL(bits[0], 0x800003F0);
+    CU_ASSERT_EQUAL(bits[1], 0xFFFFFFFF);
+    CU_ASSERT_EQUAL(bits[2], 0xFFFFFFFF);
+
+    /* runs crossing word boundary */
+    geometry.first[1] = 1;
+    geometry.size[1] = 20;
+    setExpressionParameter("(@1!20:2!1,3!5)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprChannelListBitset(&scpi_context, &param, &geometry, bits, 2), SCPI_EXPR_OK);
+    CU_ASSERT_EQUAL(bits[0], 0xFFFFFFFF);
+    CU_ASSERT_EQUAL(bits[1], 0x000010FF);
+
+    setExpressionParameter("(@1!1:1!21)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprChannelListBitset(&scpi_context, &param, &geometry, bits, 2), SCPI_EXPR_ERROR);
+    CU_ASSERT_EQUAL(SCPI_ErrorPop(&scpi_context), SCPI_ERROR_DATA_OUT_OF_RANGE);
+
+    CU_ASSERT_EQUAL(SCPI_ExprChannelListBitset(&scpi_context, &param, &geometry, bits, 1), SCPI_EXPR_ERROR);
+    CU_ASSERT_EQUAL(SCPI_ErrorPop(&scpi_context), SCPI_ERROR_SYSTEM_ERROR);
+
+    /* channel count of geometry overflows size_t */
+    geometry.dimensions = 3;
+    geometry.first[0] = 0;
+    geometry.size[0] = INT32_MAX;
+    geometry.first[1] = 0;
+    geometry.size[1] = INT32_MAX;
+    geometry.first[2] = 0;
+    geometry.size[2] = INT32_MAX;
+    setExpressionParameter("(@1!1!1)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprChannelListBitset(&scpi_context, &param, &geometry, bits, SIZE_MAX), SCPI_EXPR_ERROR);
+    CU_ASSERT_EQUAL(SCPI_ErrorPop(&scpi_context), SCPI_ERROR_SYSTEM_ERROR);
+
+    setExpressionParameter("(@1!2)", &param);
+    CU_ASSERT_EQUAL(SCPI_ExprChannelListFlat(&scpi_context, &param, values, 2, SIZE_MAX, &count), SCPI_EXPR_ERROR);
+    CU_ASSERT_EQUAL(SCPI_ErrorPop(&scpi_context), SCPI_ERROR_SYSTEM_ERROR);
+}
+
 
 #define TEST_ParamNumber(data, mandatory, expected_special, expected_tag, expected_value, expected_unit, expected_base, expected_result, expected_error_code) \
 {                                                                                       \
@@ -796,6 +1446,502 @@ static void testChannelList(void) {
     CU_ASSERT_EQUAL(errCode, expected_error_code);                                      \
 }
 
+static void testBlockStream(void) {
+#if USE_ARBITRARY_BLOCK_STREAM
+    char block[1000];
+    static char message[sizeof (block) + 256];
+    size_t len;
+    size_t chunk;
+    size_t i;
+    int32_t channel;
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    for (i = 0; i < sizeof (block); i++) {
+        block[i] = (char) (i * 7);
+    }
+
+    /* whole block received at once */
+    TEST_INPUT("TEST:BLOC 1,#15a;\nb;;*IDN?\r\n", "5;MA,IN,0,VER\r\n");
+    output_buffer_clear();
+    CU_ASSERT_EQUAL(stream_len, 5);
+    CU_ASSERT_EQUAL(memcmp(stream_buffer, "a;\nb;", 5), 0);
+
+    /* block larger than input buffer, received in pieces */
+    for (channel = 1; channel <= 2; channel++) {
+        for (chunk = 1; chunk <= 13; chunk += 6) {
+            len = sprintf(message, "TEST:BLOC %d,#41000", (int) channel);
+            memcpy(message + len, block, sizeof (block));
+            len += sizeof (block);
+            memcpy(message + len, "\r\n", 2);
+            len += 2;
+
+            for (i = 0; i < len; i += chunk) {
+                SCPI_Input(&scpi_context, message + i, (len - i < chunk) ? len - i : chunk);
+            }
+            CU_ASSERT_STRING_EQUAL("1000\r\n", output_buffer);
+            output_buffer_clear();
+            CU_ASSERT_EQUAL(stream_len, sizeof (block));
+            CU_ASSERT_EQUAL(memcmp(stream_buffer, block, sizeof (block)), 0);
+            CU_ASSERT_EQUAL(stream_direct, (channel == 2) ? sizeof (block) : 0);
+        }
+    }
+
+    /* '#' of numbers before the block, received in pieces */
+    for (chunk = 1; chunk <= 13; chunk += 6) {
+        len = sprintf(message, "TEST:BLOC #H2");
+        for (i = 0; i < 16; i++) {
+            len += sprintf(message + len, ",#H%X,#B1%d", (unsigned) i, (int) (i & 1));
+        }
+        len += sprintf(message + len, ",#41000");
+        CU_ASSERT_TRUE_FATAL(len + sizeof (block) + 2 <= sizeof (message));
+        memcpy(message + len, block, sizeof (block));
+        len += sizeof (block);
+        memcpy(message + len, "\r\n", 2);
+        len += 2;
+
+        for (i = 0; i < len; i += chunk) {
+            SCPI_Input(&scpi_context, message + i, (len - i < chunk) ? len - i : chunk);
+        }
+        CU_ASSERT_STRING_EQUAL("1000\r\n", output_buffer);
+        output_buffer_clear();
+        CU_ASSERT_EQUAL(stream_len, sizeof (block));
+        CU_ASSERT_EQUAL(memcmp(stream_buffer, block, sizeof (block)), 0);
+        CU_ASSERT_EQUAL(stream_direct, sizeof (block));
+    }
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+
+    /* block of indefinite length is terminated by new line */
+    for (i = 0; i < sizeof (block); i++) {
+        if (block[i] == '\n') {
+            block[i] = 'x';
+        }
+    }
+    for (chunk = 1; chunk <= 13; chunk += 6) {
+        len = sprintf(message, "TEST:BLOC 1,#0");
+        memcpy(message + len, block, sizeof (block));
+        len += sizeof (block);
+        memcpy(message + len, "\n", 1);
+        len += 1;
+
+        for (i = 0; i < len; i += chunk) {
+            SCPI_Input(&scpi_context, message + i, (len - i < chunk) ? len - i : chunk);
+        }
+        CU_ASSERT_STRING_EQUAL("1000\r\n", output_buffer);
+        output_buffer_clear();
+        CU_ASSERT_EQUAL(memcmp(stream_buffer, block, sizeof (block)), 0);
+    }
+    TEST_INPUT("TEST:BLOC 1,#0a;b\r\n", "4\r\n");
+    output_buffer_clear();
+
+    /* or by the end of input */
+    TEST_INPUT("TEST:BLOC 1,#0abc", "");
+    TEST_INPUT("", "3\r\n");
+    output_buffer_clear();
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+
+    /* message ends by incomplete block */
+    TEST_INPUT("TEST:BLOC 1,#41000abc", "");
+    TEST_INPUT("", "");
+    CU_ASSERT_EQUAL(err_buffer_pos, 1);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_INVALID_BLOCK_DATA);
+
+    output_buffer_clear();
+    error_buffer_clear();
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+}
+
+/**
+ * Pass data to the parser through SCPI_InputReserve and SCPI_InputCommit
+ * @param data
+ * @param len
+ * @param chunk - maximal length of one commit
+ * @return FALSE if the input buffer overflowed
+ */
+static scpi_bool_t inputReserved(const char * data, size_t len, size_t chunk) {
+    scpi_bool_t result = TRUE;
+    char * ptr;
+    size_t avail;
+    size_t n;
+
+    while (len > 0) {
+        result &= SCPI_InputReserve(&scpi_context, &ptr, &avail);
+        n = (len < chunk) ? len : chunk;
+        if (n > avail) {
+            n = avail;
+        }
+        memcpy(ptr, data, n);
+        SCPI_InputCommit(&scpi_context, n);
+        data += n;
+        len -= n;
+    }
+
+    return result;
+}
+
+static void testInputReserve(void) {
+    static char message[1100];
+    char block[1000];
+    char * ptr;
+    size_t avail;
+    size_t len;
+    size_t chunk;
+    size_t i;
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    for (chunk = 1; chunk <= 300; chunk += 11) {
+        CU_ASSERT_TRUE(inputReserved("*IDN?;*IDN?\r\nTEST:PAR? 1.5 mV, 2\r\n", 34, chunk));
+        CU_ASSERT_STRING_EQUAL("MA,IN,0,VER;MA,IN,0,VER\r\n0.0015,1,2\r\n", output_buffer);
+        output_buffer_clear();
+    }
+
+    /* executed units are dropped to make space */
+    len = 0;
+    for (i = 0; i < 60; i++) {
+        len += sprintf(message + len, "*IDN?;");
+    }
+    message[len - 1] = '\n';
+    CU_ASSERT_TRUE(inputReserved(message, len, 7));
+    CU_ASSERT_EQUAL(strlen(output_buffer), 60 * 12 + 1);
+    output_buffer_clear();
+
+#if USE_ARBITRARY_BLOCK_STREAM
+    /* block is passed to stream callback from the input buffer */
+    for (i = 0; i < sizeof (block); i++) {
+        block[i] = (char) (i * 7);
+    }
+    len = sprintf(message, "TEST:BLOC 1,#41000");
+    memcpy(message + len, block, sizeof (block));
+    len += sizeof (block);
+    len += sprintf(message + len, ";*IDN?\r\n");
+    for (chunk = 1; chunk <= 1000; chunk += 333) {
+        CU_ASSERT_TRUE(inputReserved(message, len, chunk));
+        CU_ASSERT_STRING_EQUAL("1000;MA,IN,0,VER\r\n", output_buffer);
+        output_buffer_clear();
+        CU_ASSERT_EQUAL(stream_len, sizeof (block));
+        CU_ASSERT_EQUAL(memcmp(stream_buffer, block, sizeof (block)), 0);
+    }
+#else
+    (void) block;
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+
+    /* unterminated unit larger than input buffer */
+    memset(message, 'A', 300);
+    CU_ASSERT_FALSE(inputReserved(message, 300, 100));
+    CU_ASSERT_EQUAL(err_buffer_pos, 1);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_INPUT_BUFFER_OVERRUN);
+    SCPI_Input(&scpi_context, "", 0);
+    error_buffer_clear();
+    SCPI_ErrorClear(&scpi_context);
+    output_buffer_clear();
+
+    /* more data than reserved */
+    CU_ASSERT_TRUE(SCPI_InputReserve(&scpi_context, &ptr, &avail));
+    CU_ASSERT_EQUAL(avail, SCPI_INPUT_BUFFER_LENGTH - 1);
+    CU_ASSERT_FALSE(SCPI_InputCommit(&scpi_context, avail + 1));
+    CU_ASSERT_EQUAL(err_buffer_pos, 1);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_SYSTEM_ERROR);
+    error_buffer_clear();
+    SCPI_ErrorClear(&scpi_context);
+}
+
+#define TEST_INPUT_VIEW(data, output, expected_consumed) {   \
+    size_t consumed;                                        \
+    SCPI_InputView(&scpi_context, data, strlen(data), &consumed);\
+    CU_ASSERT_EQUAL(consumed, expected_consumed);           \
+    CU_ASSERT_STRING_EQUAL(output, output_buffer);          \
+}
+
+static void testInputView(void) {
+    output_buffer_clear();
+    error_buffer_clear();
+
+    TEST_INPUT_VIEW("*IDN?\r\n*IDN?;*ID", "MA,IN,0,VER\r\nMA,IN,0,VER", 13);
+    TEST_INPUT_VIEW("*IDN?\r\n", "MA,IN,0,VER\r\nMA,IN,0,VER;MA,IN,0,VER\r\n", 7);
+    output_buffer_clear();
+
+    /* unterminated unit is left to the caller */
+    TEST_INPUT_VIEW("*IDN?", "", 0);
+
+    /* data pending in the input buffer are completed by SCPI_Input */
+    TEST_INPUT("*ID", "");
+    TEST_INPUT_VIEW("N?\r\n", "MA,IN,0,VER\r\n", 4);
+    output_buffer_clear();
+
+    /* invalid unit is executed with the rest of the message */
+    TEST_INPUT_VIEW("[;*IDN?\r\n", "MA,IN,0,VER\r\n", 9);
+    output_buffer_clear();
+    CU_ASSERT_EQUAL(err_buffer_pos, 1);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_INVALID_CHARACTER);
+    error_buffer_clear();
+    SCPI_ErrorClear(&scpi_context);
+
+#if USE_ARBITRARY_BLOCK_STREAM
+    /* block larger than input buffer is passed to the stream callback at once */
+    {
+        static char message[1100];
+        size_t len;
+        size_t consumed;
+
+        len = sprintf(message, "TEST:BLOC 1,#41000");
+        memset(message + len, 'x', 1000);
+        len += 1000;
+        len += sprintf(message + len, ";*IDN?\n*IDN");
+        CU_ASSERT_TRUE(SCPI_InputView(&scpi_context, message, len, &consumed));
+        CU_ASSERT_EQUAL(consumed, len - 4);
+        CU_ASSERT_STRING_EQUAL("1000;MA,IN,0,VER\r\n", output_buffer);
+        CU_ASSERT_EQUAL(stream_len, 1000);
+        output_buffer_clear();
+    }
+#endif /* USE_ARBITRARY_BLOCK_STREAM */
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+}
+
+#if USE_NUMERIC_LIST_STREAM
+static void testListStream(void) {
+    static char message[4100];
+    size_t len;
+    size_t chunk;
+    size_t i;
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    /* whole list received at once */
+    TEST_INPUT("TEST:LIST 1,2.5, 3e1 ;*IDN?\r\n", "3,33.5;MA,IN,0,VER\r\n");
+    output_buffer_clear();
+    TEST_INPUT("TEST:LIST\r\n", "0,0\r\n");
+    output_buffer_clear();
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+
+    /* list larger than input buffer, received in pieces */
+    len = sprintf(message, "*IDN?;TEST:LIST ");
+    for (i = 0; i < 1000; i++) {
+        len += sprintf(message + len, "%d,", (int) (i % 10));
+    }
+    len += sprintf(message + len, "1000;*IDN?\n");
+    for (chunk = 1; chunk <= 100; chunk += 33) {
+        for (i = 0; i < len; i += chunk) {
+            SCPI_Input(&scpi_context, message + i, (len - i < chunk) ? len - i : chunk);
+        }
+        CU_ASSERT_STRING_EQUAL("MA,IN,0,VER;1001,5500;MA,IN,0,VER\r\n", output_buffer);
+        output_buffer_clear();
+    }
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+
+    /* numbers are passed while the list is received */
+    TEST_INPUT("TEST:LIST 1,2,3,4,5,6", "");
+    CU_ASSERT_EQUAL(list_count, 4);
+    TEST_INPUT("\r\n", "6,21\r\n");
+    output_buffer_clear();
+
+    /* end of message ends the list */
+    TEST_INPUT("TEST:LIST 1, 2", "");
+    SCPI_Input(&scpi_context, "", 0);
+    CU_ASSERT_STRING_EQUAL("2,3\r\n", output_buffer);
+    output_buffer_clear();
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+
+    /* rest of invalid list is dropped */
+    TEST_INPUT("TEST:LIST 1,X,2,3", "");
+    TEST_INPUT(",4;*IDN?\r\n", "MA,IN,0,VER\r\n");
+    output_buffer_clear();
+    CU_ASSERT_EQUAL(err_buffer_pos, 1);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_DATA_TYPE_ERROR);
+    error_buffer_clear();
+
+    /* errors are the same when the list is received at once or in pieces */
+    for (chunk = 3; chunk <= 60; chunk += 57) {
+        strcpy(message, "TEST:LIST 1,,2\r\nTEST:LIST 1 2\r\nTEST:LIST 1,2 V\r\n");
+        len = strlen(message);
+        for (i = 0; i < len; i += chunk) {
+            SCPI_Input(&scpi_context, message + i, (len - i < chunk) ? len - i : chunk);
+        }
+        CU_ASSERT_EQUAL(err_buffer_pos, 3);
+        CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_INVALID_CHARACTER);
+        CU_ASSERT_EQUAL(err_buffer[1], SCPI_ERROR_INVALID_CHARACTER);
+        CU_ASSERT_EQUAL(err_buffer[2], SCPI_ERROR_SUFFIX_NOT_ALLOWED);
+        error_buffer_clear();
+    }
+    CU_ASSERT_STRING_EQUAL("", output_buffer);
+    SCPI_ErrorClear(&scpi_context);
+}
+#endif /* USE_NUMERIC_LIST_STREAM */
+
+#if USE_INPUT_POOL
+static void testInputPool(void) {
+    static char pool_data[8 * 200];
+    static char message[1100];
+    scpi_input_pool_t pool;
+    size_t len;
+    size_t i;
+
+    output_buffer_clear();
+    error_buffer_clear();
+
+    SCPI_InputPoolInit(&pool, pool_data, 200, 8);
+    SCPI_InputPoolSet(&scpi_context, &pool, 700);
+
+    len = sprintf(message, "*IDN?;TEXT? \"");
+    memset(message + len, 'A', 500);
+    len += 500;
+    len += sprintf(message + len, "\", \"B\"\r\n*IDN?\r\n");
+
+    /* unit longer than own input buffer is received into borrowed chunks */
+    for (i = 0; i < len; i += 50) {
+        CU_ASSERT_TRUE(SCPI_Input(&scpi_context, message + i, (len - i < 50) ? len - i : 50));
+    }
+    CU_ASSERT_STRING_EQUAL("MA,IN,0,VER;\"B\"\r\nMA,IN,0,VER\r\n", output_buffer);
+    CU_ASSERT_EQUAL(pool.used, 0);
+    CU_ASSERT(scpi_context.buffer.data == scpi_input_buffer);
+    output_buffer_clear();
+
+    /* borrowed chunks can't be extended, data are moved to free chunks */
+    pool.used = 1 << 3;
+    CU_ASSERT_TRUE(inputReserved(message, len, 77));
+    CU_ASSERT_STRING_EQUAL("MA,IN,0,VER;\"B\"\r\nMA,IN,0,VER\r\n", output_buffer);
+    CU_ASSERT_EQUAL(pool.used, 1 << 3);
+    CU_ASSERT(scpi_context.buffer.data == scpi_input_buffer);
+    output_buffer_clear();
+    pool.used = 0;
+
+    /* chunks are kept until the following message is executed too */
+    CU_ASSERT_TRUE(SCPI_Input(&scpi_context, message, len - 2));
+    CU_ASSERT_STRING_EQUAL("MA,IN,0,VER;\"B\"\r\n", output_buffer);
+    CU_ASSERT(pool.used != 0);
+    CU_ASSERT_TRUE(SCPI_Input(&scpi_context, "\r\n", 2));
+    CU_ASSERT_STRING_EQUAL("MA,IN,0,VER;\"B\"\r\nMA,IN,0,VER\r\n", output_buffer);
+    CU_ASSERT_EQUAL(pool.used, 0);
+    output_buffer_clear();
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+
+    /* message longer than the limit is dropped */
+    memset(message, 'A', 800);
+    for (i = 0; i < 600; i += 100) {
+        CU_ASSERT_TRUE(SCPI_Input(&scpi_context, message + i, 100));
+    }
+    CU_ASSERT_FALSE(SCPI_Input(&scpi_context, message + i, 100));
+    CU_ASSERT_EQUAL(err_buffer_pos, 1);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_INPUT_BUFFER_OVERRUN);
+    CU_ASSERT_EQUAL(pool.used, 0);
+    CU_ASSERT(scpi_context.buffer.data == scpi_input_buffer);
+    SCPI_Input(&scpi_context, "", 0);
+    error_buffer_clear();
+    SCPI_ErrorClear(&scpi_context);
+    output_buffer_clear();
+
+    SCPI_InputPoolSet(&scpi_context, NULL, 0);
+}
+#endif /* USE_INPUT_POOL */
+
+static void setArrayParameters(const char * data) {
+    SCPI_CoreCls(&scpi_context);
+    error_buffer_clear();
+    scpi_context.input_count = 0;
+    scpi_context.param_list.lex_state.buffer = data;
+    scpi_context.param_list.lex_state.len = strlen(data);
+    scpi_context.param_list.lex_state.pos = data;
+}
+
+static void testParamArray(void) {
+    const char * tricky = "1 e3,1.,.5,+7, 2 ,#H10,1E-400, 123456789012345678901234567890";
+    double doubles[8];
+    double expected[8];
+    float floats[2];
+    int16_t int16s[4];
+    int32_t int32s[4];
+    uint64_t uint64s[2];
+    int32_t first;
+    size_t count;
+    size_t i;
+
+    setArrayParameters("1, 2.5 ,-3e2,#H10, 0.1");
+    CU_ASSERT_TRUE(SCPI_ParamArrayDouble(&scpi_context, doubles, 8, &count, TRUE));
+    CU_ASSERT_EQUAL(count, 5);
+    CU_ASSERT_EQUAL(doubles[0], 1);
+    CU_ASSERT_EQUAL(doubles[1], 2.5);
+    CU_ASSERT_EQUAL(doubles[2], -300);
+    CU_ASSERT_EQUAL(doubles[3], 16);
+    CU_ASSERT_EQUAL(doubles[4], 0.1);
+
+    /* same values as read one by one */
+    setArrayParameters(tricky);
+    for (i = 0; i < 8; i++) {
+        CU_ASSERT_TRUE(SCPI_ParamDouble(&scpi_context, &expected[i], TRUE));
+    }
+    setArrayParameters(tricky);
+    CU_ASSERT_TRUE(SCPI_ParamArrayDouble(&scpi_context, doubles, 8, &count, TRUE));
+    CU_ASSERT_EQUAL(count, 8);
+    CU_ASSERT_EQUAL(memcmp(doubles, expected, sizeof (doubles)), 0);
+
+    setArrayParameters("0.1,3.4028235e38");
+    CU_ASSERT_TRUE(SCPI_ParamArrayFloat(&scpi_context, floats, 2, &count, TRUE));
+    CU_ASSERT_EQUAL(count, 2);
+    CU_ASSERT_EQUAL(floats[0], 0.1f);
+    CU_ASSERT_EQUAL(floats[1], 3.4028235e38f);
+
+    setArrayParameters("10, #B101, -2147483648");
+    CU_ASSERT_TRUE(SCPI_ParamArrayInt32(&scpi_context, int32s, 4, &count, TRUE));
+    CU_ASSERT_EQUAL(count, 3);
+    CU_ASSERT_EQUAL(int32s[0], 10);
+    CU_ASSERT_EQUAL(int32s[1], 5);
+    CU_ASSERT_EQUAL(int32s[2], INT32_MIN);
+
+    setArrayParameters("18446744073709551615,0");
+    CU_ASSERT_TRUE(SCPI_ParamArrayUInt64(&scpi_context, uint64s, 2, &count, TRUE));
+    CU_ASSERT_EQUAL(count, 2);
+    CU_ASSERT_EQUAL(uint64s[0], UINT64_C(18446744073709551615));
+    CU_ASSERT_EQUAL(uint64s[1], 0);
+
+    /* array after other parameter */
+    setArrayParameters("5, 1,2");
+    CU_ASSERT_TRUE(SCPI_ParamInt32(&scpi_context, &first, TRUE));
+    CU_ASSERT_TRUE(SCPI_ParamArrayInt32(&scpi_context, int32s, 4, &count, TRUE));
+    CU_ASSERT_EQUAL(count, 2);
+    CU_ASSERT_EQUAL(int32s[1], 2);
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+
+    /* index of the first invalid element is returned */
+    setArrayParameters("1,-32768,32768,1");
+    int16s[2] = 0x1234;
+    CU_ASSERT_FALSE(SCPI_ParamArrayInt16(&scpi_context, int16s, 4, &count, TRUE));
+    CU_ASSERT_EQUAL(count, 2);
+    CU_ASSERT_EQUAL(int16s[1], -32768);
+    CU_ASSERT_EQUAL(int16s[2], 0x1234);
+    CU_ASSERT_EQUAL(err_buffer_pos, 1);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_DATA_OUT_OF_RANGE);
+
+    setArrayParameters("1,2,X,4");
+    CU_ASSERT_FALSE(SCPI_ParamArrayDouble(&scpi_context, doubles, 8, &count, TRUE));
+    CU_ASSERT_EQUAL(count, 2);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_DATA_TYPE_ERROR);
+
+    setArrayParameters("1,2 V");
+    CU_ASSERT_FALSE(SCPI_ParamArrayInt32(&scpi_context, int32s, 4, &count, TRUE));
+    CU_ASSERT_EQUAL(count, 1);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_SUFFIX_NOT_ALLOWED);
+
+    setArrayParameters("1,2,3");
+    CU_ASSERT_FALSE(SCPI_ParamArrayDouble(&scpi_context, doubles, 2, &count, TRUE));
+    CU_ASSERT_EQUAL(count, 2);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_TOO_MUCH_DATA);
+
+    setArrayParameters("");
+    CU_ASSERT_TRUE(SCPI_ParamArrayDouble(&scpi_context, doubles, 2, &count, FALSE));
+    CU_ASSERT_EQUAL(count, 0);
+    CU_ASSERT_EQUAL(err_buffer_pos, 0);
+    CU_ASSERT_FALSE(SCPI_ParamArrayDouble(&scpi_context, doubles, 2, &count, TRUE));
+    CU_ASSERT_EQUAL(count, 0);
+    CU_ASSERT_EQUAL(err_buffer[0], SCPI_ERROR_MISSING_PARAMETER);
+
+    SCPI_CoreCls(&scpi_context);
+    error_buffer_clear();
+}
+
 static void testParamNumber(void) {
     TEST_ParamNumber("1", TRUE, FALSE, SCPI_NUM_NUMBER, 1, SCPI_UNIT_NONE, 10, TRUE, 0);
     TEST_ParamNumber("#Q20", TRUE, FALSE, SCPI_NUM_NUMBER, 16, SCPI_UNIT_NONE, 8, TRUE, 0);
@@ -838,9 +1984,24 @@ int main() {
             || (NULL == CU_add_test(pSuite, "Commands handling", testCommandsHandling))
             || (NULL == CU_add_test(pSuite, "Error handling", testErrorHandling))
             || (NULL == CU_add_test(pSuite, "IEEE 488.2 Mandatory commands", testIEEE4882))
+            || (NULL == CU_add_test(pSuite, "Command index", testCommandIndex))
+            || (NULL == CU_add_test(pSuite, "Dispatch cache", testDispatchCache))
+            || (NULL == CU_add_test(pSuite, "Command tables", testCommandTables))
             || (NULL == CU_add_test(pSuite, "Numeric list", testNumericList))
+            || (NULL == CU_add_test(pSuite, "Numeric list iterator", testNumericListIterator))
             || (NULL == CU_add_test(pSuite, "Channel list", testChannelList))
+            || (NULL == CU_add_test(pSuite, "Channel list flat", testChannelListFlat))
             || (NULL == CU_add_test(pSuite, "SCPI_ParamNumber", testParamNumber))
+            || (NULL == CU_add_test(pSuite, "SCPI_ParamArray", testParamArray))
+            || (NULL == CU_add_test(pSuite, "Block stream", testBlockStream))
+            || (NULL == CU_add_test(pSuite, "Input reserve", testInputReserve))
+            || (NULL == CU_add_test(pSuite, "Input view", testInputView))
+#if USE_NUMERIC_LIST_STREAM
+            || (NULL == CU_add_test(pSuite, "List stream", testListStream))
+#endif /* USE_NUMERIC_LIST_STREAM */
+#if USE_INPUT_POOL
+            || (NULL == CU_add_test(pSuite, "Input pool", testInputPool))
+#endif /* USE_INPUT_POOL */
             ) {
         CU_cleanup_registry();
         return CU_get_error();
@@ -38,11 +38,13 @@
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
+#include <math.h>
 
 #include "CUnit/Basic.h"
 
 #include "scpi/scpi.h"
 #include "../src/utils_private.h"
+#include "../src/index_private.h"
 
 /*
  * CUnit Test Suite
@@ -262,10 +264,11 @@ static void test_doubleToStr() {
 static void test_strBaseToInt32() {
     size_t result;
     int32_t val;
+    scpi_bool_t overflow;
 
 #define TEST_STR_TO_INT32(s, r, v, b)                   \
     do {                                                \
-        result = strBaseToInt32(s, &val, b);            \
+        result = strBaseToInt32(s, strlen(s), &val, b, &overflow);            \
         CU_ASSERT_EQUAL(val, v);                        \
         CU_ASSERT_EQUAL(result, r);                     \
     } while(0)                                          \
@@ -283,15 +286,42 @@ static void test_strBaseToInt32() {
     TEST_STR_TO_INT32("FF", 2, 255, 16); // hexadecimal FF
     TEST_STR_TO_INT32("77", 2, 63, 8); // octal 77
     TEST_STR_TO_INT32("18", 1, 1, 8); // octal 1, 8 is ignored
+    TEST_STR_TO_INT32("-2147483648", 11, INT32_MIN, 10);
+    CU_ASSERT_FALSE(overflow);
+    TEST_STR_TO_INT32("0000000000002147483647", 22, INT32_MAX, 10);
+    CU_ASSERT_FALSE(overflow);
+    TEST_STR_TO_INT32("2147483648", 10, INT32_MAX, 10);
+    CU_ASSERT_TRUE(overflow);
+    TEST_STR_TO_INT32("-2147483649", 11, INT32_MIN, 10);
+    CU_ASSERT_TRUE(overflow);
+    TEST_STR_TO_INT32("7FFFFFFF", 8, INT32_MAX, 16);
+    CU_ASSERT_FALSE(overflow);
+
+    /* only given length is read */
+    result = strBaseToInt32("12345", 3, &val, 10, &overflow);
+    CU_ASSERT_EQUAL(result, 3);
+    CU_ASSERT_EQUAL(val, 123);
+    result = strBaseToInt32("123456789", 0, &val, 10, &overflow);
+    CU_ASSERT_EQUAL(result, 0);
+    CU_ASSERT_EQUAL(val, 0);
+
+    /* outputs are set even if there is no digit */
+    val = 77;
+    overflow = TRUE;
+    result = strBaseToInt32("-X", 2, &val, 10, &overflow);
+    CU_ASSERT_EQUAL(result, 0);
+    CU_ASSERT_EQUAL(val, 0);
+    CU_ASSERT_FALSE(overflow);
 }
 
 static void test_strBaseToUInt32() {
     size_t result;
     uint32_t val;
+    scpi_bool_t overflow;
 
 #define TEST_STR_TO_UINT32(s, r, v, b)                  \
     do {                                                \
-        result = strBaseToUInt32(s, &val, b);           \
+        result = strBaseToUInt32(s, strlen(s), &val, b, &overflow);           \
         CU_ASSERT_EQUAL(val, v);                        \
         CU_ASSERT_EQUAL(result, r);                     \
     } while(0)                                          \
@@ -309,15 +339,27 @@ static void test_strBaseToUInt32() {
     TEST_STR_TO_UINT32("77", 2, 63, 8); // octal 77
     TEST_STR_TO_UINT32("18", 1, 1, 8); // octal 1, 8 is ignored
     TEST_STR_TO_UINT32("FFFFFFFF", 8, 0xffffffffu, 16); // octal 1, 8 is ignored
+    TEST_STR_TO_UINT32("deadBEEF", 8, 0xdeadbeefu, 16);
+    TEST_STR_TO_UINT32("100000000", 9, 0xffffffffu, 16);
+    CU_ASSERT_TRUE(overflow);
+    TEST_STR_TO_UINT32("-1", 2, 0, 10);
+    CU_ASSERT_TRUE(overflow);
+    TEST_STR_TO_UINT32("-0", 2, 0, 10);
+    CU_ASSERT_FALSE(overflow);
+    TEST_STR_TO_UINT32("10100101111100001", 17, 0x14be1, 2);
+    TEST_STR_TO_UINT32("012345670123", 12, 012345670123u, 8);
+    TEST_STR_TO_UINT32("1234567890123", 13, 0xffffffffu, 10);
+    CU_ASSERT_TRUE(overflow);
 }
 
 static void test_strBaseToInt64() {
     size_t result;
     int64_t val;
+    scpi_bool_t overflow;
 
 #define TEST_STR_TO_INT64(s, r, v, b)                   \
     do {                                                \
-        result = strBaseToInt64(s, &val, b);            \
+        result = strBaseToInt64(s, strlen(s), &val, b, &overflow);            \
         CU_ASSERT_EQUAL(val, v);                        \
         CU_ASSERT_EQUAL(result, r);                     \
     } while(0)                                          \
@@ -335,15 +377,21 @@ static void test_strBaseToInt64() {
     TEST_STR_TO_INT64("FF", 2, 255, 16); // hexadecimal FF
     TEST_STR_TO_INT64("77", 2, 63, 8); // octal 77
     TEST_STR_TO_INT64("18", 1, 1, 8); // octal 1, 8 is ignored
+    TEST_STR_TO_INT64("4294967296", 10, INT64_C(4294967296), 10); // does not fit into long on 32-bit targets
+    TEST_STR_TO_INT64("-9223372036854775808", 20, INT64_MIN, 10);
+    CU_ASSERT_FALSE(overflow);
+    TEST_STR_TO_INT64("9223372036854775808", 19, INT64_MAX, 10);
+    CU_ASSERT_TRUE(overflow);
 }
 
 static void test_strBaseToUInt64() {
     size_t result;
     uint64_t val;
+    scpi_bool_t overflow;
 
 #define TEST_STR_TO_UINT64(s, r, v, b)                  \
     do {                                                \
-        result = strBaseToUInt64(s, &val, b);           \
+        result = strBaseToUInt64(s, strlen(s), &val, b, &overflow);           \
         CU_ASSERT_EQUAL(val, v);                        \
         CU_ASSERT_EQUAL(result, r);                     \
     } while(0)                                          \
@@ -361,19 +409,29 @@ static void test_strBaseToUInt64() {
     TEST_STR_TO_UINT64("77", 2, 63, 8); // octal 77
     TEST_STR_TO_UINT64("18", 1, 1, 8); // octal 1, 8 is ignored
     TEST_STR_TO_UINT64("FFFFFFFF", 8, 0xffffffffu, 16); // octal 1, 8 is ignored
+    TEST_STR_TO_UINT64("0123456789abcdefG", 16, UINT64_C(0x0123456789abcdef), 16);
+    TEST_STR_TO_UINT64("18446744073709551615", 20, UINT64_C(18446744073709551615), 10);
+    CU_ASSERT_FALSE(overflow);
+    TEST_STR_TO_UINT64("18446744073709551616", 20, UINT64_C(18446744073709551615), 10);
+    CU_ASSERT_TRUE(overflow);
+    TEST_STR_TO_UINT64("99999999999999999999999", 23, UINT64_C(18446744073709551615), 10);
+    CU_ASSERT_TRUE(overflow);
 }
 
+
 static void test_strToDouble() {
     double val;
     size_t result;
 
-#define TEST_STR_TO_DOUBLE(s, r, v)                     \
+#define TEST_STR_TO_DOUBLE_LEN(s, l, r, v)              \
     do {                                                \
-        result = strToDouble(s, &val);                  \
+        result = strToDouble(s, l, &val);               \
         CU_ASSERT_EQUAL(result, r);                     \
         CU_ASSERT_DOUBLE_EQUAL(v, val, 0.000001);       \
     } while(0);                                         \
 
+#define TEST_STR_TO_DOUBLE(s, r, v) TEST_STR_TO_DOUBLE_LEN(s, strlen(s), r, v)
+
     TEST_STR_TO_DOUBLE("", 0, 0.0);
 
     TEST_STR_TO_DOUBLE(" 1", 2, 1.0);
@@ -394,6 +452,197 @@ static void test_strToDouble() {
 
     TEST_STR_TO_DOUBLE("-1.2", 4, -1.2);
 
+    /* forms of <NRf> */
+    TEST_STR_TO_DOUBLE("+.5", 3, 0.5);
+    TEST_STR_TO_DOUBLE("5.", 2, 5.0);
+    TEST_STR_TO_DOUBLE(".", 0, 0.0);
+    TEST_STR_TO_DOUBLE("-", 0, 0.0);
+    TEST_STR_TO_DOUBLE("1.5e-3", 6, 0.0015);
+    TEST_STR_TO_DOUBLE("1.5 E+3", 7, 1500.0);
+    TEST_STR_TO_DOUBLE("1.5E 3", 6, 1500.0);
+    TEST_STR_TO_DOUBLE("1 EV", 1, 1.0);
+    TEST_STR_TO_DOUBLE("1E+V", 1, 1.0);
+    TEST_STR_TO_DOUBLE("0.000000000000000000000000123456789012345678901234567890", 56, 1.2345678901234568e-25);
+    TEST_STR_TO_DOUBLE("123456789012345678901234567890", 30, 1.2345678901234568e29);
+    CU_ASSERT_EQUAL(strToDouble("1E400", 5, &val), 5);
+    CU_ASSERT_TRUE(val == HUGE_VAL);
+    TEST_STR_TO_DOUBLE("1E-400", 6, 0.0);
+    TEST_STR_TO_DOUBLE("inf", 0, 0.0);
+    TEST_STR_TO_DOUBLE("0x10", 1, 0.0);
+
+    /* only given length is read */
+    TEST_STR_TO_DOUBLE_LEN("123", 2, 2, 12.0);
+    TEST_STR_TO_DOUBLE_LEN("1.5E3", 4, 3, 1.5);
+    TEST_STR_TO_DOUBLE_LEN("1.5E3", 0, 0, 0.0);
+}
+
+static uint64_t random_state = UINT64_C(0x9E3779B97F4A7C15);
+
+static uint64_t randomNext(void) {
+    random_state ^= random_state >> 12;
+    random_state ^= random_state << 25;
+    random_state ^= random_state >> 27;
+    return random_state * UINT64_C(2685821657736338717);
+}
+
+/**
+ * Write random decimal number in one of forms accepted by the lexer
+ */
+static void randomDecimal(char * str, size_t size) {
+    static const int precisions[] = {6, 15, 16, 17, 20, 25, 40};
+    uint64_t r = randomNext();
+    double d;
+    uint64_t bits;
+    int digits;
+    int point;
+    int i;
+    char * p = str;
+
+    switch (r % 4) {
+        case 0:
+            /* any finite double */
+            do {
+                bits = randomNext();
+                memcpy(&d, &bits, sizeof (d));
+            } while (d != d || d - d != 0);
+            snprintf(str, size, "%.*e", precisions[(r >> 8) % 7], d);
+            break;
+        case 1:
+            /* random digits with decimal point and exponent */
+            digits = 1 + (int) ((r >> 8) % 30);
+            point = (int) ((r >> 16) % (digits + 1));
+            if ((r >> 24) & 1) {
+                *p++ = '-';
+            }
+            for (i = 0; i < digits; i++) {
+                if (i == point) {
+                    *p++ = '.';
+                }
+                *p++ = (char) ('0' + randomNext() % 10);
+            }
+            snprintf(p, size - (p - str), "E%d", (int) ((r >> 32) % 700) - 350);
+            break;
+        case 2:
+            /* numbers close to halfway between two doubles */
+            bits = randomNext() >> 2;
+            memcpy(&d, &bits, sizeof (d));
+            snprintf(str, size, "%.*e", (int) ((r >> 8) % 30) + 15, d);
+            i = (int) strlen(str);
+            while ((i > 0) && (str[i - 1] != 'e')) {
+                i--;
+            }
+            if (i > 2) {
+                str[i - 2] = (char) ('4' + (r >> 40) % 2);
+            }
+            break;
+        default:
+            /* short instrument values */
+            snprintf(str, size, "%d.%03d", (int) ((r >> 8) % 100000), (int) ((r >> 32) % 1000));
+            break;
+    }
+}
+
+static void test_strToDoubleCorpus() {
+    char str[128];
+    char first_failure[128] = "";
+    size_t i;
+    double val, expected;
+    float fval, fexpected;
+    size_t mismatches = 0;
+
+    for (i = 0; i < 200000; i++) {
+        randomDecimal(str, sizeof (str));
+
+        expected = strtod(str, NULL);
+        strToDouble(str, strlen(str), &val);
+        fexpected = strtof(str, NULL);
+        strToFloat(str, strlen(str), &fval);
+
+        if (memcmp(&val, &expected, sizeof (val)) || memcmp(&fval, &fexpected, sizeof (fval))) {
+            if (mismatches == 0) {
+                strcpy(first_failure, str);
+            }
+            mismatches++;
+        }
+    }
+
+    /* exactly halfway between two floats and, if long double can hold it, two doubles */
+    for (i = 0; i < 5000; i++) {
+        char exact[1024];
+        uint64_t bits = randomNext();
+        uint32_t fbits = (uint32_t) bits & 0x7F7FFFFF;
+        float f;
+        double d;
+
+        memcpy(&f, &fbits, sizeof (f));
+        snprintf(exact, sizeof (exact), "%.160e", ((double) f + (double) nextafterf(f, HUGE_VALF)) / 2);
+        fexpected = strtof(exact, NULL);
+        strToFloat(exact, strlen(exact), &fval);
+
+        bits &= UINT64_C(0x7FEFFFFFFFFFFFFF);
+        memcpy(&d, &bits, sizeof (d));
+        snprintf(exact, sizeof (exact), "%.780Le", ((long double) d + (long double) nextafter(d, HUGE_VAL)) / 2);
+        expected = strtod(exact, NULL);
+        strToDouble(exact, strlen(exact), &val);
+
+        if (memcmp(&val, &expected, sizeof (val)) || memcmp(&fval, &fexpected, sizeof (fval))) {
+            if (mismatches == 0) {
+                snprintf(first_failure, sizeof (first_failure), "%a %a", d, (double) f);
+            }
+            mismatches++;
+        }
+    }
+
+    CU_ASSERT_STRING_EQUAL(first_failure, "");
+    CU_ASSERT_EQUAL(mismatches, 0);
+}
+
+static void test_strBaseToUInt64Random() {
+    static const int8_t bases[] = {2, 8, 10, 16};
+    char str[80];
+    char first_failure[80] = "";
+    size_t mismatches = 0;
+    uint64_t val, expected;
+    uint64_t r;
+    scpi_bool_t overflow;
+    size_t result;
+    size_t len;
+    size_t i;
+    int8_t base;
+
+    for (i = 0; i < 100000; i++) {
+        r = randomNext();
+        base = bases[r & 3];
+        expected = randomNext() >> ((r >> 8) % 64);
+        switch (base) {
+            case 2:
+                SCPI_UInt64ToStrBase(expected, str, sizeof (str), 2);
+                break;
+            case 8:
+                snprintf(str, sizeof (str), "%" PRIo64, expected);
+                break;
+            case 10:
+                snprintf(str, sizeof (str), "%" PRIu64, expected);
+                break;
+            default:
+                snprintf(str, sizeof (str), (r & 4) ? "%" PRIX64 : "%" PRIx64, expected);
+                break;
+        }
+        /* followed by something what is not a digit */
+        len = strlen(str);
+        strcat(str, (r & 8) ? "G" : ".9");
+
+        result = strBaseToUInt64(str, strlen(str), &val, base, &overflow);
+        if ((val != expected) || overflow || (result != len)) {
+            if (mismatches == 0) {
+                snprintf(first_failure, sizeof (first_failure), "%s/%d", str, (int) base);
+            }
+            mismatches++;
+        }
+    }
+
+    CU_ASSERT_STRING_EQUAL(first_failure, "");
+    CU_ASSERT_EQUAL(mismatches, 0);
 }
 
 static void test_compareStr() {
@@ -461,11 +710,22 @@ static void test_matchPattern() {
 static void test_matchCommand() {
     scpi_bool_t result;
     int32_t values[20];
+    scpi_command_node_t nodes[64];
+    scpi_command_index_t index;
+    scpi_pattern_t compiled;
+    scpi_header_t header;
+    char buffer[SCPI_HEADER_LENGTH];
 
 #define TEST_MATCH_COMMAND(p, s, r)                         \
     do {                                                        \
+        scpi_command_t cmdlist[] = {{.pattern = p}, SCPI_CMD_LIST_END}; \
         result = matchCommand(p, s, strlen(s), NULL, 0, 0);     \
         CU_ASSERT_EQUAL(result, r);                             \
+        CU_ASSERT_TRUE(SCPI_CommandIndexBuild(&index, cmdlist, nodes, 64)); \
+        CU_ASSERT_EQUAL(foldHeader(NULL, s, strlen(s), buffer, sizeof (buffer), &header) && (scpiIndex_Find(&index, &header, NULL) == 0), r); \
+        CU_ASSERT_EQUAL(foldHeader(NULL, s, strlen(s), buffer, sizeof (buffer), &header) && matchHeaderPattern(p, &header, NULL, 0, 0, NULL), r); \
+        CU_ASSERT_TRUE(SCPI_PatternCompile(&compiled, p));      \
+        CU_ASSERT_EQUAL(SCPI_PatternMatch(&compiled, s, strlen(s), NULL, 0, 0), r); \
     } while(0)                                                  \
 
 #define NOPAREN(...) __VA_ARGS__
@@ -479,6 +739,27 @@ static void test_matchCommand() {
         {unsigned int i; for (i = 0; i<cnt; i++) {              \
             CU_ASSERT_EQUAL(evalues[i], values[i]);             \
         }}                                                      \
+        CU_ASSERT_TRUE(SCPI_PatternCompile(&compiled, p));      \
+        result = SCPI_PatternMatch(&compiled, s, strlen(s), values, 20, -1); \
+        CU_ASSERT_EQUAL(result, r);                             \
+        {unsigned int i; for (i = 0; i<cnt; i++) {              \
+            CU_ASSERT_EQUAL(evalues[i], values[i]);             \
+        }}                                                      \
+        /* suffixes captured by index search */                 \
+        scpi_command_t cmdlist[] = {{.pattern = p}, SCPI_CMD_LIST_END}; \
+        scpi_command_numbers_t captured;                        \
+        CU_ASSERT_TRUE(SCPI_CommandIndexBuild(&index, cmdlist, nodes, 64)); \
+        CU_ASSERT_TRUE(foldHeader(NULL, s, strlen(s), buffer, sizeof (buffer), &header)); \
+        CU_ASSERT_EQUAL(scpiIndex_Find(&index, &header, &captured) == 0, r); \
+        {unsigned int i; for (i = 0; (i<cnt) && (i<SCPI_COMMAND_NUMBERS); i++) { \
+            CU_ASSERT_EQUAL(evalues[i], (captured.given & (1UL << i)) ? captured.values[i] : -1); \
+        }}                                                      \
+        /* pattern walked without compiling */                 \
+        result = matchHeaderPattern(p, &header, values, 20, -1, NULL); \
+        CU_ASSERT_EQUAL(result, r);                             \
+        {unsigned int i; for (i = 0; i<cnt; i++) {              \
+            CU_ASSERT_EQUAL(evalues[i], values[i]);             \
+        }}                                                      \
     } while(0)                                                  \
 
     TEST_MATCH_COMMAND("A", "a", TRUE);
@@ -651,38 +932,180 @@ static void test_matchCommand() {
     TEST_MATCH_COMMAND2("OUTPut#[:MODulation#]:FM", "outp3:mod10:fm", TRUE, (3, 10)); // test numeric parameter
     TEST_MATCH_COMMAND2("OUTPut#[:MODulation#]:FM", "outp3:fm", TRUE, (3, -1)); // test numeric parameter
     TEST_MATCH_COMMAND2("OUTPut#[:MODulation#]:FM", "output:fm", TRUE, (-1, -1)); // test numeric parameter
+    TEST_MATCH_COMMAND2("OUTPut#:MODulation#:FM", "outp2147483647:mod1:fm", TRUE, (2147483647, 1)); // test numeric parameter
+    TEST_MATCH_COMMAND("OUTPut#:MODulation#:FM", "outp2147483648:mod1:fm", FALSE); // test numeric parameter overflow
+    TEST_MATCH_COMMAND("OUTPut#:MODulation#:FM", "outp4294967297:mod2:fm", FALSE); // test numeric parameter overflow
+    TEST_MATCH_COMMAND("OUTPut#:MODulation#:FM", "outp1:mod99999999999:fm", FALSE); // test numeric parameter overflow
+}
+
+static void test_patternCompile() {
+    scpi_pattern_t compiled;
+    int32_t values[4];
+
+    CU_ASSERT_TRUE(SCPI_PatternCompile(&compiled, "[:SOURce#]:FREQuency[:CW]?"));
+    CU_ASSERT_EQUAL(compiled.count, 3);
+    CU_ASSERT_EQUAL(compiled.query, TRUE);
+    CU_ASSERT_EQUAL(compiled.keywords[0].offset, 2);
+    CU_ASSERT_EQUAL(compiled.keywords[0].length, 6);
+    CU_ASSERT_EQUAL(compiled.keywords[0].short_length, 4);
+    CU_ASSERT_EQUAL(compiled.keywords[0].slot, 0);
+    CU_ASSERT_EQUAL(compiled.keywords[0].group, 1);
+    CU_ASSERT_EQUAL(compiled.keywords[1].slot, -1);
+    CU_ASSERT_EQUAL(compiled.keywords[1].group, 0);
+    CU_ASSERT_EQUAL(compiled.keywords[2].group, 2);
+    CU_ASSERT_EQUAL(compiled.group_count, 2);
+    CU_ASSERT_EQUAL(compiled.groups[0].start, 0);
+    CU_ASSERT_EQUAL(compiled.groups[0].end, 1);
+    CU_ASSERT_EQUAL(compiled.groups[1].start, 2);
+    CU_ASSERT_EQUAL(compiled.groups[1].end, 3);
+
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "sour2:freq?", 11, values, 4, 1));
+    CU_ASSERT_EQUAL(values[0], 2);
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, ":FREQ:CW?", 9, values, 4, 1));
+    CU_ASSERT_EQUAL(values[0], 1);
+    CU_ASSERT_FALSE(SCPI_PatternMatch(&compiled, "freq:", 5, values, 4, 1));
+    CU_ASSERT_FALSE(SCPI_PatternMatch(&compiled, "freq", 4, values, 4, 1));
+
+    /* nested optional parts */
+    CU_ASSERT_TRUE(SCPI_PatternCompile(&compiled, "A[:B[:C]]:D"));
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "a:b:c:d", 7, NULL, 0, 0));
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "a:b:d", 5, NULL, 0, 0));
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "a:d", 3, NULL, 0, 0));
+    CU_ASSERT_FALSE(SCPI_PatternMatch(&compiled, "a:c:d", 5, NULL, 0, 0));
+
+    /* nested optional parts starting at the same keyword */
+    CU_ASSERT_TRUE(SCPI_PatternCompile(&compiled, "[[:A]:B]:C"));
+    CU_ASSERT_EQUAL(compiled.keywords[0].group, 1);
+    CU_ASSERT_EQUAL(compiled.groups[0].end, 2);
+    CU_ASSERT_EQUAL(compiled.groups[1].end, 1);
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "a:b:c", 5, NULL, 0, 0));
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "b:c", 3, NULL, 0, 0));
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "c", 1, NULL, 0, 0));
+    CU_ASSERT_FALSE(SCPI_PatternMatch(&compiled, "a:c", 3, NULL, 0, 0));
+    CU_ASSERT_TRUE(SCPI_PatternCompile(&compiled, "X[[[:A#]:B]:C]:D"));
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "x:a3:b:c:d", 10, values, 4, 1));
+    CU_ASSERT_EQUAL(values[0], 3);
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "x:b:c:d", 7, values, 4, 1));
+    CU_ASSERT_EQUAL(values[0], 1);
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "x:c:d", 5, NULL, 0, 0));
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "x:d", 3, NULL, 0, 0));
+    CU_ASSERT_FALSE(SCPI_PatternMatch(&compiled, "x:a:c:d", 7, NULL, 0, 0));
+    CU_ASSERT_FALSE(SCPI_PatternMatch(&compiled, "x:b:d", 5, NULL, 0, 0));
+    CU_ASSERT_TRUE(SCPI_PatternCompile(&compiled, "[:A[]]:B"));
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "b", 1, NULL, 0, 0));
+    CU_ASSERT_TRUE(SCPI_PatternMatch(&compiled, "a:b", 3, NULL, 0, 0));
+
+    /* malformed patterns */
+    CU_ASSERT_FALSE(SCPI_PatternCompile(&compiled, "A[:B"));
+    CU_ASSERT_FALSE(SCPI_PatternCompile(&compiled, "A]:B"));
+    CU_ASSERT_FALSE(SCPI_PatternCompile(&compiled, "A:B:C:D:E:F:G:H:I:J:K:L:M"));
+    CU_ASSERT_FALSE(SCPI_PatternMatch(&compiled, "A", 1, NULL, 0, 0));
+}
+
+static void test_upperCase(void) {
+    const char * src = "abcdefghijklmnopqrstuvwxyz:ABC_xyz#@[`{0123456789\x80\xe1\xfa";
+    char expected[64];
+    char result[64];
+    size_t len = strlen(src);
+    size_t i;
+
+    for (i = 0; i <= len; i++) {
+        expected[i] = ((src[i] >= 'a') && (src[i] <= 'z')) ? (src[i] - 'a' + 'A') : src[i];
+    }
+
+    /* all lengths to pass SIMD, 8 byte and byte paths */
+    for (i = 0; i <= len; i++) {
+        memset(result, 0, sizeof (result));
+        upperCase(result, src, i);
+        CU_ASSERT_EQUAL(memcmp(result, expected, i), 0);
+        CU_ASSERT_EQUAL(result[i], 0);
+    }
+
+    CU_ASSERT_TRUE(compareKeyword("MEASurementsFunction", 20, "MEASUREMENTSFUNCTION", 20));
+    CU_ASSERT_FALSE(compareKeyword("MEASurementsFunction", 20, "MEASUREMENTSFUNCTIOM", 20));
+    CU_ASSERT_FALSE(compareKeyword("MEASurementsFunction", 20, "measurementsfunction", 20));
+    CU_ASSERT_FALSE(compareKeyword("MEAS", 4, "MEASU", 5));
+    CU_ASSERT_TRUE(compareKeywordAndNum("CHANnel", 7, "CHANNEL12", 9, NULL));
+    CU_ASSERT_FALSE(compareKeywordAndNum("CHANnel", 7, "CHANNEL1A", 9, NULL));
+}
+
+static void test_scanStructural(void) {
+    char data[160];
+    uint64_t expected;
+    size_t i, j, len;
+
+    for (i = 0; i < sizeof (data); i++) {
+        data[i] = (char) ((i * 37 + 11) & 0xff);
+    }
+
+    /* every offset and length to pass SIMD and byte paths */
+    for (i = 0; i < 64; i++) {
+        for (len = 0; len <= 80; len++) {
+            expected = 0;
+            for (j = 0; (j < len) && (j < 64); j++) {
+                if (strchr("\r\n;,\"'#", data[i + j]) || ((uint8_t) data[i + j] >= 0x80)) {
+                    expected |= (uint64_t) 1 << j;
+                }
+            }
+            CU_ASSERT_EQUAL(scanStructural(data + i, len), expected);
+        }
+    }
+
+    CU_ASSERT_EQUAL(scanStructuralNext("'abcdefghijklmnopqrstuvwxyz0123456789' , 1", 42), 0);
+    CU_ASSERT_EQUAL(scanStructuralNext("abcdefghijklmnopqrstuvwxyz0123456789 abcdefghijklmnopqrstuvwxyz0123456789\"", 74), 73);
+    CU_ASSERT_EQUAL(scanStructuralNext("abcdefghijklmnopqrstuvwxyz", 26), 26);
+    CU_ASSERT_EQUAL(scanTerminator("abc, \"d#e\", 'f' ; g", 19), 16);
+    CU_ASSERT_EQUAL(scanTerminator("abc, \"d#e\", 'f' \r\n", 18), 16);
+    CU_ASSERT_EQUAL(scanTerminator("abc, \"d#e\", 'f'", 15), 15);
 }
 
-static void test_composeCompoundCommand(void) {
+static void test_composeHeader(void) {
 
-#define TEST_COMPOSE_COMMAND(b, c1_len, c2_pos, c2_len, c2_final, r)    \
+#define TEST_COMPOSE_HEADER(b, c1_len, c2_pos, c2_len, c2_final, r)     \
     {                                                                   \
         char buffer[100];                                               \
-        scpi_token_t cmd_prev, cmd_curr;                                \
-        cmd_prev.ptr = buffer;                                          \
-        cmd_prev.len = c1_len;                                          \
-        cmd_curr.ptr = buffer + c2_pos;                                 \
-        cmd_curr.len = c2_len;                                          \
+        char joined[100];                                               \
+        scpi_header_t prev, curr;                                       \
+        size_t i, pos = 0;                                              \
         scpi_bool_t res;                                                \
                                                                         \
         strcpy(buffer, b);                                              \
-        res = composeCompoundCommand(&cmd_prev, &cmd_curr);             \
+        CU_ASSERT_TRUE(composeHeader(NULL, buffer, 0, c1_len, &prev));  \
+        res = composeHeader(&prev, buffer, c2_pos, c2_len, &curr);      \
         CU_ASSERT_EQUAL(res, r);                                        \
-        CU_ASSERT_EQUAL(cmd_curr.len, strlen(c2_final));                \
-        CU_ASSERT_STRING_EQUAL(cmd_curr.ptr, c2_final);                 \
+        if (res) {                                                      \
+            for (i = 0; i < curr.count; i++) {                          \
+                if (i > 0) joined[pos++] = ':';                         \
+                memcpy(joined + pos, buffer + curr.keywords[i].offset, curr.keywords[i].length); \
+                pos += curr.keywords[i].length;                         \
+            }                                                           \
+            if (curr.query) joined[pos++] = '?';                        \
+            joined[pos] = '\0';                                         \
+            CU_ASSERT_STRING_EQUAL(joined, c2_final);                   \
+        }                                                               \
+        CU_ASSERT_STRING_EQUAL(buffer, b);                              \
     }\
 
-    TEST_COMPOSE_COMMAND("A:B;C", 3, 4, 1, "A:C", TRUE);
-    TEST_COMPOSE_COMMAND("A:B;DD", 3, 4, 2, "A:DD", TRUE);
-    TEST_COMPOSE_COMMAND("A:B", 0, 0, 3, "A:B", TRUE);
-    TEST_COMPOSE_COMMAND("*IDN? ; ABC", 5, 8, 3, "ABC", TRUE);
-    TEST_COMPOSE_COMMAND("A:B;*IDN?", 3, 4, 5, "*IDN?", TRUE);
-    TEST_COMPOSE_COMMAND("A:B;:C", 3, 4, 2, ":C", TRUE);
-    TEST_COMPOSE_COMMAND("B;C", 1, 2, 1, "C", TRUE);
-    TEST_COMPOSE_COMMAND("A:B;C:D", 3, 4, 3, "A:C:D", TRUE);
-    TEST_COMPOSE_COMMAND(":A:B;C", 4, 5, 1, ":A:C", TRUE);
-    TEST_COMPOSE_COMMAND(":A:B;:C", 4, 5, 2, ":C", TRUE);
-    TEST_COMPOSE_COMMAND(":A;C", 2, 3, 1, ":C", TRUE);
+    TEST_COMPOSE_HEADER("A:B;C", 3, 4, 1, "A:C", TRUE);
+    TEST_COMPOSE_HEADER("A:B;DD", 3, 4, 2, "A:DD", TRUE);
+    TEST_COMPOSE_HEADER("A:B", 0, 0, 3, "A:B", TRUE);
+    TEST_COMPOSE_HEADER("*IDN? ; ABC", 5, 8, 3, "ABC", TRUE);
+    TEST_COMPOSE_HEADER("A:B;*IDN?", 3, 4, 5, "*IDN?", TRUE);
+    TEST_COMPOSE_HEADER("A:B;:C", 3, 4, 2, "C", TRUE);
+    TEST_COMPOSE_HEADER("B;C", 1, 2, 1, "C", TRUE);
+    TEST_COMPOSE_HEADER("A:B;C:D", 3, 4, 3, "A:C:D", TRUE);
+    TEST_COMPOSE_HEADER(":A:B;C", 4, 5, 1, "A:C", TRUE);
+    TEST_COMPOSE_HEADER(":A:B;:C", 4, 5, 2, "C", TRUE);
+    TEST_COMPOSE_HEADER(":A;C", 2, 3, 1, "C", TRUE);
+    TEST_COMPOSE_HEADER("A:B:C;D?", 5, 6, 2, "A:B:D?", TRUE);
+    TEST_COMPOSE_HEADER("A:B;:*IDN?", 3, 4, 6, "", FALSE);
+    TEST_COMPOSE_HEADER("A:B;C::D", 3, 4, 4, "", FALSE);
+
+    /* at most SCPI_HEADER_KEYWORDS (12) keywords, including inherited ones */
+    TEST_COMPOSE_HEADER("A:B:C:D:E:F:G:H:I:J:K:L", 0, 0, 23, "A:B:C:D:E:F:G:H:I:J:K:L", TRUE);
+    TEST_COMPOSE_HEADER("A:B:C:D:E:F:G:H:I:J:K:L:M", 0, 0, 25, "", FALSE);
+    TEST_COMPOSE_HEADER("A:B:C:D:E:F:G:H:I:J:K:L;M", 23, 24, 1, "A:B:C:D:E:F:G:H:I:J:K:M", TRUE);
+    TEST_COMPOSE_HEADER("A:B:C:D:E:F:G:H:I:J:K:L;M:N", 23, 24, 3, "", FALSE);
 }
 
 int main() {
@@ -713,12 +1136,17 @@ int main() {
             || (NULL == CU_add_test(pSuite, "strBaseToUInt32", test_strBaseToUInt32))
             || (NULL == CU_add_test(pSuite, "strBaseToInt64", test_strBaseToInt64))
             || (NULL == CU_add_test(pSuite, "strBaseToUInt64", test_strBaseToUInt64))
+            || (NULL == CU_add_test(pSuite, "strBaseToUInt64Random", test_strBaseToUInt64Random))
             || (NULL == CU_add_test(pSuite, "strToDouble", test_strToDouble))
+            || (NULL == CU_add_test(pSuite, "strToDoubleCorpus", test_strToDoubleCorpus))
             || (NULL == CU_add_test(pSuite, "compareStr", test_compareStr))
             || (NULL == CU_add_test(pSuite, "compareStrAndNum", test_compareStrAndNum))
             || (NULL == CU_add_test(pSuite, "matchPattern", test_matchPattern))
             || (NULL == CU_add_test(pSuite, "matchCommand", test_matchCommand))
-            || (NULL == CU_add_test(pSuite, "composeCompoundCommand", test_composeCompoundCommand))
+            || (NULL == CU_add_test(pSuite, "patternCompile", test_patternCompile))
+            || (NULL == CU_add_test(pSuite, "upperCase", test_upperCase))
+            || (NULL == CU_add_test(pSuite, "scanStructural", test_scanStructural))
+            || (NULL == CU_add_test(pSuite, "composeHeader", test_composeHeader))
             ) {
         CU_cleanup_registry();
         return CU_get_error();
@@ -0,0 +1,172 @@
+/*-
+ * Copyright (c) 2012-2015 Jan Breuer,
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file   decimal_gen.c
+ *
+ * @brief  Table generator for decimal to binary conversion
+ *
+ * Host tool writing decimal_table.h: 128-bit approximations of powers of
+ * five used by the Eisel-Lemire algorithm in decimal.c. Positive powers
+ * are truncated, negative powers are reciprocals rounded up. Run by
+ * "make decimal".
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SMALLEST_POWER (-342)
+#define LARGEST_POWER 308
+
+#define LIMBS 64
+
+/* Unsigned big integer, least significant limb first */
+typedef struct {
+    uint32_t limb[LIMBS];
+} big_t;
+
+static void bigSet(big_t * a, uint32_t value) {
+    memset(a, 0, sizeof (*a));
+    a->limb[0] = value;
+}
+
+static void bigMul(big_t * a, uint32_t m) {
+    uint64_t carry = 0;
+    int i;
+
+    for (i = 0; i < LIMBS; i++) {
+        carry += (uint64_t) a->limb[i] * m;
+        a->limb[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+}
+
+static void bigDiv(big_t * a, uint32_t d) {
+    uint64_t rem = 0;
+    int i;
+
+    for (i = LIMBS - 1; i >= 0; i--) {
+        rem = (rem << 32) | a->limb[i];
+        a->limb[i] = (uint32_t) (rem / d);
+        rem %= d;
+    }
+}
+
+static void bigAdd(big_t * a, uint32_t value) {
+    uint64_t carry = value;
+    int i;
+
+    for (i = 0; (i < LIMBS) && carry; i++) {
+        carry += a->limb[i];
+        a->limb[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+}
+
+static int bigBits(const big_t * a) {
+    int i, b;
+
+    for (i = LIMBS - 1; i >= 0; i--) {
+        for (b = 31; b >= 0; b--) {
+            if (a->limb[i] & ((uint32_t) 1 << b)) {
+                return i * 32 + b + 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int bigBit(const big_t * a, int n) {
+    return (n >= 0) && (n < LIMBS * 32) && ((a->limb[n / 32] >> (n % 32)) & 1);
+}
+
+/* a = a << n for negative n, a = a >> n otherwise */
+static void bigShift(big_t * a, int n) {
+    big_t r;
+    int i;
+
+    bigSet(&r, 0);
+    for (i = 0; i < LIMBS * 32; i++) {
+        if (bigBit(a, i + n)) {
+            r.limb[i / 32] |= (uint32_t) 1 << (i % 32);
+        }
+    }
+    *a = r;
+}
+
+static uint64_t bigWord(const big_t * a, int n) {
+    return ((uint64_t) a->limb[2 * n + 1] << 32) | a->limb[2 * n];
+}
+
+int main(void) {
+    big_t power5;
+    big_t c;
+    int q;
+    int z;
+    int b;
+    int i;
+
+    printf("/* Generated by tools/decimal_gen.c, do not edit */\n\n");
+    printf("#ifndef SCPI_DECIMAL_TABLE_H\n");
+    printf("#define SCPI_DECIMAL_TABLE_H\n\n");
+    printf("#define DECIMAL_SMALLEST_POWER (%d)\n", SMALLEST_POWER);
+    printf("#define DECIMAL_LARGEST_POWER %d\n\n", LARGEST_POWER);
+    printf("/* 5^q normalized to 128 bits, high and low word, q from %d */\n", SMALLEST_POWER);
+    printf("static const uint64_t decimalPowersOfFive[%d][2] = {\n", LARGEST_POWER - SMALLEST_POWER + 1);
+
+    for (q = SMALLEST_POWER; q <= LARGEST_POWER; q++) {
+        bigSet(&power5, 1);
+        for (i = 0; i < (q < 0 ? -q : q); i++) {
+            bigMul(&power5, 5);
+        }
+
+        if (q < 0) {
+            /* 2^b / 5^-q + 1, b chosen to keep at least 128 bits */
+            z = bigBits(&power5);
+            b = (q >= -27) ? z + 127 : 2 * z + 128;
+            bigSet(&c, 1);
+            bigShift(&c, -b);
+            for (i = 0; i < -q; i++) {
+                bigDiv(&c, 5);
+            }
+            bigAdd(&c, 1);
+        } else {
+            c = power5;
+        }
+
+        bigShift(&c, bigBits(&c) - 128);
+
+        printf("    {UINT64_C(0x%016llx), UINT64_C(0x%016llx)},\n",
+                (unsigned long long) bigWord(&c, 1), (unsigned long long) bigWord(&c, 0));
+    }
+
+    printf("};\n\n");
+    printf("#endif /* SCPI_DECIMAL_TABLE_H */\n");
+
+    return 0;
+}
@@ -0,0 +1,860 @@
+/*-
+ * Copyright (c) 2012-2015 Jan Breuer,
+ *
+ * All Rights Reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file   lexer_gen.c
+ *
+ * @brief  Lexer table generator
+ *
+ * Host tool reading the lexer rules of scpi.g and writing lexer_table.h:
+ * a table of character flags and a DFA recognizing all program data
+ * tokens at once. States which loop on everything except structural
+ * characters are marked, so the lexer can jump over them with
+ * scanStructuralNext. Run by "make lexer" whenever the grammar changes.
+ *
+ * Only the subset of ANTLR syntax used by scpi.g is understood: literals,
+ * ranges, rule references, '~', '.', grouping, alternatives and the
+ * '*', '+', '?' operators. Parser rules are parsed but not used.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_NODES 4096
+#define MAX_RULES 256
+#define MAX_NFA 4096
+#define MAX_EDGES 8192
+#define MAX_DFA 255
+#define NAME_LEN 64
+
+typedef unsigned char set_t[32];
+
+/* Program data tokens in order of priority */
+static const struct {
+    const char * rule;
+    const char * type;
+} tokens[] = {
+    {"HEXNUM", "SCPI_TOKEN_HEXNUM"},
+    {"OCTNUM", "SCPI_TOKEN_OCTNUM"},
+    {"BINNUM", "SCPI_TOKEN_BINNUM"},
+    {"PROGRAM_MNEMONIC", "SCPI_TOKEN_PROGRAM_MNEMONIC"},
+    {"DECIMAL_NUMERIC_PROGRAM_DATA", "SCPI_TOKEN_DECIMAL_NUMERIC_PROGRAM_DATA"},
+    {"DOUBLE_QUOTE_PROGRAM_DATA", "SCPI_TOKEN_DOUBLE_QUOTE_PROGRAM_DATA"},
+    {"SINGLE_QUOTE_PROGRAM_DATA", "SCPI_TOKEN_SINGLE_QUOTE_PROGRAM_DATA"},
+    {"PROGRAM_EXPRESSION", "SCPI_TOKEN_PROGRAM_EXPRESSION"},
+};
+
+/* Character sets exported as flags */
+static const struct {
+    const char * rule;
+    const char * flag;
+} flags[] = {
+    {"WS", "LEX_WS"},
+    {"DIGIT", "LEX_DIGIT"},
+    {"NONZERO_DIGIT", "LEX_NONZERO_DIGIT"},
+    {"ALPHA", "LEX_ALPHA"},
+    {"UNDERSCORE", "LEX_UNDERSCORE"},
+};
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+/**
+ * Structural characters, the same as in scanStructural in utils.c
+ * @param c
+ * @return nonzero if c is structural
+ */
+static int isStructural(int c) {
+    return (c >= 0x80) || ((c != 0) && (strchr("\r\n;,\"'#", c) != NULL));
+}
+
+/* grammar */
+
+enum node_type {
+    NODE_EMPTY, NODE_SET, NODE_NOT, NODE_SEQ, NODE_ALT, NODE_STAR, NODE_PLUS, NODE_OPT, NODE_REF
+};
+
+struct node {
+    enum node_type type;
+    set_t set;
+    int a;
+    int b;
+    char name[NAME_LEN];
+};
+
+struct rule {
+    char name[NAME_LEN];
+    int body;
+};
+
+static struct node nodes[MAX_NODES];
+static int node_count;
+static struct rule rules[MAX_RULES];
+static int rule_count;
+
+/* input */
+
+enum tok_type {
+    TK_EOF, TK_ID, TK_STR, TK_RANGE, TK_COLON, TK_SEMI, TK_BAR,
+    TK_LPAREN, TK_RPAREN, TK_STAR, TK_PLUS, TK_QUEST, TK_TILDE, TK_DOT
+};
+
+static const char * input;
+static const char * input_name;
+static int line = 1;
+static enum tok_type tok;
+static char tok_text[NAME_LEN];
+static int tok_len;
+
+/* NFA */
+
+struct edge {
+    int from;
+    int to;
+    int epsilon;
+    set_t set;
+};
+
+static struct edge edges[MAX_EDGES];
+static int edge_count;
+static int nfa_count;
+static int nfa_accept[MAX_NFA];
+
+/* DFA */
+
+static unsigned char dfa_states[MAX_DFA][MAX_NFA / 8];
+static int dfa_next[MAX_DFA][256];
+static int dfa_accept[MAX_DFA];
+static int dfa_count;
+
+static void fail(const char * fmt, ...) {
+    va_list args;
+
+    fprintf(stderr, "%s:%d: ", input_name, line);
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+static void setAdd(set_t set, int c) {
+    set[c >> 3] |= (unsigned char) (1 << (c & 7));
+}
+
+static int setHas(const set_t set, int c) {
+    return (set[c >> 3] >> (c & 7)) & 1;
+}
+
+static int newNode(enum node_type type, int a, int b) {
+    struct node * node;
+
+    if (node_count >= MAX_NODES) {
+        fail("too many nodes");
+    }
+    node = &nodes[node_count];
+    memset(node, 0, sizeof (*node));
+    node->type = type;
+    node->a = a;
+    node->b = b;
+    return node_count++;
+}
+
+static int findRule(const char * name) {
+    int i;
+
+    for (i = 0; i < rule_count; i++) {
+        if (strcmp(rules[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* tokenizer */
+
+static int readChar(void) {
+    int c = (unsigned char) *input++;
+    int i;
+
+    if (c != '\\') {
+        return c;
+    }
+
+    c = (unsigned char) *input++;
+    switch (c) {
+        case 'n': return '\n';
+        case 'r': return '\r';
+        case 't': return '\t';
+        case 'u':
+            c = 0;
+            for (i = 0; i < 4; i++) {
+                c *= 16;
+                if ((*input >= '0') && (*input <= '9')) {
+                    c += *input - '0';
+                } else if ((*input >= 'a') && (*input <= 'f')) {
+                    c += *input - 'a' + 10;
+                } else if ((*input >= 'A') && (*input <= 'F')) {
+                    c += *input - 'A' + 10;
+                } else {
+                    fail("bad unicode escape");
+                }
+                input++;
+            }
+            if (c > 0xff) {
+                fail("character out of range");
+            }
+            return c;
+        case 0:
+            fail("unterminated literal");
+            return 0;
+        default:
+            return c;
+    }
+}
+
+static void next(void) {
+    for (;;) {
+        while ((*input == ' ') || (*input == '\t') || (*input == '\r') || (*input == '\n')) {
+            if (*input == '\n') {
+                line++;
+            }
+            input++;
+        }
+        if ((input[0] == '/') && (input[1] == '/')) {
+            while (*input && (*input != '\n')) {
+                input++;
+            }
+        } else if ((input[0] == '/') && (input[1] == '*')) {
+            input += 2;
+            while (*input && !((input[0] == '*') && (input[1] == '/'))) {
+                if (*input == '\n') {
+                    line++;
+                }
+                input++;
+            }
+            if (*input) {
+                input += 2;
+            }
+        } else {
+            break;
+        }
+    }
+
+    tok_len = 0;
+    if (*input == 0) {
+        tok = TK_EOF;
+    } else if (((*input >= 'a') && (*input <= 'z')) || ((*input >= 'A') && (*input <= 'Z'))) {
+        while (((*input >= 'a') && (*input <= 'z')) || ((*input >= 'A') && (*input <= 'Z'))
+                || ((*input >= '0') && (*input <= '9')) || (*input == '_')) {
+            if (tok_len >= NAME_LEN - 1) {
+                fail("name too long");
+            }
+            tok_text[tok_len++] = *input++;
+        }
+        tok_text[tok_len] = 0;
+        tok = TK_ID;
+    } else if (*input == '\'') {
+        input++;
+        while (*input != '\'') {
+            if ((*input == 0) || (tok_len >= NAME_LEN - 1)) {
+                fail("bad literal");
+            }
+            tok_text[tok_len++] = (char) readChar();
+        }
+        input++;
+        tok = TK_STR;
+    } else if ((input[0] == '.') && (input[1] == '.')) {
+        input += 2;
+        tok = TK_RANGE;
+    } else {
+        switch (*input++) {
+            case ':': tok = TK_COLON; break;
+            case ';': tok = TK_SEMI; break;
+            case '|': tok = TK_BAR; break;
+            case '(': tok = TK_LPAREN; break;
+            case ')': tok = TK_RPAREN; break;
+            case '*': tok = TK_STAR; break;
+            case '+': tok = TK_PLUS; break;
+            case '?': tok = TK_QUEST; break;
+            case '~': tok = TK_TILDE; break;
+            case '.': tok = TK_DOT; break;
+            default: fail("unexpected character '%c'", input[-1]);
+        }
+    }
+}
+
+static void expect(enum tok_type type, const char * what) {
+    if (tok != type) {
+        fail("expected %s", what);
+    }
+    next();
+}
+
+/* parser */
+
+static int parseAlternatives(void);
+
+/**
+ * Evaluate node as set of characters
+ * @param node
+ * @param set - result, ored with existing content
+ * @return 0 if node is not a set
+ */
+static int nodeSet(int node, set_t set) {
+    set_t inner;
+    int rule;
+    int i;
+
+    switch (nodes[node].type) {
+        case NODE_SET:
+            for (i = 0; i < 32; i++) {
+                set[i] |= nodes[node].set[i];
+            }
+            return 1;
+        case NODE_NOT:
+            memset(inner, 0, sizeof (inner));
+            if (!nodeSet(nodes[node].a, inner)) {
+                return 0;
+            }
+            for (i = 0; i < 32; i++) {
+                set[i] |= (unsigned char) ~inner[i];
+            }
+            return 1;
+        case NODE_ALT:
+            return nodeSet(nodes[node].a, set) && nodeSet(nodes[node].b, set);
+        case NODE_REF:
+            rule = findRule(nodes[node].name);
+            return (rule >= 0) && nodeSet(rules[rule].body, set);
+        default:
+            return 0;
+    }
+}
+
+static int parseAtom(void) {
+    int node;
+    int from;
+    int to;
+    int i;
+
+    switch (tok) {
+        case TK_STR:
+            if (tok_len == 1) {
+                from = to = (unsigned char) tok_text[0];
+                next();
+                if (tok == TK_RANGE) {
+                    next();
+                    if ((tok != TK_STR) || (tok_len != 1)) {
+                        fail("expected character");
+                    }
+                    to = (unsigned char) tok_text[0];
+                    next();
+                }
+                node = newNode(NODE_SET, -1, -1);
+                for (i = from; i <= to; i++) {
+                    setAdd(nodes[node].set, i);
+                }
+                return node;
+            }
+            node = newNode(NODE_EMPTY, -1, -1);
+            for (i = 0; i < tok_len; i++) {
+                from = newNode(NODE_SET, -1, -1);
+                setAdd(nodes[from].set, (unsigned char) tok_text[i]);
+                node = newNode(NODE_SEQ, node, from);
+            }
+            next();
+            return node;
+        case TK_ID:
+            node = newNode(NODE_REF, -1, -1);
+            strcpy(nodes[node].name, tok_text);
+            next();
+            return node;
+        case TK_LPAREN:
+            next();
+            node = parseAlternatives();
+            expect(TK_RPAREN, "')'");
+            return node;
+        case TK_TILDE:
+            next();
+            return newNode(NODE_NOT, parseAtom(), -1);
+        case TK_DOT:
+            next();
+            node = newNode(NODE_SET, -1, -1);
+            memset(nodes[node].set, 0xff, sizeof (set_t));
+            return node;
+        default:
+            fail("unexpected token");
+            return -1;
+    }
+}
+
+static int parseSequence(void) {
+    int node = -1;
+    int atom;
+
+    while ((tok != TK_BAR) && (tok != TK_RPAREN) && (tok != TK_SEMI)) {
+        atom = parseAtom();
+        if (tok == TK_STAR) {
+            atom = newNode(NODE_STAR, atom, -1);
+            next();
+        } else if (tok == TK_PLUS) {
+            atom = newNode(NODE_PLUS, atom, -1);
+            next();
+        } else if (tok == TK_QUEST) {
+            atom = newNode(NODE_OPT, atom, -1);
+            next();
+        }
+        node = (node < 0) ? atom : newNode(NODE_SEQ, node, atom);
+    }
+
+    return (node < 0) ? newNode(NODE_EMPTY, -1, -1) : node;
+}
+
+static int parseAlternatives(void) {
+    int node = parseSequence();
+
+    while (tok == TK_BAR) {
+        next();
+        node = newNode(NODE_ALT, node, parseSequence());
+    }
+
+    return node;
+}
+
+static void parseGrammar(void) {
+    struct rule * rule;
+
+    next();
+    while (tok != TK_EOF) {
+        if (tok != TK_ID) {
+            fail("expected rule");
+        }
+        if (strcmp(tok_text, "grammar") == 0) {
+            while ((tok != TK_SEMI) && (tok != TK_EOF)) {
+                next();
+            }
+            expect(TK_SEMI, "';'");
+            continue;
+        }
+        if (strcmp(tok_text, "fragment") == 0) {
+            next();
+            if (tok != TK_ID) {
+                fail("expected rule name");
+            }
+        }
+        if (rule_count >= MAX_RULES) {
+            fail("too many rules");
+        }
+        rule = &rules[rule_count++];
+        strcpy(rule->name, tok_text);
+        next();
+        expect(TK_COLON, "':'");
+        rule->body = parseAlternatives();
+        expect(TK_SEMI, "';'");
+    }
+}
+
+/* NFA construction */
+
+static int newState(void) {
+    if (nfa_count >= MAX_NFA) {
+        fail("too many NFA states");
+    }
+    nfa_accept[nfa_count] = -1;
+    return nfa_count++;
+}
+
+static void addEdge(int from, int to, const unsigned char * set) {
+    struct edge * edge;
+
+    if (edge_count >= MAX_EDGES) {
+        fail("too many NFA edges");
+    }
+    edge = &edges[edge_count++];
+    edge->from = from;
+    edge->to = to;
+    edge->epsilon = (set == NULL);
+    if (set) {
+        memcpy(edge->set, set, sizeof (set_t));
+    }
+}
+
+/**
+ * Thompson construction of one node
+ * @param node
+ * @param start - fragment entry state
+ * @param end - fragment exit state
+ * @param depth - nesting of rule references
+ */
+static void buildNfa(int node, int * start, int * end, int depth) {
+    int s1, e1, s2, e2;
+    set_t set;
+    int rule;
+
+    if (depth > 64) {
+        fail("recursive lexer rule");
+    }
+
+    switch (nodes[node].type) {
+        case NODE_EMPTY:
+            *start = newState();
+            *end = newState();
+            addEdge(*start, *end, NULL);
+            break;
+        case NODE_SET:
+            *start = newState();
+            *end = newState();
+            addEdge(*start, *end, nodes[node].set);
+            break;
+        case NODE_NOT:
+            memset(set, 0, sizeof (set));
+            if (!nodeSet(node, set)) {
+                fail("'~' needs a set of characters");
+            }
+            *start = newState();
+            *end = newState();
+            addEdge(*start, *end, set);
+            break;
+        case NODE_SEQ:
+            buildNfa(nodes[node].a, start, &e1, depth);
+            buildNfa(nodes[node].b, &s2, end, depth);
+            addEdge(e1, s2, NULL);
+            break;
+        case NODE_ALT:
+            *start = newState();
+            *end = newState();
+            buildNfa(nodes[node].a, &s1, &e1, depth);
+            buildNfa(nodes[node].b, &s2, &e2, depth);
+            addEdge(*start, s1, NULL);
+            addEdge(*start, s2, NULL);
+            addEdge(e1, *end, NULL);
+            addEdge(e2, *end, NULL);
+            break;
+        case NODE_STAR:
+        case NODE_PLUS:
+        case NODE_OPT:
+            *start = newState();
+            *end = newState();
+            buildNfa(nodes[node].a, &s1, &e1, depth);
+            addEdge(*start, s1, NULL);
+            addEdge(e1, *end, NULL);
+            if (nodes[node].type != NODE_PLUS) {
+                addEdge(*start, *end, NULL);
+            }
+            if (nodes[node].type != NODE_OPT) {
+                addEdge(e1, s1, NULL);
+            }
+            break;
+        case NODE_REF:
+            rule = findRule(nodes[node].name);
+            if (rule < 0) {
+                fail("unknown rule %s", nodes[node].name);
+            }
+            buildNfa(rules[rule].body, start, end, depth + 1);
+            break;
+    }
+}
+
+/* DFA construction */
+
+static void closure(unsigned char * states) {
+    int changed = 1;
+    int i;
+
+    while (changed) {
+        changed = 0;
+        for (i = 0; i < edge_count; i++) {
+            if (edges[i].epsilon && (states[edges[i].from >> 3] & (1 << (edges[i].from & 7)))
+                    && !(states[edges[i].to >> 3] & (1 << (edges[i].to & 7)))) {
+                states[edges[i].to >> 3] |= (unsigned char) (1 << (edges[i].to & 7));
+                changed = 1;
+            }
+        }
+    }
+}
+
+static int addDfaState(const unsigned char * states) {
+    int i;
+
+    for (i = 0; i < dfa_count; i++) {
+        if (memcmp(dfa_states[i], states, sizeof (dfa_states[i])) == 0) {
+            return i;
+        }
+    }
+
+    if (dfa_count >= MAX_DFA) {
+        fail("too many DFA states");
+    }
+
+    memcpy(dfa_states[dfa_count], states, sizeof (dfa_states[dfa_count]));
+    dfa_accept[dfa_count] = -1;
+    for (i = 0; i < nfa_count; i++) {
+        if ((states[i >> 3] & (1 << (i & 7))) && (nfa_accept[i] >= 0)
+                && ((dfa_accept[dfa_count] < 0) || (nfa_accept[i] < dfa_accept[dfa_count]))) {
+            dfa_accept[dfa_count] = nfa_accept[i];
+        }
+    }
+
+    return dfa_count++;
+}
+
+static void buildDfa(int start) {
+    static unsigned char states[MAX_NFA / 8];
+    int state;
+    int c;
+    int i;
+
+    /* state 0 is the dead state */
+    memset(states, 0, sizeof (states));
+    addDfaState(states);
+
+    states[start >> 3] |= (unsigned char) (1 << (start & 7));
+    closure(states);
+    addDfaState(states);
+
+    for (state = 0; state < dfa_count; state++) {
+        for (c = 0; c < 256; c++) {
+            memset(states, 0, sizeof (states));
+            for (i = 0; i < edge_count; i++) {
+                if (!edges[i].epsilon && (dfa_states[state][edges[i].from >> 3] & (1 << (edges[i].from & 7)))
+                        && setHas(edges[i].set, c)) {
+                    states[edges[i].to >> 3] |= (unsigned char) (1 << (edges[i].to & 7));
+                }
+            }
+            closure(states);
+            dfa_next[state][c] = addDfaState(states);
+        }
+    }
+}
+
+/**
+ * Merge equivalent DFA states, keeping dead state 0 and start state 1
+ */
+static void minimizeDfa(void) {
+    static int block[MAX_DFA];
+    static int next_block[MAX_DFA];
+    static int merged[MAX_DFA][256];
+    int blocks;
+    int changed = 1;
+    int s, t, c;
+
+    for (s = 0; s < dfa_count; s++) {
+        block[s] = dfa_accept[s] + 1;
+    }
+
+    while (changed) {
+        blocks = 0;
+        for (s = 0; s < dfa_count; s++) {
+            for (t = 0; t < s; t++) {
+                if (block[t] != block[s]) {
+                    continue;
+                }
+                for (c = 0; c < 256; c++) {
+                    if (block[dfa_next[s][c]] != block[dfa_next[t][c]]) {
+                        break;
+                    }
+                }
+                if (c == 256) {
+                    break;
+                }
+            }
+            next_block[s] = (t < s) ? next_block[t] : blocks++;
+        }
+
+        changed = 0;
+        for (s = 0; s < dfa_count; s++) {
+            for (t = 0; t < s; t++) {
+                if ((block[s] == block[t]) != (next_block[s] == next_block[t])) {
+                    changed = 1;
+                }
+            }
+        }
+        memcpy(block, next_block, sizeof (block));
+    }
+
+    if (block[0] == block[1]) {
+        fail("grammar accepts no program data");
+    }
+
+    for (s = 0; s < dfa_count; s++) {
+        for (c = 0; c < 256; c++) {
+            merged[block[s]][c] = block[dfa_next[s][c]];
+        }
+        next_block[block[s]] = dfa_accept[s];
+    }
+
+    dfa_count = blocks;
+    for (s = 0; s < dfa_count; s++) {
+        memcpy(dfa_next[s], merged[s], sizeof (merged[s]));
+        dfa_accept[s] = next_block[s];
+    }
+}
+
+/* output */
+
+static void printTable(const int * values) {
+    int c;
+
+    for (c = 0; c < 256; c++) {
+        printf("%s0x%02x%s", (c % 16) ? "" : "    ", values[c], (c == 255) ? "\n" : ((c % 16) == 15) ? ",\n" : ", ");
+    }
+}
+
+int main(int argc, char ** argv) {
+    static char text[65536];
+    int classes[256];
+    int class_count = 0;
+    int values[256];
+    set_t set;
+    int start;
+    int s, e;
+    int rule;
+    size_t len;
+    size_t i;
+    int c, d;
+    FILE * f;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s scpi.g\n", argv[0]);
+        return 1;
+    }
+
+    input_name = argv[1];
+    f = fopen(input_name, "rb");
+    if (f == NULL) {
+        perror(input_name);
+        return 1;
+    }
+    len = fread(text, 1, sizeof (text) - 1, f);
+    fclose(f);
+    text[len] = 0;
+    input = text;
+
+    parseGrammar();
+
+    start = newState();
+    for (i = 0; i < ARRAY_SIZE(tokens); i++) {
+        rule = findRule(tokens[i].rule);
+        if (rule < 0) {
+            fail("missing rule %s", tokens[i].rule);
+        }
+        buildNfa(rules[rule].body, &s, &e, 0);
+        addEdge(start, s, NULL);
+        nfa_accept[e] = (int) i;
+    }
+
+    buildDfa(start);
+    minimizeDfa();
+
+    /* bytes with equal transitions in every state share one class */
+    for (c = 0; c < 256; c++) {
+        for (d = 0; d < c; d++) {
+            for (s = 0; s < dfa_count; s++) {
+                if (dfa_next[s][c] != dfa_next[s][d]) {
+                    break;
+                }
+            }
+            if (s == dfa_count) {
+                break;
+            }
+        }
+        classes[c] = (d < c) ? classes[d] : class_count++;
+    }
+
+    printf("/* Generated from scpi.g by tools/lexer_gen.c, do not edit */\n\n");
+    printf("#ifndef SCPI_LEXER_TABLE_H\n#define SCPI_LEXER_TABLE_H\n\n");
+
+    for (i = 0; i < ARRAY_SIZE(flags); i++) {
+        printf("#define %-20s 0x%02x\n", flags[i].flag, 1 << i);
+    }
+    printf("\n/* Character flags */\nstatic const uint8_t lexCharFlags[256] = {\n");
+    for (c = 0; c < 256; c++) {
+        values[c] = 0;
+    }
+    for (i = 0; i < ARRAY_SIZE(flags); i++) {
+        rule = findRule(flags[i].rule);
+        memset(set, 0, sizeof (set));
+        if ((rule < 0) || !nodeSet(rules[rule].body, set)) {
+            fail("rule %s is not a set of characters", flags[i].rule);
+        }
+        for (c = 0; c < 256; c++) {
+            if (setHas(set, c)) {
+                values[c] |= 1 << i;
+            }
+        }
+    }
+    printTable(values);
+    printf("};\n\n");
+
+    printf("#define LEX_DFA_DEAD 0\n");
+    printf("#define LEX_DFA_START 1\n");
+    printf("#define LEX_DFA_STATES %d\n", dfa_count);
+    printf("#define LEX_DFA_CLASSES %d\n", class_count);
+
+    printf("\n/* Input classes of the program data DFA */\nstatic const uint8_t lexDfaClass[256] = {\n");
+    printTable(classes);
+    printf("};\n\n");
+
+    printf("/* Transitions of the program data DFA */\n");
+    printf("static const uint8_t lexDfaNext[LEX_DFA_STATES][LEX_DFA_CLASSES] = {\n");
+    for (s = 0; s < dfa_count; s++) {
+        printf("    {");
+        for (c = 0, d = 0; c < 256; c++) {
+            if (classes[c] == d) {
+                printf("%s%d", d ? ", " : "", dfa_next[s][c]);
+                d++;
+            }
+        }
+        printf("}%s\n", (s == dfa_count - 1) ? "" : ",");
+    }
+    printf("};\n\n");
+
+    printf("/* Token accepted in each state of the program data DFA */\n");
+    printf("static const scpi_token_type_t lexDfaAccept[LEX_DFA_STATES] = {\n");
+    for (s = 0; s < dfa_count; s++) {
+        printf("    %s%s\n", (dfa_accept[s] < 0) ? "SCPI_TOKEN_UNKNOWN" : tokens[dfa_accept[s]].type, (s == dfa_count - 1) ? "" : ",");
+    }
+    printf("};\n\n");
+
+    printf("/* States looping on every character except structural ones */\n");
+    printf("static const uint8_t lexDfaSkip[LEX_DFA_STATES] = {\n    ");
+    for (s = 0; s < dfa_count; s++) {
+        d = (s != 0) && (dfa_accept[s] < 0);
+        for (c = 0; d && (c < 256); c++) {
+            if (!isStructural(c) && (dfa_next[s][c] != s)) {
+                d = 0;
+            }
+        }
+        printf("%d%s", d, (s == dfa_count - 1) ? "\n" : ", ");
+    }
+    printf("};\n\n");
+
+    printf("#endif /* SCPI_LEXER_TABLE_H */\n");
+
+    return 0;
+}